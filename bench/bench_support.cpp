@@ -0,0 +1,57 @@
+#include "bench_support.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+	std::atomic<std::size_t> g_allocations(0);
+	std::atomic<std::size_t> g_bytes(0);
+
+	void* counted_allocate(std::size_t inSize) {
+		g_allocations.fetch_add(1, std::memory_order_relaxed);
+		g_bytes.fetch_add(inSize, std::memory_order_relaxed);
+		if (void* ptr = std::malloc(inSize ? inSize : 1)) return ptr;
+		throw std::bad_alloc();
+	}
+
+}
+
+namespace dp_bench {
+
+	double now_ns() {
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	std::size_t allocation_count() {
+		return g_allocations.load(std::memory_order_relaxed);
+	}
+
+	std::size_t allocated_bytes() {
+		return g_bytes.load(std::memory_order_relaxed);
+	}
+
+}
+
+//Replacing the global operator new lets every benchmark report allocations per operation. The nothrow forms forward to these
+//in the common standard libraries; over-aligned allocations are not counted.
+void* operator new(std::size_t inSize) {
+	return counted_allocate(inSize);
+}
+void* operator new[](std::size_t inSize) {
+	return counted_allocate(inSize);
+}
+void operator delete(void* inPtr) noexcept {
+	std::free(inPtr);
+}
+void operator delete[](void* inPtr) noexcept {
+	std::free(inPtr);
+}
+void operator delete(void* inPtr, std::size_t) noexcept {
+	std::free(inPtr);
+}
+void operator delete[](void* inPtr, std::size_t) noexcept {
+	std::free(inPtr);
+}
@@ -0,0 +1,64 @@
+#ifndef DP_BENCH_SUPPORT
+#define DP_BENCH_SUPPORT
+
+/*
+*	Shared pieces of the benchmark executables: a monotonic clock, a count of global operator new calls, and a runner which times a
+*	loop and prints one row of nanoseconds and allocations per operation.
+*	The declarations here are plain C++98 so that benchmarks of the cpp98 headers can be built with a C++98 compiler. The clock and
+*	the replacement operator new live in bench_support.cpp, which is built once with a newer standard.
+*/
+
+#include <cstddef>
+#include <cstdio>
+
+namespace dp_bench {
+
+	//Nanoseconds from an arbitrary fixed point
+	double now_ns();
+
+	//Calls to global operator new since the program started
+	std::size_t allocation_count();
+
+	//Bytes requested from global operator new since the program started
+	std::size_t allocated_bytes();
+
+	//Keeps the compiler from discarding a value which is otherwise unused
+	template<typename T>
+	inline void do_not_optimize(const T& in) {
+#if defined(__GNUC__) || defined(__clang__)
+		__asm__ __volatile__("" : : "g"(&in) : "memory");
+#else
+		static const T* volatile sink;
+		sink = &in;
+#endif
+	}
+
+	inline void print_header(const char* inTitle) {
+		std::printf("\n%s\n%-48s %14s %14s\n", inTitle, "case", "ns/op", "allocs/op");
+	}
+
+	//Runs func(i) for i in [0, inIterations) and prints its time and allocation count per call
+	template<typename F>
+	double run(const char* inName, std::size_t inIterations, F func) {
+		std::size_t allocsBefore = dp_bench::allocation_count();
+		double start = dp_bench::now_ns();
+		for (std::size_t i = 0; i < inIterations; ++i) func(i);
+		double elapsed = dp_bench::now_ns() - start;
+		std::size_t allocs = dp_bench::allocation_count() - allocsBefore;
+		double perOp = elapsed / static_cast<double>(inIterations);
+		std::printf("%-48s %14.2f %14.3f\n", inName, perOp, static_cast<double>(allocs) / static_cast<double>(inIterations));
+		return perOp;
+	}
+
+	//The iteration count, scaled down by a factor given as the first program argument so that a quick run is possible
+	inline std::size_t iterations(std::size_t inDefault, int argc, char** argv) {
+		if (argc < 2) return inDefault;
+		long divisor = 0;
+		if (std::sscanf(argv[1], "%ld", &divisor) != 1 || divisor < 1) return inDefault;
+		std::size_t scaled = inDefault / static_cast<std::size_t>(divisor);
+		return scaled ? scaled : 1;
+	}
+
+}
+
+#endif
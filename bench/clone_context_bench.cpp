@@ -0,0 +1,97 @@
+//Deep copies of a 20 node DAG in which node i links to nodes i+1 and i+2: a value_ptr tree, which duplicates every shared node
+//once per path to it, against an owning list of nodes copied under a clone_context, and against a hand-written copy with a map.
+
+#define DP_CLONE_CONTEXT
+#include "cpp98/clone_context.h"
+#include "cpp98/value_ptr.h"
+
+#include "bench_support.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+	const std::size_t kNodes = 20;
+
+	//Each link owns its target, so a node reachable through several paths is stored once per path
+	struct tree_node {
+		std::size_t value;
+		std::vector<dp::value_ptr<tree_node>> children;
+	};
+
+	dp::value_ptr<tree_node> make_tree(std::size_t inIndex) {
+		dp::value_ptr<tree_node> result(new tree_node());
+		result->value = inIndex;
+		for (std::size_t next = inIndex + 1; next <= inIndex + 2 && next < kNodes; ++next) result->children.push_back(make_tree(next));
+		return result;
+	}
+
+	struct node {
+		std::size_t value;
+		std::vector<node*> links;
+
+		node() : value(0), links() {}
+		node(const node& other) : value(other.value), links(other.links) {
+			for (node*& link : links) dp::clone_context::relink(link);
+		}
+	};
+
+	struct graph {
+		std::vector<dp::value_ptr<node>> nodes;
+	};
+
+	graph make_graph() {
+		graph result;
+		for (std::size_t i = 0; i < kNodes; ++i) {
+			result.nodes.push_back(dp::value_ptr<node>(new node()));
+			result.nodes.back()->value = i;
+		}
+		for (std::size_t i = 0; i < kNodes; ++i) {
+			for (std::size_t next = i + 1; next <= i + 2 && next < kNodes; ++next) result.nodes[i]->links.push_back(result.nodes[next].get());
+		}
+		return result;
+	}
+
+	//What a graph copy looks like without clone_context: copy the nodes, then map every link through a table of old to new
+	graph copy_by_hand(const graph& inSource) {
+		graph result;
+		std::unordered_map<const node*, node*> copies;
+		result.nodes.reserve(inSource.nodes.size());
+		for (const dp::value_ptr<node>& source : inSource.nodes) {
+			node* copy = new node();
+			copy->value = source->value;
+			copy->links = source->links;
+			copies[source.get()] = copy;
+			result.nodes.push_back(dp::value_ptr<node>(copy));
+		}
+		for (dp::value_ptr<node>& copy : result.nodes) {
+			for (node*& link : copy->links) link = copies[link];
+		}
+		return result;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t n = dp_bench::iterations(20000, argc, argv);
+
+	dp_bench::print_header("deep copy of a 20 node DAG (per copy)");
+	const dp::value_ptr<tree_node> tree = make_tree(0);
+	dp_bench::run("dp::value_ptr tree (shared nodes duplicated)", n / 100 + 1, [&](std::size_t) {
+		dp::value_ptr<tree_node> copy = tree;
+		dp_bench::do_not_optimize(copy);
+	});
+
+	const graph source = make_graph();
+	dp_bench::run("dp::clone_context", n, [&](std::size_t) {
+		dp::clone_context context;
+		graph copy = source;
+		dp_bench::do_not_optimize(copy);
+	});
+	dp_bench::run("hand-written std::unordered_map", n, [&](std::size_t) {
+		graph copy = copy_by_hand(source);
+		dp_bench::do_not_optimize(copy);
+	});
+	return 0;
+}
@@ -0,0 +1,79 @@
+//Read throughput of a hot shared snapshot from 1 to N threads: every thread copying the same cow_ptr, and so bumping its one
+//shared count, against a cow_reader per thread which only loads the publisher's version. A writer publishes a new version every
+//millisecond throughout.
+
+#include "cpp17/cow_publisher.h"
+
+#include "bench_support.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	struct config {
+		int values[16] = {};
+	};
+
+	//Runs inThreads readers for inReads reads each, with a writer publishing alongside, and returns the total nanoseconds per read
+	template<typename Reader>
+	double run_readers(dp::cow_publisher<config>& inPublisher, std::size_t inThreads, std::size_t inReads, Reader read) {
+		std::atomic<bool> stop{ false };
+		std::thread writer([&] {
+			while (!stop.load(std::memory_order_relaxed)) {
+				inPublisher.publish(dp::make_cow<config>());
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		});
+
+		std::atomic<std::size_t> ready{ 0 };
+		std::atomic<bool> go{ false };
+		std::vector<std::thread> readers;
+		for (std::size_t t = 0; t < inThreads; ++t) {
+			readers.emplace_back([&] {
+				dp::cow_reader<config> reader{ inPublisher };
+				++ready;
+				while (!go.load()) std::this_thread::yield();
+				long long total = 0;
+				for (std::size_t i = 0; i < inReads; ++i) total += read(reader);
+				dp_bench::do_not_optimize(total);
+			});
+		}
+		while (ready.load() != inThreads) std::this_thread::yield();
+		double start = dp_bench::now_ns();
+		go = true;
+		for (std::thread& reader : readers) reader.join();
+		double elapsed = dp_bench::now_ns() - start;
+		stop = true;
+		writer.join();
+		return elapsed / static_cast<double>(inReads);
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t reads = dp_bench::iterations(2000000, argc, argv);
+	std::size_t maxThreads = std::thread::hardware_concurrency();
+	if (maxThreads == 0) maxThreads = 1;
+	//A second argument overrides the thread count to scale up to, for machines where hardware_concurrency() is unhelpful
+	if (argc > 2 && std::atoi(argv[2]) > 0) maxThreads = static_cast<std::size_t>(std::atoi(argv[2]));
+
+	dp::cow_publisher<config> publisher{ dp::make_cow<config>() };
+	std::printf("\n%zu reads per thread, up to %zu threads; wall-clock ns per read, so flat rows scale perfectly\n", reads, maxThreads);
+	std::printf("%-48s %14s %14s\n", "threads", "copy cow_ptr", "cow_reader");
+	for (std::size_t threads = 1; threads <= maxThreads; threads *= 2) {
+		double copying = run_readers(publisher, threads, reads, [](dp::cow_reader<config>& reader) {
+			//Each read takes and drops a reference on the snapshot which every thread shares
+			dp::cow_ptr<config> copy = reader.snapshot();
+			return static_cast<const dp::cow_ptr<config>&>(copy)->values[0];
+		});
+		double replicated = run_readers(publisher, threads, reads, [](dp::cow_reader<config>& reader) {
+			return reader->values[0];
+		});
+		std::printf("%-48zu %14.2f %14.2f\n", threads, copying, replicated);
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+//Cold start from a snapshot of 100k 64 byte objects: mapping it with cow_snapshot_file and reading one or every object, against
+//reading the whole file into memory and rebuilding a cow_ptr per object, as a conventional loader would.
+
+#include "cpp98/cow_snapshot.h"
+
+#include "bench_support.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+	const char* const kPath = "cow_snapshot_bench.bin";
+	const std::size_t kObjects = 100000;
+
+	struct record {
+		std::uint64_t fields[8];
+	};
+
+	//The conventional alternative: read the file, then copy every object into its own cow_ptr
+	std::vector<dp::cow_ptr<record>> load_all(const char* inPath) {
+		std::FILE* file = std::fopen(inPath, "rb");
+		std::fseek(file, 0, SEEK_END);
+		std::vector<char> bytes(static_cast<std::size_t>(std::ftell(file)));
+		std::fseek(file, 0, SEEK_SET);
+		if (std::fread(bytes.data(), 1, bytes.size(), file) != bytes.size()) bytes.clear();
+		std::fclose(file);
+
+		dp::detail::cow_snapshot_header header;
+		std::memcpy(&header, bytes.data(), sizeof(header));
+		std::vector<dp::cow_ptr<record>> result;
+		result.reserve(static_cast<std::size_t>(header.entry_count));
+		const char* table = bytes.data() + sizeof(header);
+		for (std::size_t i = 0; i < header.entry_count; ++i) {
+			dp::detail::cow_snapshot_entry entry;
+			std::memcpy(&entry, table + i * sizeof(entry), sizeof(entry));
+			record object;
+			std::memcpy(&object, bytes.data() + entry.offset, sizeof(object));
+			result.push_back(dp::make_cow<record>(object));
+		}
+		return result;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t n = dp_bench::iterations(200, argc, argv);
+	{
+		dp::cow_snapshot_writer writer;
+		for (std::size_t i = 0; i < kObjects; ++i) {
+			record object = {};
+			for (std::size_t f = 0; f < 8; ++f) object.fields[f] = i * 8 + f;
+			writer.add(dp::make_cow<record>(object));
+		}
+		writer.write(kPath);
+	}
+
+	dp_bench::print_header("open a 100k object snapshot and read one object (per open)");
+	dp_bench::run("dp::cow_snapshot_file", n, [](std::size_t i) {
+		dp::cow_snapshot_file file(kPath);
+		dp_bench::do_not_optimize(file.get<record>(i % kObjects)->fields[0]);
+	});
+	dp_bench::run("read the file and rebuild every cow_ptr", n, [](std::size_t i) {
+		const std::vector<dp::cow_ptr<record>> objects = load_all(kPath);
+		dp_bench::do_not_optimize(objects[i % kObjects]->fields[0]);
+	});
+
+	dp_bench::print_header("open a 100k object snapshot and sum every object (per open)");
+	dp_bench::run("dp::cow_snapshot_file", n, [](std::size_t) {
+		dp::cow_snapshot_file file(kPath);
+		std::uint64_t total = 0;
+		for (std::size_t i = 0; i < kObjects; ++i) total += file.get<record>(i)->fields[7];
+		dp_bench::do_not_optimize(total);
+	});
+	dp_bench::run("read the file and rebuild every cow_ptr", n, [](std::size_t) {
+		const std::vector<dp::cow_ptr<record>> objects = load_all(kPath);
+		std::uint64_t total = 0;
+		for (std::size_t i = 0; i < kObjects; ++i) total += objects[i]->fields[7];
+		dp_bench::do_not_optimize(total);
+	});
+
+	std::remove(kPath);
+	return 0;
+}
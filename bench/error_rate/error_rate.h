@@ -0,0 +1,61 @@
+#ifndef DP_BENCH_ERROR_RATE
+#define DP_BENCH_ERROR_RATE
+
+/*
+*	The workloads of the error-rate benchmark, once per error reporting style. Each style lives in its own translation unit so the
+*	build can report its code size and stack usage on its own, and so that nothing is inlined across the call boundary which the
+*	benchmark measures.
+*
+*	Parse: turn a short decimal string into an int, failing on an empty string, a stray character or overflow.
+*	Depth: a chain of kDepth calls, each adding to its callee's result, where the innermost call may fail.
+*/
+
+#include "cpp17/expected.h"
+
+#include <exception>
+#include <optional>
+#include <string_view>
+
+namespace error_rate {
+
+	enum class parse_error : int {
+		none,
+		empty,
+		bad_digit,
+		overflow
+	};
+
+	struct parse_failure : std::exception {
+		parse_error code;
+		explicit parse_failure(parse_error in) : code(in) {}
+		const char* what() const noexcept override {
+			return "parse failure";
+		}
+	};
+
+	constexpr int kDepth = 8;
+
+	//dp::expected, with errors propagated by hand
+	dp::expected<int, parse_error> parse_expected(std::string_view in);
+	dp::expected<int, parse_error> depth_expected(int inLevel, int inInput);
+
+	//Exceptions thrown at the failure and caught by the outermost caller
+	int parse_exception(std::string_view in);
+	int depth_exception(int inLevel, int inInput);
+
+	//std::optional for the result and an out parameter for the error code
+	std::optional<int> parse_optional(std::string_view in, parse_error& outError);
+	std::optional<int> depth_optional(int inLevel, int inInput, parse_error& outError);
+
+	//dp::expected results unwrapped with value(), so failures travel as bad_expected_access
+	int parse_value(std::string_view in);
+	int depth_value(int inLevel, int inInput);
+
+	//Negative inputs fail at the bottom of the depth chain
+	inline bool leaf_fails(int inInput) {
+		return inInput < 0;
+	}
+
+}
+
+#endif
@@ -0,0 +1,24 @@
+#include "error_rate.h"
+
+namespace error_rate {
+
+	int parse_exception(std::string_view in) {
+		if (in.empty()) throw parse_failure(parse_error::empty);
+		int result = 0;
+		for (char c : in) {
+			if (c < '0' || c > '9') throw parse_failure(parse_error::bad_digit);
+			if (result > 214748363) throw parse_failure(parse_error::overflow);
+			result = result * 10 + (c - '0');
+		}
+		return result;
+	}
+
+	int depth_exception(int inLevel, int inInput) {
+		if (inLevel == 0) {
+			if (leaf_fails(inInput)) throw parse_failure(parse_error::bad_digit);
+			return inInput;
+		}
+		return depth_exception(inLevel - 1, inInput) + inLevel;
+	}
+
+}
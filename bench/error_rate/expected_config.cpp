@@ -0,0 +1,26 @@
+#include "error_rate.h"
+
+namespace error_rate {
+
+	dp::expected<int, parse_error> parse_expected(std::string_view in) {
+		if (in.empty()) return dp::unexpected{ parse_error::empty };
+		int result = 0;
+		for (char c : in) {
+			if (c < '0' || c > '9') return dp::unexpected{ parse_error::bad_digit };
+			if (result > 214748363) return dp::unexpected{ parse_error::overflow };
+			result = result * 10 + (c - '0');
+		}
+		return result;
+	}
+
+	dp::expected<int, parse_error> depth_expected(int inLevel, int inInput) {
+		if (inLevel == 0) {
+			if (leaf_fails(inInput)) return dp::unexpected{ parse_error::bad_digit };
+			return inInput;
+		}
+		dp::expected<int, parse_error> inner = depth_expected(inLevel - 1, inInput);
+		if (!inner) return inner;
+		return *inner + inLevel;
+	}
+
+}
@@ -0,0 +1,38 @@
+#include "error_rate.h"
+
+namespace error_rate {
+
+	std::optional<int> parse_optional(std::string_view in, parse_error& outError) {
+		if (in.empty()) {
+			outError = parse_error::empty;
+			return std::nullopt;
+		}
+		int result = 0;
+		for (char c : in) {
+			if (c < '0' || c > '9') {
+				outError = parse_error::bad_digit;
+				return std::nullopt;
+			}
+			if (result > 214748363) {
+				outError = parse_error::overflow;
+				return std::nullopt;
+			}
+			result = result * 10 + (c - '0');
+		}
+		return result;
+	}
+
+	std::optional<int> depth_optional(int inLevel, int inInput, parse_error& outError) {
+		if (inLevel == 0) {
+			if (leaf_fails(inInput)) {
+				outError = parse_error::bad_digit;
+				return std::nullopt;
+			}
+			return inInput;
+		}
+		std::optional<int> inner = depth_optional(inLevel - 1, inInput, outError);
+		if (!inner) return inner;
+		return *inner + inLevel;
+	}
+
+}
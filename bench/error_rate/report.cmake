@@ -0,0 +1,34 @@
+# Writes the code size and stack usage report for the error-rate benchmark's configurations.
+# Run after the build with OBJECTS (a |-separated list of object files), OUTPUT, and optionally SIZE_TOOL. Stack usage comes from the
+# .su files which GCC writes beside each object under -fstack-usage.
+string(REPLACE "|" ";" object_list "${OBJECTS}")
+set(report "")
+
+foreach(object IN LISTS object_list)
+	get_filename_component(name "${object}" NAME)
+	string(REGEX REPLACE "\\.cpp\\.(o|obj)$" "" name "${name}")
+
+	set(text_size "unknown")
+	if(SIZE_TOOL)
+		execute_process(COMMAND "${SIZE_TOOL}" "${object}" OUTPUT_VARIABLE size_output ERROR_QUIET RESULT_VARIABLE size_result)
+		if(size_result EQUAL 0)
+			string(REGEX MATCH "\n[ \t]*([0-9]+)" size_match "${size_output}")
+			set(text_size "${CMAKE_MATCH_1}")
+		endif()
+	endif()
+	string(APPEND report "${name}: ${text_size} bytes of code\n")
+
+	string(REGEX REPLACE "\\.(o|obj)$" ".su" stack_file "${object}")
+	if(EXISTS "${stack_file}")
+		file(STRINGS "${stack_file}" stack_lines)
+		foreach(line IN LISTS stack_lines)
+			string(REGEX REPLACE "^[^:]*:[0-9]+:[0-9]+:" "" line "${line}")
+			string(REPLACE "\t" "  " line "${line}")
+			string(APPEND report "    ${line}\n")
+		endforeach()
+	else()
+		string(APPEND report "    (no stack usage data; build with GCC for -fstack-usage)\n")
+	endif()
+endforeach()
+
+file(WRITE "${OUTPUT}" "${report}")
@@ -0,0 +1,21 @@
+#include "error_rate.h"
+
+namespace error_rate {
+
+	namespace {
+		dp::expected<int, parse_error> leaf(int inInput) {
+			if (leaf_fails(inInput)) return dp::unexpected{ parse_error::bad_digit };
+			return inInput;
+		}
+	}
+
+	int parse_value(std::string_view in) {
+		return parse_expected(in).value();
+	}
+
+	int depth_value(int inLevel, int inInput) {
+		if (inLevel == 0) return leaf(inInput).value();
+		return depth_value(inLevel - 1, inInput) + inLevel;
+	}
+
+}
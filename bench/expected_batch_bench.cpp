@@ -0,0 +1,78 @@
+//A million results with one error in a thousand: expected_batch, which keeps values and errors in separate dense arrays behind a
+//bitmask, against a std::vector of dp::expected, for building the batch, counting its errors and visiting only the errors.
+
+#include "cpp17/expected_batch.h"
+
+#include "bench_support.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+	const std::size_t kCount = 1 << 20;
+
+	dp::expected<std::uint64_t, std::string> result_for(std::size_t in) {
+		if (in % 1000 == 999) return dp::unexpected{ std::string("failed at element ") + std::to_string(in) };
+		return in * 0x9e3779b97f4a7c15ull;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t runs = dp_bench::iterations(20, argc, argv);
+	std::printf("%zu elements, one error per thousand; each row is one pass over the whole batch\n", kCount);
+
+	using batch_type = dp::expected_batch<std::uint64_t, std::string>;
+	using vector_type = std::vector<dp::expected<std::uint64_t, std::string>>;
+
+	dp_bench::print_header("build");
+	dp_bench::run("dp::expected_batch", runs, [](std::size_t) {
+		batch_type batch;
+		batch.reserve(kCount);
+		for (std::size_t i = 0; i < kCount; ++i) batch.push_back(result_for(i));
+		dp_bench::do_not_optimize(batch);
+	});
+	dp_bench::run("std::vector<dp::expected>", runs, [](std::size_t) {
+		vector_type results;
+		results.reserve(kCount);
+		for (std::size_t i = 0; i < kCount; ++i) results.push_back(result_for(i));
+		dp_bench::do_not_optimize(results);
+	});
+
+	batch_type batch;
+	vector_type results;
+	for (std::size_t i = 0; i < kCount; ++i) {
+		batch.push_back(result_for(i));
+		results.push_back(result_for(i));
+	}
+	std::printf("\nfootprint: dp::expected_batch %zu bytes, std::vector<dp::expected> %zu bytes (excluding error strings)\n",
+		batch.value_count() * sizeof(std::uint64_t) + batch.error_count() * sizeof(std::string) + (kCount / 64) * (sizeof(std::uint64_t) + sizeof(std::size_t)),
+		results.size() * sizeof(vector_type::value_type));
+
+	dp_bench::print_header("count the errors");
+	dp_bench::run("dp::expected_batch", runs, [&](std::size_t) {
+		dp_bench::do_not_optimize(batch.count_errors(0, batch.size()));
+	});
+	dp_bench::run("std::vector<dp::expected>", runs, [&](std::size_t) {
+		std::size_t errors = 0;
+		for (const auto& result : results) errors += !result.has_value();
+		dp_bench::do_not_optimize(errors);
+	});
+
+	dp_bench::print_header("visit every error with its index");
+	dp_bench::run("dp::expected_batch", runs, [&](std::size_t) {
+		std::size_t total = 0;
+		batch.for_each_error([&](std::size_t index, const std::string& error) { total += index + error.size(); });
+		dp_bench::do_not_optimize(total);
+	});
+	dp_bench::run("std::vector<dp::expected>", runs, [&](std::size_t) {
+		std::size_t total = 0;
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			if (!results[i]) total += i + results[i].error().size();
+		}
+		dp_bench::do_not_optimize(total);
+	});
+	return 0;
+}
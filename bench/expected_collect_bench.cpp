@@ -0,0 +1,74 @@
+//Scaling of parallel_collect across thread counts against the sequential collect, with no failure and with a failure a quarter of
+//the way through the input, where the parallel version should stop its other workers early. A short input is also run with the
+//default minimum chunk, which keeps it on the calling thread, and with a minimum of one element, which starts every thread anyway.
+
+#include "cpp17/expected_algorithm.h"
+
+#include "bench_support.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	//A few hundred nanoseconds of work per element, failing at failAt
+	struct work {
+		std::size_t failAt;
+		dp::expected<std::uint64_t, int> operator()(std::size_t in) const {
+			if (in == failAt) return dp::unexpected{ 1 };
+			std::uint64_t hash = in + 0x9e3779b97f4a7c15ull;
+			for (int i = 0; i < 200; ++i) hash = (hash ^ (hash >> 31)) * 0xbf58476d1ce4e5b9ull;
+			return hash;
+		}
+	};
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t count = dp_bench::iterations(1 << 20, argc, argv);
+	const std::size_t runs = 5;
+	std::vector<std::size_t> input(count);
+	std::iota(input.begin(), input.end(), std::size_t{ 0 });
+
+	std::size_t maxThreads = std::thread::hardware_concurrency();
+	if (maxThreads == 0) maxThreads = 1;
+	//A second argument overrides the thread count to scale up to, for machines where hardware_concurrency() is unhelpful
+	if (argc > 2 && std::atoi(argv[2]) > 0) maxThreads = static_cast<std::size_t>(std::atoi(argv[2]));
+	std::printf("%zu elements, up to %zu threads; each row is one whole collect\n", count, maxThreads);
+
+	for (std::size_t failAt : { count, count / 4 }) {
+		dp_bench::print_header(failAt == count ? "no failure" : "failure a quarter of the way in");
+		dp_bench::run("collect", runs, [&](std::size_t) {
+			auto result = dp::collect(input, work{ failAt });
+			dp_bench::do_not_optimize(result);
+		});
+		for (std::size_t threads = 1; threads <= maxThreads; threads *= 2) {
+			char name[64];
+			std::snprintf(name, sizeof(name), "parallel_collect, %zu thread(s)", threads);
+			dp_bench::run(name, runs, [&](std::size_t) {
+				auto result = dp::parallel_collect(input, work{ failAt }, threads);
+				dp_bench::do_not_optimize(result);
+			});
+		}
+	}
+
+	std::vector<std::size_t> shortInput(512);
+	std::iota(shortInput.begin(), shortInput.end(), std::size_t{ 0 });
+	dp_bench::print_header("512 elements");
+	dp_bench::run("collect", runs * 100, [&](std::size_t) {
+		auto result = dp::collect(shortInput, work{ shortInput.size() });
+		dp_bench::do_not_optimize(result);
+	});
+	dp_bench::run("parallel_collect, default minimum chunk", runs * 100, [&](std::size_t) {
+		auto result = dp::parallel_collect(shortInput, work{ shortInput.size() }, maxThreads);
+		dp_bench::do_not_optimize(result);
+	});
+	dp_bench::run("parallel_collect, minimum chunk of 1", runs * 100, [&](std::size_t) {
+		auto result = dp::parallel_collect(shortInput, work{ shortInput.size() }, maxThreads, 1);
+		dp_bench::do_not_optimize(result);
+	});
+	return 0;
+}
@@ -0,0 +1,81 @@
+//A five-deep call chain which fails at the bottom for one input in eight, with the error propagated by co_await, by hand-written
+//has_value() checks, and by exceptions. The coroutines are run with heap frames and with frames from a caller-supplied buffer.
+
+#include "cpp20/expected_coroutine.h"
+
+#include "bench_support.h"
+
+#include <stdexcept>
+
+namespace {
+
+	constexpr int kDepth = 5;
+
+	using result = dp::expected<int, int>;
+
+	bool fails(std::size_t i) {
+		return i % 8 == 7;
+	}
+
+	result leaf(std::size_t i) {
+		if (fails(i)) return dp::unexpected{ static_cast<int>(i) };
+		return static_cast<int>(i & 0xff);
+	}
+
+	result by_hand(int depth, std::size_t i) {
+		result inner = depth == 0 ? leaf(i) : by_hand(depth - 1, i);
+		if (!inner) return dp::unexpected{ inner.error() };
+		return *inner + 1;
+	}
+
+	//GCC 12 evaluates both arms of a conditional operand of co_await, so the recursion is spelled out
+	result by_co_await(int depth, std::size_t i) {
+		if (depth == 0) co_return co_await leaf(i) + 1;
+		co_return co_await by_co_await(depth - 1, i) + 1;
+	}
+
+	result by_co_await_buffered(dp::coroutine_frame_buffer& buffer, int depth, std::size_t i) {
+		if (depth == 0) co_return co_await leaf(i) + 1;
+		co_return co_await by_co_await_buffered(buffer, depth - 1, i) + 1;
+	}
+
+	int by_exception(int depth, std::size_t i) {
+		if (depth == 0) {
+			if (fails(i)) throw std::runtime_error{ "leaf failed" };
+			return static_cast<int>(i & 0xff);
+		}
+		return by_exception(depth - 1, i) + 1;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	std::size_t n = dp_bench::iterations(2000000, argc, argv);
+	alignas(std::max_align_t) static unsigned char storage[16384];
+	dp::coroutine_frame_buffer buffer{ storage };
+
+	dp_bench::print_header("five-deep call chain, failing one call in eight");
+	dp_bench::run("hand-written has_value() checks", n, [](std::size_t i) {
+		result r = by_hand(kDepth, i);
+		dp_bench::do_not_optimize(r);
+	});
+	dp_bench::run("co_await, heap frames", n, [](std::size_t i) {
+		result r = by_co_await(kDepth, i);
+		dp_bench::do_not_optimize(r);
+	});
+	dp_bench::run("co_await, frames from a caller buffer", n, [&](std::size_t i) {
+		result r = by_co_await_buffered(buffer, kDepth, i);
+		dp_bench::do_not_optimize(r);
+	});
+	dp_bench::run("exceptions", n, [](std::size_t i) {
+		int r = 0;
+		try {
+			r = by_exception(kDepth, i);
+		}
+		catch (const std::runtime_error&) {
+			r = -1;
+		}
+		dp_bench::do_not_optimize(r);
+	});
+	return 0;
+}
@@ -0,0 +1,160 @@
+//Error reporting cost at error rates from 0% to 50%: dp::expected against exceptions, std::optional with an error code, and
+//dp::expected unwrapped with the throwing value(). Each row gives throughput and per-call latency percentiles; the build's size and
+//stack usage report for each configuration follows, if the build could produce one.
+
+#include "error_rate/error_rate.h"
+
+#include "bench_support.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+	using namespace error_rate;
+
+	//Calls are timed in small batches, as a single call is close to the resolution of the clock
+	constexpr std::size_t kBatch = 16;
+
+	struct inputs {
+		std::vector<std::string> texts;
+		std::vector<int> depths;
+	};
+
+	inputs make_inputs(std::size_t inCount, double inErrorRate) {
+		std::mt19937 rng(12345);
+		std::uniform_real_distribution<double> coin(0.0, 1.0);
+		std::uniform_int_distribution<int> number(0, 99999);
+		inputs result;
+		result.texts.reserve(inCount);
+		result.depths.reserve(inCount);
+		for (std::size_t i = 0; i < inCount; ++i) {
+			bool fails = coin(rng) < inErrorRate;
+			std::string text = std::to_string(number(rng));
+			if (fails) text[text.size() / 2] = 'x';
+			result.texts.push_back(text);
+			result.depths.push_back(fails ? -1 : number(rng));
+		}
+		return result;
+	}
+
+	template<typename F>
+	void measure(const char* inName, std::size_t inCount, F func) {
+		std::vector<double> perCall;
+		perCall.reserve(inCount / kBatch + 1);
+		long long checksum = 0;
+		//An untimed pass first, so the first configuration does not pay for cold caches and branch predictors
+		for (std::size_t i = 0; i < inCount; ++i) checksum += func(i);
+		double start = dp_bench::now_ns();
+		for (std::size_t i = 0; i + kBatch <= inCount; i += kBatch) {
+			double batchStart = dp_bench::now_ns();
+			for (std::size_t j = i; j < i + kBatch; ++j) checksum += func(j);
+			perCall.push_back((dp_bench::now_ns() - batchStart) / kBatch);
+		}
+		double elapsed = dp_bench::now_ns() - start;
+		dp_bench::do_not_optimize(checksum);
+
+		std::sort(perCall.begin(), perCall.end());
+		auto percentile = [&](double p) { return perCall[static_cast<std::size_t>(p * static_cast<double>(perCall.size() - 1))]; };
+		double calls = static_cast<double>(perCall.size() * kBatch);
+		std::printf("  %-28s %12.2f %10.2f %10.2f %10.2f\n", inName, calls / elapsed * 1e3, percentile(0.5), percentile(0.9), percentile(0.99));
+	}
+
+	void run_rate(std::size_t inCount, double inRate) {
+		inputs in = make_inputs(inCount, inRate);
+		std::printf("\nerror rate %.0f%%\n  %-28s %12s %10s %10s %10s\n", inRate * 100, "case", "Mcalls/s", "p50 ns", "p90 ns", "p99 ns");
+
+		measure("parse: dp::expected", inCount, [&](std::size_t i) {
+			auto result = parse_expected(in.texts[i]);
+			return result ? *result : -static_cast<int>(result.error());
+		});
+		measure("parse: exceptions", inCount, [&](std::size_t i) {
+			try {
+				return parse_exception(in.texts[i]);
+			}
+			catch (const parse_failure& e) {
+				return -static_cast<int>(e.code);
+			}
+		});
+		measure("parse: optional + code", inCount, [&](std::size_t i) {
+			parse_error code = parse_error::none;
+			auto result = parse_optional(in.texts[i], code);
+			return result ? *result : -static_cast<int>(code);
+		});
+		measure("parse: expected::value()", inCount, [&](std::size_t i) {
+			try {
+				return parse_value(in.texts[i]);
+			}
+			catch (const dp::bad_expected_access<parse_error>& e) {
+				return -static_cast<int>(e.error());
+			}
+		});
+
+		measure("depth: dp::expected", inCount, [&](std::size_t i) {
+			auto result = depth_expected(kDepth, in.depths[i]);
+			return result ? *result : -static_cast<int>(result.error());
+		});
+		measure("depth: exceptions", inCount, [&](std::size_t i) {
+			try {
+				return depth_exception(kDepth, in.depths[i]);
+			}
+			catch (const parse_failure& e) {
+				return -static_cast<int>(e.code);
+			}
+		});
+		measure("depth: optional + code", inCount, [&](std::size_t i) {
+			parse_error code = parse_error::none;
+			auto result = depth_optional(kDepth, in.depths[i], code);
+			return result ? *result : -static_cast<int>(code);
+		});
+		measure("depth: expected::value()", inCount, [&](std::size_t i) {
+			try {
+				return depth_value(kDepth, in.depths[i]);
+			}
+			catch (const dp::bad_expected_access<parse_error>& e) {
+				return -static_cast<int>(e.error());
+			}
+		});
+	}
+
+	//On the common 64-bit ABIs a trivially copyable result of up to 16 bytes comes back in registers; anything else goes through a
+	//hidden pointer to caller-provided memory
+	template<typename T>
+	void print_return_type(const char* inName) {
+		bool inRegisters = std::is_trivially_copyable_v<T> && sizeof(T) <= 16;
+		std::printf("  %-36s %6zu bytes  %s\n", inName, sizeof(T), inRegisters ? "registers" : "memory (hidden pointer)");
+	}
+
+	void print_build_report() {
+		std::printf("\nreturn types\n");
+		print_return_type<dp::expected<int, parse_error>>("dp::expected<int, parse_error>");
+		print_return_type<dp::expected<int, std::string>>("dp::expected<int, std::string>");
+		print_return_type<std::optional<int>>("std::optional<int>");
+		print_return_type<int>("int (exceptions)");
+
+#ifdef DP_BENCH_ERROR_RATE_REPORT
+		std::ifstream report(DP_BENCH_ERROR_RATE_REPORT);
+		if (!report) {
+			std::printf("\nno size and stack usage report at %s\n", DP_BENCH_ERROR_RATE_REPORT);
+			return;
+		}
+		std::printf("\ncode size and stack usage per configuration (from the build)\n");
+		std::string line;
+		while (std::getline(report, line)) std::printf("  %s\n", line.c_str());
+#endif
+	}
+
+}
+
+int main(int argc, char** argv) {
+	std::size_t count = dp_bench::iterations(1 << 20, argc, argv);
+	const double rates[] = { 0.0, 0.01, 0.05, 0.1, 0.25, 0.5 };
+	for (double rate : rates) run_rate(count, rate);
+	print_build_report();
+	return 0;
+}
@@ -0,0 +1,86 @@
+//A long pipeline of fallible steps over a heap-owning payload, written with the monadic operations of dp::expected and by hand with
+//has_value() branches. Allocations per run show whether the payload is moved along the chain or copied at some step.
+
+#include "cpp17/expected.h"
+
+#include "bench_support.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+	using payload = std::vector<int>;
+	using result = dp::expected<payload, std::string>;
+
+	//Each step fails only for inputs the benchmark never generates, so the whole chain always runs
+	result append(payload&& in) {
+		if (in.size() > 1000) return dp::unexpected{ std::string{ "too long" } };
+		in.push_back(static_cast<int>(in.size()));
+		return std::move(in);
+	}
+
+	payload double_all(payload&& in) {
+		for (int& i : in) i *= 2;
+		return std::move(in);
+	}
+
+	result drop_front(payload&& in) {
+		if (in.empty()) return dp::unexpected{ std::string{ "empty" } };
+		in.erase(in.begin());
+		return std::move(in);
+	}
+
+	result start(std::size_t i) {
+		payload in(64, static_cast<int>(i));
+		in.reserve(128);
+		return in;
+	}
+
+	result monadic(std::size_t i) {
+		return start(i)
+			.and_then(append)
+			.transform(double_all)
+			.and_then(drop_front)
+			.and_then(append)
+			.transform(double_all)
+			.and_then(drop_front)
+			.and_then(append)
+			.transform(double_all)
+			.and_then(drop_front)
+			.transform_error([](std::string&& e) { return e + " in pipeline"; });
+	}
+
+	result by_hand(std::size_t i) {
+		result r = start(i);
+		for (int step = 0; step < 3; ++step) {
+			if (!r) break;
+			r = append(std::move(*r));
+			if (!r) break;
+			r = double_all(std::move(*r));
+			r = drop_front(std::move(*r));
+		}
+		if (!r) return dp::unexpected{ r.error() + " in pipeline" };
+		return r;
+	}
+
+	//A careless lvalue chain, for contrast: every step copies the payload
+	result monadic_lvalues(std::size_t i) {
+		result r = start(i);
+		result a = r.and_then([](const payload& in) { return append(payload(in)); });
+		result b = a.transform([](const payload& in) { return double_all(payload(in)); });
+		result c = b.and_then([](const payload& in) { return drop_front(payload(in)); });
+		return c;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	std::size_t n = dp_bench::iterations(500000, argc, argv);
+	dp_bench::print_header("ten-step pipeline over a 64-element vector");
+	dp_bench::run("and_then/transform chain (rvalue)", n, [](std::size_t i) { result r = monadic(i); dp_bench::do_not_optimize(r); });
+	dp_bench::run("hand-written has_value() branches", n, [](std::size_t i) { result r = by_hand(i); dp_bench::do_not_optimize(r); });
+	dp_bench::run("three-step chain through lvalues", n, [](std::size_t i) { result r = monadic_lvalues(i); dp_bench::do_not_optimize(r); });
+	return 0;
+}
@@ -0,0 +1,90 @@
+//intrusive_cow_ptr against cow_ptr: the size of a handle and of what it allocates, then the cost of copying a handle, checking
+//uniqueness, detaching and reading through a large array of handles.
+
+#include "cpp98/cow_ptr.h"
+#include "cpp98/intrusive_cow_ptr.h"
+
+#include "bench_support.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+	struct plain_payload {
+		int values[8] = {};
+	};
+
+	struct intrusive_payload : dp::intrusive_cow_base<intrusive_payload> {
+		int values[8] = {};
+	};
+
+	void sizes() {
+		std::printf("\nsizes\n");
+		std::printf("  %-44s %6zu bytes\n", "dp::cow_ptr handle", sizeof(dp::cow_ptr<plain_payload>));
+		std::printf("  %-44s %6zu bytes\n", "dp::intrusive_cow_ptr handle", sizeof(dp::intrusive_cow_ptr<intrusive_payload>));
+		std::printf("  %-44s %6zu bytes\n", "payload", sizeof(plain_payload));
+		std::printf("  %-44s %6zu bytes\n", "payload with intrusive count and manager", sizeof(intrusive_payload));
+
+		std::size_t before = dp_bench::allocated_bytes();
+		{
+			dp::cow_ptr<plain_payload> cow = dp::make_cow<plain_payload>();
+			std::printf("  %-44s %6zu bytes\n", "allocated by dp::make_cow", dp_bench::allocated_bytes() - before);
+		}
+		before = dp_bench::allocated_bytes();
+		{
+			dp::intrusive_cow_ptr<intrusive_payload> intrusive = dp::make_intrusive_cow<intrusive_payload>();
+			std::printf("  %-44s %6zu bytes\n", "allocated by dp::make_intrusive_cow", dp_bench::allocated_bytes() - before);
+		}
+	}
+
+	void handles(std::size_t n) {
+		dp::cow_ptr<plain_payload> cow = dp::make_cow<plain_payload>();
+		dp::intrusive_cow_ptr<intrusive_payload> intrusive = dp::make_intrusive_cow<intrusive_payload>();
+
+		dp_bench::print_header("copy and destroy a handle");
+		dp_bench::run("dp::cow_ptr", n, [&](std::size_t) { dp::cow_ptr<plain_payload> p(cow); dp_bench::do_not_optimize(p); });
+		dp_bench::run("dp::intrusive_cow_ptr", n, [&](std::size_t) { dp::intrusive_cow_ptr<intrusive_payload> p(intrusive); dp_bench::do_not_optimize(p); });
+
+		dp_bench::print_header("write through a shared handle (detach)");
+		dp_bench::run("dp::cow_ptr", n, [&](std::size_t i) {
+			dp::cow_ptr<plain_payload> p(cow);
+			p->values[0] = static_cast<int>(i);
+			dp_bench::do_not_optimize(p);
+		});
+		dp_bench::run("dp::intrusive_cow_ptr", n, [&](std::size_t i) {
+			dp::intrusive_cow_ptr<intrusive_payload> p(intrusive);
+			p->values[0] = static_cast<int>(i);
+			dp_bench::do_not_optimize(p);
+		});
+
+		dp_bench::print_header("write through a unique handle (uniqueness check only)");
+		dp_bench::run("dp::cow_ptr", n, [&](std::size_t i) { cow->values[0] = static_cast<int>(i); dp_bench::do_not_optimize(cow); });
+		dp_bench::run("dp::intrusive_cow_ptr", n, [&](std::size_t i) { intrusive->values[0] = static_cast<int>(i); dp_bench::do_not_optimize(intrusive); });
+	}
+
+	//Reads one value through each of many handles, where the size of the handle array and the extra control block both cost cache misses
+	template<typename Ptr>
+	void scan(const char* inName, std::size_t inCount, std::size_t inPasses) {
+		std::vector<Ptr> ptrs;
+		ptrs.reserve(inCount);
+		for (std::size_t i = 0; i < inCount; ++i) ptrs.push_back(Ptr(new typename Ptr::element_type));
+		const std::vector<Ptr>& constPtrs = ptrs;
+		long long total = 0;
+		dp_bench::run(inName, inPasses, [&](std::size_t) {
+			for (std::size_t i = 0; i < constPtrs.size(); ++i) total += constPtrs[i]->values[0] + static_cast<long long>(constPtrs[i].unique());
+		});
+		dp_bench::do_not_optimize(total);
+	}
+
+}
+
+int main(int argc, char** argv) {
+	std::size_t n = dp_bench::iterations(4000000, argc, argv);
+	sizes();
+	handles(n);
+	dp_bench::print_header("scan 1M handles, reading and checking uniqueness (per pass)");
+	scan<dp::cow_ptr<plain_payload> >("dp::cow_ptr", 1 << 20, 20);
+	scan<dp::intrusive_cow_ptr<intrusive_payload> >("dp::intrusive_cow_ptr", 1 << 20, 20);
+	return 0;
+}
@@ -0,0 +1,40 @@
+//Fill-constructed arrays of 1M ints: make_cow<T[]>(N, u), which default-constructs and then assigns every element, against
+//make_lazy_cow<T[]>(N, u) when the array is only read and when it is written once.
+
+#include "cpp98/cow_ptr.h"
+#include "cpp98/lazy_cow_array.h"
+
+#include "bench_support.h"
+
+namespace {
+
+	const std::size_t kSize = 1 << 20;
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t n = dp_bench::iterations(2000, argc, argv);
+
+	dp_bench::print_header("create a 1M element array filled with -1, then read one element");
+	dp_bench::run("dp::make_cow<int[]>", n, [](std::size_t i) {
+		const dp::cow_ptr<int[]> array = dp::make_cow<int[]>(kSize, -1);
+		dp_bench::do_not_optimize(array[i % kSize]);
+	});
+	dp_bench::run("dp::make_lazy_cow<int[]>", n, [](std::size_t i) {
+		const dp::lazy_cow_array<int> array = dp::make_lazy_cow<int[]>(kSize, -1);
+		dp_bench::do_not_optimize(array[i % kSize]);
+	});
+
+	dp_bench::print_header("create a 1M element array filled with -1, then write one element");
+	dp_bench::run("dp::make_cow<int[]>", n, [](std::size_t i) {
+		dp::cow_ptr<int[]> array = dp::make_cow<int[]>(kSize, -1);
+		array[i % kSize] = 1;
+		dp_bench::do_not_optimize(array);
+	});
+	dp_bench::run("dp::make_lazy_cow<int[]>", n, [](std::size_t i) {
+		dp::lazy_cow_array<int> array = dp::make_lazy_cow<int[]>(kSize, -1);
+		array[i % kSize] = 1;
+		dp_bench::do_not_optimize(array);
+	});
+	return 0;
+}
@@ -0,0 +1,93 @@
+//Versioned key/value snapshots: persistent_hash_map against a cow_ptr to a std::unordered_map, which copies the whole map on the
+//first write to each new version. Reports the memory held by many live versions, the latency of making a new version with one
+//insert, and lookup latency.
+
+#include "cpp98/cow_ptr.h"
+#include "cpp98/persistent_hash_map.h"
+
+#include "bench_support.h"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+	typedef dp::persistent_hash_map<int, int, std::hash<int> > hamt;
+	typedef std::unordered_map<int, int> flat;
+
+	hamt make_hamt(int inSize) {
+		hamt result;
+		for (int i = 0; i < inSize; ++i) result.insert(i, i);
+		return result;
+	}
+
+	dp::cow_ptr<flat> make_flat(int inSize) {
+		dp::cow_ptr<flat> result = dp::make_cow<flat>();
+		for (int i = 0; i < inSize; ++i) result->emplace(i, i);
+		return result;
+	}
+
+	//Bytes allocated while keeping inVersions versions alive, each one insert away from the last
+	template<typename Map, typename Insert>
+	std::size_t versions_memory(Map inBase, std::size_t inVersions, Insert insert) {
+		std::vector<Map> kept;
+		kept.reserve(inVersions);
+		std::size_t before = dp_bench::allocated_bytes();
+		Map current = inBase;
+		for (std::size_t v = 0; v < inVersions; ++v) {
+			insert(current, static_cast<int>(v) + 1000000000);
+			kept.push_back(current);
+		}
+		return dp_bench::allocated_bytes() - before;
+	}
+
+	void run_size(int inSize, std::size_t inVersions) {
+		char title[128];
+		std::snprintf(title, sizeof(title), "%d entries: new version with one insert (per version)", inSize);
+		dp_bench::print_header(title);
+
+		hamt persistent = make_hamt(inSize);
+		dp_bench::run("dp::persistent_hash_map", inVersions, [&](std::size_t v) {
+			hamt next = persistent;
+			next.insert_or_assign(static_cast<int>(v % static_cast<std::size_t>(inSize)), static_cast<int>(v));
+			persistent.swap(next);
+		});
+		dp::cow_ptr<flat> cow = make_flat(inSize);
+		dp_bench::run("dp::cow_ptr<std::unordered_map>", inVersions, [&](std::size_t v) {
+			dp::cow_ptr<flat> next = cow;
+			(*next)[static_cast<int>(v % static_cast<std::size_t>(inSize))] = static_cast<int>(v);
+			cow.swap(next);
+		});
+
+		std::snprintf(title, sizeof(title), "%d entries: lookup (per lookup)", inSize);
+		dp_bench::print_header(title);
+		const hamt& constPersistent = persistent;
+		const dp::cow_ptr<flat>& constCow = cow;
+		long long total = 0;
+		std::size_t lookups = inVersions * 100;
+		dp_bench::run("dp::persistent_hash_map", lookups, [&](std::size_t i) {
+			total += *constPersistent.find(static_cast<int>((i * 7919) % static_cast<std::size_t>(inSize)));
+		});
+		dp_bench::run("dp::cow_ptr<std::unordered_map>", lookups, [&](std::size_t i) {
+			total += constCow->find(static_cast<int>((i * 7919) % static_cast<std::size_t>(inSize)))->second;
+		});
+		dp_bench::do_not_optimize(total);
+
+		const std::size_t kept = std::min<std::size_t>(inVersions, 64);
+		std::size_t hamtBytes = versions_memory(persistent, kept, [](hamt& map, int key) { map.insert(key, key); });
+		std::size_t flatBytes = versions_memory(cow, kept, [](dp::cow_ptr<flat>& map, int key) { map->emplace(key, key); });
+		std::printf("%zu live versions, bytes allocated per version: dp::persistent_hash_map %zu, dp::cow_ptr<std::unordered_map> %zu\n",
+			kept, hamtBytes / kept, flatBytes / kept);
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t versions = dp_bench::iterations(2000, argc, argv);
+	const int sizes[] = { 1000, 100000, 1000000 };
+	//Copying the large flat maps takes milliseconds per version, so those sizes make fewer versions
+	for (int size : sizes) run_size(size, size >= 100000 ? versions / 20 + 1 : versions);
+	return 0;
+}
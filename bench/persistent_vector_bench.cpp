@@ -0,0 +1,70 @@
+//Keeping versions of a large sequence: persistent_vector against a cow_ptr to a std::vector, which copies the whole vector on the
+//first write to each new version. Each row makes a new version of the sequence and edits it, keeping the previous version alive.
+
+#include "cpp98/cow_ptr.h"
+#include "cpp98/persistent_vector.h"
+
+#include "bench_support.h"
+
+#include <vector>
+
+namespace {
+
+	typedef std::vector<int> flat;
+
+	dp::persistent_vector<int> make_persistent(std::size_t inSize) {
+		dp::persistent_vector<int> result;
+		for (std::size_t i = 0; i < inSize; ++i) result.push_back(static_cast<int>(i));
+		return result;
+	}
+
+	dp::cow_ptr<flat> make_flat(std::size_t inSize) {
+		dp::cow_ptr<flat> result = dp::make_cow<flat>();
+		for (std::size_t i = 0; i < inSize; ++i) result->push_back(static_cast<int>(i));
+		return result;
+	}
+
+	void versions(std::size_t inSize, std::size_t inVersions, std::size_t inEditsPerVersion) {
+		char title[128];
+		std::snprintf(title, sizeof(title), "%zu elements, %zu edit(s) per new version (per version)", inSize, inEditsPerVersion);
+		dp_bench::print_header(title);
+
+		dp::persistent_vector<int> persistent = make_persistent(inSize);
+		dp_bench::run("dp::persistent_vector", inVersions, [&](std::size_t v) {
+			dp::persistent_vector<int> next = persistent;
+			for (std::size_t e = 0; e < inEditsPerVersion; ++e) next.set((v * 7919 + e * 104729) % inSize, static_cast<int>(v));
+			persistent.swap(next);
+			dp_bench::do_not_optimize(next);
+		});
+
+		dp::cow_ptr<flat> cow = make_flat(inSize);
+		dp_bench::run("dp::cow_ptr<std::vector>", inVersions, [&](std::size_t v) {
+			dp::cow_ptr<flat> next = cow;
+			for (std::size_t e = 0; e < inEditsPerVersion; ++e) (*next)[(v * 7919 + e * 104729) % inSize] = static_cast<int>(v);
+			cow.swap(next);
+			dp_bench::do_not_optimize(next);
+		});
+	}
+
+	void reads(std::size_t inSize, std::size_t inReads) {
+		dp_bench::print_header("random reads from a const version (per read)");
+		const dp::persistent_vector<int> persistent = make_persistent(inSize);
+		const dp::cow_ptr<flat> cow = make_flat(inSize);
+		long long total = 0;
+		dp_bench::run("dp::persistent_vector", inReads, [&](std::size_t i) { total += persistent[(i * 7919) % inSize]; });
+		dp_bench::run("dp::cow_ptr<std::vector>", inReads, [&](std::size_t i) { total += (*cow)[(i * 7919) % inSize]; });
+		dp_bench::do_not_optimize(total);
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t versionCount = dp_bench::iterations(2000, argc, argv);
+	const std::size_t sizes[] = { 1000, 100000, 1000000 };
+	for (std::size_t size : sizes) {
+		versions(size, versionCount, 1);
+		versions(size, versionCount, 64);
+	}
+	reads(1000000, dp_bench::iterations(10000000, argc, argv));
+	return 0;
+}
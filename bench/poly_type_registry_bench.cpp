@@ -0,0 +1,225 @@
+//Encoding and decoding 1000 poly_value_ptr<shape> of three types: poly_type_registry's integer tags and codec table, against
+//a virtual serialize() which writes a string type name, decoded through a map of factories, and against a dynamic_cast chain.
+
+#include "cpp98/poly_type_registry.h"
+
+#include "bench_support.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+	typedef std::vector<unsigned char> bytes;
+
+	struct shape {
+		virtual ~shape() {}
+		virtual void serialize(bytes& out) const = 0;
+	};
+
+	void write_name(const char* inName, bytes& out) {
+		const std::string name(inName);
+		dp::write_varint(name.size(), out);
+		out.insert(out.end(), name.begin(), name.end());
+	}
+
+	struct circle : shape {
+		std::size_t radius = 0;
+		void serialize(bytes& out) const override {
+			write_name("circle", out);
+			dp::write_varint(radius, out);
+		}
+	};
+	struct rectangle : shape {
+		std::size_t width = 0;
+		std::size_t height = 0;
+		void serialize(bytes& out) const override {
+			write_name("rectangle", out);
+			dp::write_varint(width, out);
+			dp::write_varint(height, out);
+		}
+	};
+	struct triangle : shape {
+		std::size_t side = 0;
+		void serialize(bytes& out) const override {
+			write_name("triangle", out);
+			dp::write_varint(side, out);
+		}
+	};
+
+}
+
+namespace dp {
+
+	template<>
+	struct poly_codec<circle> {
+		static void encode(const circle& in, bytes& out) {
+			dp::write_varint(in.radius, out);
+		}
+		static circle* decode(const unsigned char*& cursor, const unsigned char* end) {
+			circle* result = new circle();
+			result->radius = dp::read_varint(cursor, end);
+			return result;
+		}
+	};
+	template<>
+	struct poly_codec<rectangle> {
+		static void encode(const rectangle& in, bytes& out) {
+			dp::write_varint(in.width, out);
+			dp::write_varint(in.height, out);
+		}
+		static rectangle* decode(const unsigned char*& cursor, const unsigned char* end) {
+			rectangle* result = new rectangle();
+			result->width = dp::read_varint(cursor, end);
+			result->height = dp::read_varint(cursor, end);
+			return result;
+		}
+	};
+	template<>
+	struct poly_codec<triangle> {
+		static void encode(const triangle& in, bytes& out) {
+			dp::write_varint(in.side, out);
+		}
+		static triangle* decode(const unsigned char*& cursor, const unsigned char* end) {
+			triangle* result = new triangle();
+			result->side = dp::read_varint(cursor, end);
+			return result;
+		}
+	};
+
+}
+
+namespace {
+
+	typedef dp::poly_value_ptr<shape> pointer;
+
+	const std::size_t kShapes = 1000;
+
+	std::vector<pointer> make_shapes() {
+		std::vector<pointer> result;
+		for (std::size_t i = 0; i < kShapes; ++i) {
+			switch (i % 3) {
+			case 0: {
+				circle* c = new circle();
+				c->radius = i;
+				result.push_back(pointer(dp::poly_t<circle>(), c));
+				break;
+			}
+			case 1: {
+				rectangle* r = new rectangle();
+				r->width = i;
+				r->height = i * 3;
+				result.push_back(pointer(dp::poly_t<rectangle>(), r));
+				break;
+			}
+			default: {
+				triangle* t = new triangle();
+				t->side = i;
+				result.push_back(pointer(dp::poly_t<triangle>(), t));
+			}
+			}
+		}
+		return result;
+	}
+
+	//The string-tagged format: each type is looked up by name to find the factory which reads the rest
+	typedef pointer (*factory)(const unsigned char*&, const unsigned char*);
+
+	template<typename T>
+	pointer make_from(const unsigned char*& cursor, const unsigned char* end) {
+		return pointer(dp::poly_t<T>(), dp::poly_codec<T>::decode(cursor, end));
+	}
+
+	const std::map<std::string, factory>& factories() {
+		static const std::map<std::string, factory> result = {
+			{ "circle", &make_from<circle> }, { "rectangle", &make_from<rectangle> }, { "triangle", &make_from<triangle> }
+		};
+		return result;
+	}
+
+	void decode_named(const bytes& in, std::vector<pointer>& out) {
+		const unsigned char* cursor = in.data();
+		const unsigned char* end = cursor + in.size();
+		const std::size_t count = dp::read_varint(cursor, end);
+		for (std::size_t i = 0; i < count; ++i) {
+			const std::size_t length = dp::read_varint(cursor, end);
+			const std::string name(reinterpret_cast<const char*>(cursor), length);
+			cursor += length;
+			out.push_back(factories().at(name)(cursor, end));
+		}
+	}
+
+	//A small integer tag chosen by a dynamic_cast chain
+	void encode_cast_chain(const std::vector<pointer>& in, bytes& out) {
+		dp::write_varint(in.size(), out);
+		for (const pointer& p : in) {
+			if (const circle* c = dynamic_cast<const circle*>(p.get())) {
+				dp::write_varint(1, out);
+				dp::poly_codec<circle>::encode(*c, out);
+			}
+			else if (const rectangle* r = dynamic_cast<const rectangle*>(p.get())) {
+				dp::write_varint(2, out);
+				dp::poly_codec<rectangle>::encode(*r, out);
+			}
+			else if (const triangle* t = dynamic_cast<const triangle*>(p.get())) {
+				dp::write_varint(3, out);
+				dp::poly_codec<triangle>::encode(*t, out);
+			}
+		}
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t n = dp_bench::iterations(2000, argc, argv);
+	const std::vector<pointer> shapes = make_shapes();
+
+	dp::poly_type_registry<shape> registry;
+	registry.register_type<circle>();
+	registry.register_type<rectangle>();
+	registry.register_type<triangle>();
+
+	bytes buffer;
+	buffer.reserve(kShapes * 16);
+
+	dp_bench::print_header("encode 1000 shapes (per batch)");
+	dp_bench::run("dp::poly_type_registry", n, [&](std::size_t) {
+		buffer.clear();
+		registry.encode_range(shapes.begin(), shapes.end(), buffer);
+		dp_bench::do_not_optimize(buffer.data());
+	});
+	dp_bench::run("virtual serialize, type names", n, [&](std::size_t) {
+		buffer.clear();
+		dp::write_varint(shapes.size(), buffer);
+		for (const pointer& p : shapes) p->serialize(buffer);
+		dp_bench::do_not_optimize(buffer.data());
+	});
+	dp_bench::run("dynamic_cast chain", n, [&](std::size_t) {
+		buffer.clear();
+		encode_cast_chain(shapes, buffer);
+		dp_bench::do_not_optimize(buffer.data());
+	});
+
+	bytes tagged;
+	registry.encode_range(shapes.begin(), shapes.end(), tagged);
+	bytes named;
+	dp::write_varint(shapes.size(), named);
+	for (const pointer& p : shapes) p->serialize(named);
+
+	std::vector<pointer> decoded;
+	decoded.reserve(kShapes);
+	dp_bench::print_header("decode 1000 shapes (per batch)");
+	dp_bench::run("dp::poly_type_registry", n, [&](std::size_t) {
+		decoded.clear();
+		const unsigned char* cursor = tagged.data();
+		registry.decode_range(cursor, cursor + tagged.size(), decoded);
+		dp_bench::do_not_optimize(decoded.data());
+	});
+	dp_bench::run("type names, factory map", n, [&](std::size_t) {
+		decoded.clear();
+		decode_named(named, decoded);
+		dp_bench::do_not_optimize(decoded.data());
+	});
+	return 0;
+}
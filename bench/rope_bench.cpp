@@ -0,0 +1,79 @@
+//Versioned editing of large text: rope against a flat copy-on-write buffer (a cow_ptr to a std::string), which copies the whole
+//buffer when a new version is first written. Each row makes a new version with one keystroke-sized edit and keeps the old one.
+
+#include "cpp98/cow_ptr.h"
+#include "cpp98/rope.h"
+
+#include "bench_support.h"
+
+#include <string>
+
+namespace {
+
+	typedef dp::cow_ptr<std::string> flat;
+
+	std::string make_text(std::size_t inSize) {
+		std::string result(inSize, ' ');
+		for (std::size_t i = 0; i < inSize; ++i) result[i] = static_cast<char>('a' + i % 26);
+		return result;
+	}
+
+	void edits(std::size_t inSize, std::size_t inVersions) {
+		char title[128];
+		std::snprintf(title, sizeof(title), "%zu byte text: new version with one edit (per version)", inSize);
+		dp_bench::print_header(title);
+		const std::string text = make_text(inSize);
+
+		dp::rope rope(text);
+		dp_bench::run("dp::rope insert", inVersions, [&](std::size_t v) {
+			dp::rope next = rope;
+			next.insert((v * 7919) % next.size(), "abc");
+			rope.swap(next);
+		});
+		dp_bench::run("dp::rope erase", inVersions, [&](std::size_t v) {
+			dp::rope next = rope;
+			next.erase((v * 7919) % (next.size() - 3), 3);
+			rope.swap(next);
+		});
+
+		flat buffer = dp::make_cow<std::string>(text);
+		dp_bench::run("dp::cow_ptr<std::string> insert", inVersions, [&](std::size_t v) {
+			flat next = buffer;
+			next->insert((v * 7919) % next->size(), "abc");
+			buffer.swap(next);
+		});
+		dp_bench::run("dp::cow_ptr<std::string> erase", inVersions, [&](std::size_t v) {
+			flat next = buffer;
+			next->erase((v * 7919) % (next->size() - 3), 3);
+			buffer.swap(next);
+		});
+	}
+
+	void output(std::size_t inSize, std::size_t inPasses) {
+		dp_bench::print_header("write out a 1 MiB text through its chunks (per pass)");
+		const dp::rope rope(make_text(inSize));
+		const flat buffer = dp::make_cow<std::string>(make_text(inSize));
+		std::size_t total = 0;
+		dp_bench::run("dp::rope chunk_iterator", inPasses, [&](std::size_t) {
+			for (dp::rope::chunk_iterator it = rope.chunks_begin(); it != rope.chunks_end(); ++it) {
+				dp_bench::do_not_optimize((*it).data);
+				total += (*it).size;
+			}
+		});
+		dp_bench::run("dp::rope str()", inPasses, [&](std::size_t) { total += rope.str().size(); });
+		dp_bench::run("dp::cow_ptr<std::string>", inPasses, [&](std::size_t) {
+			dp_bench::do_not_optimize(buffer->data());
+			total += buffer->size();
+		});
+		dp_bench::do_not_optimize(total);
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t versions = dp_bench::iterations(20000, argc, argv);
+	const std::size_t sizes[] = { 64 << 10, 1 << 20, 8 << 20 };
+	for (std::size_t size : sizes) edits(size, size > (1 << 20) ? versions / 20 + 1 : versions);
+	output(1 << 20, dp_bench::iterations(2000, argc, argv));
+	return 0;
+}
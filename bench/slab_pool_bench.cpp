@@ -0,0 +1,82 @@
+//Allocation churn of small cow_ptr objects: make_cow, which takes both the control block and the object from operator new, against
+//allocate_cow with a slab_allocator for the block, with and without an object type deriving from slab_allocated.
+
+#include "cpp98/cow_ptr.h"
+#include "cpp98/slab_pool.h"
+
+#include "bench_support.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+	struct plain {
+		int values[4];
+		explicit plain(int in) : values{ in, in, in, in } {}
+	};
+	struct pooled : dp::slab_allocated<pooled> {
+		int values[4];
+		explicit pooled(int in) : values{ in, in, in, in } {}
+	};
+
+	dp::cow_ptr<plain> make_plain(int in) {
+		return dp::make_cow<plain>(in);
+	}
+	dp::cow_ptr<plain> allocate_plain(int in) {
+		return dp::allocate_cow<plain>(dp::slab_allocator<plain>(), in);
+	}
+	dp::cow_ptr<pooled> allocate_pooled(int in) {
+		return dp::allocate_cow<pooled>(dp::slab_allocator<pooled>(), in);
+	}
+
+	const std::size_t kLive = 4096;
+
+	//Replaces one slot of a live working set per step, then copies and detaches it, so blocks are freed in a scattered order
+	template<typename T>
+	struct churn {
+		std::vector<dp::cow_ptr<T>> live;
+		dp::cow_ptr<T> (*make)(int);
+
+		explicit churn(dp::cow_ptr<T> (*inMake)(int)) : live(kLive), make(inMake) {}
+
+		void operator()(std::size_t i) {
+			dp::cow_ptr<T>& slot = live[(i * 2654435761u) % kLive];
+			slot = make(static_cast<int>(i));
+			dp::cow_ptr<T> copy = slot;
+			copy->values[0] = 1;
+			dp_bench::do_not_optimize(copy);
+		}
+	};
+
+	template<typename T>
+	void run_threads(const char* inName, std::size_t inThreads, std::size_t inSteps, dp::cow_ptr<T> (*inMake)(int)) {
+		dp_bench::run(inName, 1, [&](std::size_t) {
+			std::vector<std::thread> threads;
+			for (std::size_t t = 0; t < inThreads; ++t) {
+				threads.emplace_back([=] {
+					churn<T> steps(inMake);
+					for (std::size_t i = 0; i < inSteps; ++i) steps(i);
+				});
+			}
+			for (std::thread& thread : threads) thread.join();
+		});
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t n = dp_bench::iterations(2000000, argc, argv);
+
+	dp_bench::print_header("replace, copy and detach a 16 byte object in a working set of 4096 (per step)");
+	dp_bench::run("dp::make_cow", n, churn<plain>(make_plain));
+	dp_bench::run("dp::allocate_cow, pooled block", n, churn<plain>(allocate_plain));
+	dp_bench::run("dp::allocate_cow, pooled block and object", n, churn<pooled>(allocate_pooled));
+
+	const std::size_t threadSteps = n / 4 + 1;
+	dp_bench::print_header("the same churn on 4 threads at once (per run of n/4 steps on each thread)");
+	run_threads<plain>("dp::make_cow", 4, threadSteps, make_plain);
+	run_threads<plain>("dp::allocate_cow, pooled block", 4, threadSteps, allocate_plain);
+	run_threads<pooled>("dp::allocate_cow, pooled block and object", 4, threadSteps, allocate_pooled);
+	return 0;
+}
@@ -0,0 +1,145 @@
+//Construction, copy, move, detach, reset and destruction costs of cow_ptr, value_ptr and poly_value_ptr, against the standard smart
+//pointers and raw new. Each row reports nanoseconds and global allocations per operation.
+
+#include "cpp98/cow_ptr.h"
+#include "cpp98/poly_value_ptr.h"
+#include "cpp98/value_ptr.h"
+
+#include "bench_support.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+
+	struct payload {
+		int values[16];
+		payload() : values() {}
+		virtual ~payload() {}
+		virtual int sum() const {
+			int total = 0;
+			for (int i = 0; i < 16; ++i) total += values[i];
+			return total;
+		}
+	};
+
+	struct derived_payload : payload {
+		int extra = 1;
+		int sum() const override {
+			return payload::sum() + extra;
+		}
+	};
+
+	template<typename Ptr, typename Make>
+	void bench_destroy(const char* inName, std::size_t inCount, Make make) {
+		std::vector<Ptr> ptrs;
+		ptrs.reserve(inCount);
+		for (std::size_t i = 0; i < inCount; ++i) ptrs.push_back(make());
+		dp_bench::run(inName, inCount, [&](std::size_t i) { ptrs[i].reset(); });
+	}
+
+	void construction(std::size_t n) {
+		dp_bench::print_header("construct and destroy");
+		dp_bench::run("raw new/delete", n, [](std::size_t) { payload* p = new payload; dp_bench::do_not_optimize(p); delete p; });
+		dp_bench::run("std::unique_ptr", n, [](std::size_t) { auto p = std::make_unique<payload>(); dp_bench::do_not_optimize(p); });
+		dp_bench::run("std::shared_ptr(new)", n, [](std::size_t) { std::shared_ptr<payload> p(new payload); dp_bench::do_not_optimize(p); });
+		dp_bench::run("std::make_shared", n, [](std::size_t) { auto p = std::make_shared<payload>(); dp_bench::do_not_optimize(p); });
+		dp_bench::run("dp::cow_ptr(new)", n, [](std::size_t) { dp::cow_ptr<payload> p(new payload); dp_bench::do_not_optimize(p); });
+		dp_bench::run("dp::make_cow", n, [](std::size_t) { dp::cow_ptr<payload> p = dp::make_cow<payload>(); dp_bench::do_not_optimize(p); });
+		dp_bench::run("dp::value_ptr", n, [](std::size_t) { dp::value_ptr<payload> p(new payload); dp_bench::do_not_optimize(p); });
+		dp_bench::run("dp::poly_value_ptr", n, [](std::size_t) { dp::poly_value_ptr<payload> p(dp::poly_t<derived_payload>(), new derived_payload); dp_bench::do_not_optimize(p); });
+	}
+
+	void copying(std::size_t n) {
+		dp_bench::print_header("copy (shared ownership or deep copy) and destroy the copy");
+		payload* raw = new payload;
+		auto unique = std::make_unique<payload>();
+		auto shared = std::make_shared<payload>();
+		dp::cow_ptr<payload> cow = dp::make_cow<payload>();
+		dp::value_ptr<payload> value(new payload);
+		dp::poly_value_ptr<payload> poly(dp::poly_t<derived_payload>(), new derived_payload);
+
+		dp_bench::run("raw new copy", n, [&](std::size_t) { payload* p = new payload(*raw); dp_bench::do_not_optimize(p); delete p; });
+		dp_bench::run("std::unique_ptr deep copy", n, [&](std::size_t) { auto p = std::make_unique<payload>(*unique); dp_bench::do_not_optimize(p); });
+		dp_bench::run("std::shared_ptr copy", n, [&](std::size_t) { std::shared_ptr<payload> p(shared); dp_bench::do_not_optimize(p); });
+		dp_bench::run("dp::cow_ptr copy", n, [&](std::size_t) { dp::cow_ptr<payload> p(cow); dp_bench::do_not_optimize(p); });
+		dp_bench::run("dp::value_ptr copy", n, [&](std::size_t) { dp::value_ptr<payload> p(value); dp_bench::do_not_optimize(p); });
+		dp_bench::run("dp::poly_value_ptr copy (clone dispatch)", n, [&](std::size_t) { dp::poly_value_ptr<payload> p(poly); dp_bench::do_not_optimize(p); });
+		delete raw;
+	}
+
+	void moving(std::size_t n) {
+		dp_bench::print_header("move (or swap, for cow_ptr) between two handles");
+		auto unique = std::make_unique<payload>();
+		auto shared = std::make_shared<payload>();
+		dp::cow_ptr<payload> cow = dp::make_cow<payload>();
+		dp::value_ptr<payload> value(new payload);
+		dp::poly_value_ptr<payload> poly(dp::poly_t<derived_payload>(), new derived_payload);
+
+		dp_bench::run("std::unique_ptr move", n, [&](std::size_t) { auto p = std::move(unique); unique = std::move(p); });
+		dp_bench::run("std::shared_ptr move", n, [&](std::size_t) { auto p = std::move(shared); shared = std::move(p); });
+		dp_bench::run("dp::cow_ptr swap", n, [&](std::size_t) { dp::cow_ptr<payload> p; p.swap(cow); cow.swap(p); });
+		dp_bench::run("dp::value_ptr move", n, [&](std::size_t) { auto p = std::move(value); value = std::move(p); });
+		dp_bench::run("dp::poly_value_ptr move", n, [&](std::size_t) { auto p = std::move(poly); poly = std::move(p); });
+	}
+
+	void detaching(std::size_t n) {
+		dp_bench::print_header("write through a shared handle");
+		auto shared = std::make_shared<payload>();
+		dp::cow_ptr<payload> cow = dp::make_cow<payload>();
+		dp::cow_ptr<payload> unique = dp::make_cow<payload>();
+
+		dp_bench::run("std::shared_ptr manual copy then write", n, [&](std::size_t i) {
+			std::shared_ptr<payload> p(shared);
+			p = std::make_shared<payload>(*p);
+			p->values[0] = static_cast<int>(i);
+			dp_bench::do_not_optimize(p);
+		});
+		dp_bench::run("dp::cow_ptr detach then write", n, [&](std::size_t i) {
+			dp::cow_ptr<payload> p(cow);
+			p->values[0] = static_cast<int>(i);
+			dp_bench::do_not_optimize(p);
+		});
+		dp_bench::run("dp::cow_ptr write while unique", n, [&](std::size_t i) {
+			unique->values[0] = static_cast<int>(i);
+			dp_bench::do_not_optimize(unique);
+		});
+	}
+
+	void resetting(std::size_t n) {
+		dp_bench::print_header("reset to a new object");
+		auto unique = std::make_unique<payload>();
+		auto shared = std::make_shared<payload>();
+		dp::cow_ptr<payload> cow = dp::make_cow<payload>();
+		dp::value_ptr<payload> value(new payload);
+		dp::poly_value_ptr<payload> poly(dp::poly_t<derived_payload>(), new derived_payload);
+
+		dp_bench::run("std::unique_ptr reset", n, [&](std::size_t) { unique.reset(new payload); });
+		dp_bench::run("std::shared_ptr reset", n, [&](std::size_t) { shared.reset(new payload); });
+		dp_bench::run("dp::cow_ptr reset", n, [&](std::size_t) { cow.reset(new payload); });
+		dp_bench::run("dp::value_ptr reset", n, [&](std::size_t) { value.reset(new payload); });
+		dp_bench::run("dp::poly_value_ptr reset", n, [&](std::size_t) { poly.reset(new derived_payload); });
+	}
+
+	void destruction(std::size_t n) {
+		dp_bench::print_header("destroy the last owner");
+		bench_destroy<std::unique_ptr<payload> >("std::unique_ptr", n, [] { return std::make_unique<payload>(); });
+		bench_destroy<std::shared_ptr<payload> >("std::shared_ptr", n, [] { return std::make_shared<payload>(); });
+		bench_destroy<dp::cow_ptr<payload> >("dp::cow_ptr", n, [] { return dp::make_cow<payload>(); });
+		bench_destroy<dp::value_ptr<payload> >("dp::value_ptr", n, [] { return dp::value_ptr<payload>(new payload); });
+		bench_destroy<dp::poly_value_ptr<payload> >("dp::poly_value_ptr", n, [] { return dp::poly_value_ptr<payload>(dp::poly_t<derived_payload>(), new derived_payload); });
+	}
+
+}
+
+int main(int argc, char** argv) {
+	std::size_t n = dp_bench::iterations(2000000, argc, argv);
+	construction(n);
+	copying(n);
+	moving(n);
+	detaching(n);
+	resetting(n);
+	destruction(n / 4);
+	return 0;
+}
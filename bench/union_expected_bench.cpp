@@ -0,0 +1,94 @@
+//Reporting a failure from three calls deep, built as C++98: the union-based dp::expected returned through each layer, against
+//throwing an exception from the bottom and catching it at the top. Each row parses one input; inputs fail at the given rate.
+
+#include "cpp98/union_expected.h"
+
+#include "bench_support.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+	enum parse_error {
+		negative,
+		too_large
+	};
+
+	typedef dp::expected<int, parse_error> result;
+
+	result check_range(int in) {
+		if (in < 0) return dp::unex(negative);
+		if (in > 1000000) return dp::unex(too_large);
+		return in;
+	}
+	result scale(int in) {
+		const result checked = check_range(in);
+		if (!checked) return dp::unex(checked.error());
+		return *checked * 3;
+	}
+	result parse(int in) {
+		const result scaled = scale(in);
+		if (!scaled) return dp::unex(scaled.error());
+		return *scaled + 1;
+	}
+
+	int check_range_or_throw(int in) {
+		if (in < 0) throw std::domain_error("negative");
+		if (in > 1000000) throw std::out_of_range("too large");
+		return in;
+	}
+	int scale_or_throw(int in) {
+		return check_range_or_throw(in) * 3;
+	}
+	int parse_or_throw(int in) {
+		return scale_or_throw(in) + 1;
+	}
+
+	//Without lambdas, each case is a function object over the shared inputs
+	struct with_expected {
+		const std::vector<int>* inputs;
+		long* total;
+		void operator()(std::size_t i) const {
+			const result parsed = parse((*inputs)[i % inputs->size()]);
+			*total += parsed ? *parsed : -1;
+		}
+	};
+
+	struct with_exceptions {
+		const std::vector<int>* inputs;
+		long* total;
+		void operator()(std::size_t i) const {
+			try {
+				*total += parse_or_throw((*inputs)[i % inputs->size()]);
+			}
+			catch (const std::exception&) {
+				*total -= 1;
+			}
+		}
+	};
+
+	void compare(std::size_t inFailEvery, std::size_t inIterations) {
+		char title[96];
+		std::sprintf(title, "parse through three layers, one input in %lu fails", static_cast<unsigned long>(inFailEvery));
+		dp_bench::print_header(title);
+
+		std::vector<int> inputs(4096);
+		for (std::size_t i = 0; i < inputs.size(); ++i) inputs[i] = (i % inFailEvery == inFailEvery - 1) ? -static_cast<int>(i) : static_cast<int>(i);
+
+		long total = 0;
+		const with_expected expectedCase = { &inputs, &total };
+		const with_exceptions exceptionCase = { &inputs, &total };
+		dp_bench::run("dp::expected (union, C++98)", inIterations, expectedCase);
+		dp_bench::run("exceptions", inIterations, exceptionCase);
+		dp_bench::do_not_optimize(total);
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const std::size_t n = dp_bench::iterations(2000000, argc, argv);
+	const std::size_t rates[] = { 1000, 100, 10, 2 };
+	for (std::size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i) compare(rates[i], n);
+	return 0;
+}
@@ -0,0 +1,114 @@
+#ifndef DP_CPP17_COW_PUBLISHER
+#define DP_CPP17_COW_PUBLISHER
+
+#include "cpp98/cow_ptr.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+/*
+*	Read-side replication for a hot cow_ptr snapshot.
+*	A cow_publisher holds the current version of some shared object, and each reading thread keeps its own cow_reader. A reader
+*	caches its own copy of the snapshot and only takes a new copy when the writer has published a new version, so in steady
+*	state a read is a single load of a version number which is written once per publish. Readers never touch the shared
+*	reference count between publishes, so the count's cache line does not bounce between cores.
+*
+*	As with sharing any cow_ptr between threads, this requires cow_ptr's reference counts to be safe to update concurrently,
+*	which is checked when a publisher is instantiated.
+*/
+namespace dp {
+
+	namespace detail {
+		template<typename Count>
+		inline constexpr bool is_atomic_count = false;
+		template<typename U>
+		inline constexpr bool is_atomic_count<std::atomic<U>> = true;
+	}
+
+	template<typename T>
+	class cow_reader;
+
+	template<typename T>
+	class cow_publisher {
+		static_assert(detail::is_atomic_count<dp::detail::cow_count_type>,
+			"cow_publisher shares cow_ptr between threads, which needs atomic reference counts");
+
+		mutable std::mutex m_lock;
+		dp::cow_ptr<T> m_current;
+		//Kept on its own cache line, as every reader polls it
+		alignas(64) std::atomic<std::uint64_t> m_version;
+
+		friend class cow_reader<T>;
+
+	public:
+		cow_publisher() : m_lock{}, m_current{}, m_version{ 0 } {}
+		explicit cow_publisher(const dp::cow_ptr<T>& inInitial) : m_lock{}, m_current{ inInitial }, m_version{ 0 } {}
+
+		cow_publisher(const cow_publisher&) = delete;
+		cow_publisher& operator=(const cow_publisher&) = delete;
+
+		void publish(const dp::cow_ptr<T>& inNext) {
+			std::lock_guard<std::mutex> lock{ m_lock };
+			m_current = inNext;
+			m_version.fetch_add(1, std::memory_order_release);
+		}
+
+		//The slow path: a fresh copy of the current version, taken under the lock
+		dp::cow_ptr<T> load() const {
+			std::lock_guard<std::mutex> lock{ m_lock };
+			return m_current;
+		}
+
+		std::uint64_t version() const noexcept {
+			return m_version.load(std::memory_order_acquire);
+		}
+	};
+
+
+	//A reader's cached view of a cow_publisher. Each reader belongs to one thread; a reader must not outlive its publisher.
+	template<typename T>
+	class cow_reader {
+		const cow_publisher<T>* m_publisher;
+		dp::cow_ptr<T> m_cached;
+		std::uint64_t m_version;
+
+		void reload() {
+			std::lock_guard<std::mutex> lock{ m_publisher->m_lock };
+			m_cached = m_publisher->m_current;
+			m_version = m_publisher->m_version.load(std::memory_order_relaxed);
+		}
+
+	public:
+		explicit cow_reader(const cow_publisher<T>& inPublisher) : m_publisher{ &inPublisher }, m_cached{}, m_version{ 0 } {
+			reload();
+		}
+
+		//Takes a new copy of the snapshot if one has been published since we last looked. Returns whether anything changed.
+		bool refresh() {
+			if (m_publisher->m_version.load(std::memory_order_acquire) == m_version) return false;
+			reload();
+			return true;
+		}
+
+		const dp::cow_ptr<T>& snapshot() {
+			refresh();
+			return m_cached;
+		}
+
+		const T& operator*() {
+			return *snapshot();
+		}
+		const T* operator->() {
+			return snapshot().get();
+		}
+
+		//The version of the snapshot we currently hold, without checking for a newer one
+		std::uint64_t version() const noexcept {
+			return m_version;
+		}
+	};
+
+}
+
+#endif
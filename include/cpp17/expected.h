@@ -1,22 +1,144 @@
 #ifndef DP_CPP17_EXPECTED
 #define DP_CPP17_EXPECTED
 
-#ifdef DP_CPP98_EXPECTED
+#if defined(DP_CPP98_EXPECTED) || defined(DP_CPP98_UNION_EXPECTED)
 #error "Both C++98 and C++17 dp::expected detected. Only use one or the other"
 #endif
 
+#include <exception>
 #include <stdexcept>
 #include <variant>
 #include <utility>
 #include <type_traits>
+#include <functional>
+
+#ifdef DP_EXPECTED_TRACE
+#include <cstddef>
+#include <cstdio>
+#include <typeinfo>
+#endif
 
 /*
 *	An analogue of std::expected, written in C++17
 *	Intended as an update to my C++98 expected but is entirely standalone and C++17-compliant
 *
+*	Defining DP_EXPECTED_TRACE before including this header records where each error came from. Every time an error is created through
+*	dp::unexpected or dp::unexpect, the file and line of the expression which created it, and the error's type if RTTI is enabled, are
+*	written to a fixed-size ring buffer belonging to the current thread, without locking or allocating. The location is taken through
+*	defaulted __builtin_FILE() and __builtin_LINE() arguments, so it is exact with inlining and optimisation, but an error created inside
+*	a forwarding function such as emplace is recorded at the place that function builds it. Errors which the library only passes on,
+*	such as through and_then or transform_error, are not recorded again, so each record is an origin. dump_error_origins() prints
+*	the most recent records.
+*	Without DP_EXPECTED_TRACE none of this exists and the constructors are unchanged.
+*	Tracing changes the constructors of unexpected and expected, so when it is on they are declared in the inline namespace
+*	dp::expected_traced. They keep the same names in source, but are distinct types to the linker, so translation units built with
+*	and without DP_EXPECTED_TRACE can be linked together without breaking the one definition rule. Neither can pass an expected to
+*	the other, so a program should still agree on the setting across any interface which traffics in expected.
 */
 namespace dp {
 
+#ifdef DP_EXPECTED_TRACE
+
+#ifndef DP_EXPECTED_TRACE_CAPACITY
+#define DP_EXPECTED_TRACE_CAPACITY 64
+#endif
+
+//typeid can't be used without RTTI, in which case records carry no type
+#if defined(__GXX_RTTI) || defined(__cpp_rtti) || defined(_CPPRTTI)
+#define DP_EXPECTED_TRACE_TYPE(ErrType) (&typeid(ErrType))
+#else
+#define DP_EXPECTED_TRACE_TYPE(ErrType) (static_cast<const std::type_info*>(nullptr))
+#endif
+
+	struct error_origin {
+		const char* file;
+		unsigned line;
+		const std::type_info* type;
+	};
+
+	namespace detail {
+		//A source location which, as a defaulted argument, is the location of the caller
+		struct error_site {
+			const char* file;
+			unsigned line;
+
+			static constexpr error_site current(const char* inFile = __builtin_FILE(), unsigned inLine = __builtin_LINE()) noexcept {
+				return error_site{ inFile, inLine };
+			}
+		};
+
+		//Converts implicitly from a tag such as dp::unexpect, picking up the location of the expression which passed the tag.
+		//The library passes on existing errors with a tag which has no file, and those are not recorded.
+		template<typename Tag>
+		struct traced_tag {
+			error_site site;
+
+			constexpr traced_tag(Tag, error_site inSite = error_site::current()) noexcept : site(inSite) {}
+			constexpr explicit traced_tag(error_site inSite) noexcept : site(inSite) {}
+		};
+
+		using in_place_tag = traced_tag<std::in_place_t>;
+
+		struct error_trace_ring {
+			error_origin records[DP_EXPECTED_TRACE_CAPACITY];
+			std::size_t next;
+		};
+
+		inline error_trace_ring& error_trace_buffer() noexcept {
+			thread_local error_trace_ring ring{};
+			return ring;
+		}
+
+		inline void record_error_origin(const error_site& inSite, const std::type_info* inType) noexcept {
+			if (!inSite.file) return;
+			error_trace_ring& ring = error_trace_buffer();
+			ring.records[ring.next % DP_EXPECTED_TRACE_CAPACITY] = error_origin{ inSite.file, inSite.line, inType };
+			++ring.next;
+		}
+	}
+
+	//Copies up to inMax of this thread's most recent error origins into out, newest first, and returns how many were copied
+	inline std::size_t recent_error_origins(error_origin* out, std::size_t inMax) noexcept {
+		const detail::error_trace_ring& ring = detail::error_trace_buffer();
+		const std::size_t held = ring.next < DP_EXPECTED_TRACE_CAPACITY ? ring.next : DP_EXPECTED_TRACE_CAPACITY;
+		const std::size_t count = inMax < held ? inMax : held;
+		for (std::size_t i = 0; i < count; ++i) out[i] = ring.records[(ring.next - 1 - i) % DP_EXPECTED_TRACE_CAPACITY];
+		return count;
+	}
+
+	inline void dump_error_origins(std::FILE* out = stderr) {
+		error_origin origins[DP_EXPECTED_TRACE_CAPACITY];
+		const std::size_t count = recent_error_origins(origins, DP_EXPECTED_TRACE_CAPACITY);
+		std::fprintf(out, "Most recent dp::expected error origins on this thread, newest first:\n");
+		for (std::size_t i = 0; i < count; ++i) {
+			std::fprintf(out, "  %s:%u  %s\n", origins[i].file, origins[i].line, origins[i].type ? origins[i].type->name() : "(no RTTI)");
+		}
+	}
+
+	inline void clear_error_origins() noexcept {
+		detail::error_trace_buffer().next = 0;
+	}
+
+//Constant evaluation can't record anything, so only record at runtime
+#define DP_EXPECTED_TRACE_ORIGIN(ErrType, Site) do { if (!__builtin_is_constant_evaluated()) ::dp::detail::record_error_origin(Site, DP_EXPECTED_TRACE_TYPE(ErrType)); } while (false)
+//The trailing parameter through which functions which create an error take their caller's location, and the argument which passes it on
+#define DP_EXPECTED_TRACE_SITE_PARAM , ::dp::detail::error_site inSite = ::dp::detail::error_site::current()
+#define DP_EXPECTED_TRACE_SITE_ARG , inSite
+//Opens and closes the inline namespace which holds everything tracing changes
+#define DP_EXPECTED_TRACE_NAMESPACE_BEGIN inline namespace expected_traced {
+#define DP_EXPECTED_TRACE_NAMESPACE_END }
+#else
+	namespace detail {
+		using in_place_tag = std::in_place_t;
+	}
+
+#define DP_EXPECTED_TRACE_ORIGIN(ErrType, Site)
+#define DP_EXPECTED_TRACE_SITE_PARAM
+#define DP_EXPECTED_TRACE_SITE_ARG
+#define DP_EXPECTED_TRACE_NAMESPACE_BEGIN
+#define DP_EXPECTED_TRACE_NAMESPACE_END
+#endif
+
 	template<typename T>
 	class bad_expected_access;
 
@@ -52,6 +174,8 @@ namespace dp {
 	bad_expected_access(T) -> bad_expected_access<T>;
 
 
+	DP_EXPECTED_TRACE_NAMESPACE_BEGIN
+
 	template<typename Err>
 	class unexpected {
 		Err m_error;
@@ -60,14 +184,22 @@ namespace dp {
 		constexpr unexpected(const unexpected&) = default;
 		constexpr unexpected(unexpected&&) = default;
 
-		template<typename E = Err>
-		constexpr explicit unexpected(E&& in) : m_error{ std::forward<E>(in) } {}
+		//Not for std::in_place, which the traced site parameter would otherwise let this take in preference to the in_place constructors
+		template<typename E = Err, std::enable_if_t<!std::is_same_v<std::remove_cv_t<std::remove_reference_t<E>>, unexpected>
+			&& !std::is_same_v<std::remove_cv_t<std::remove_reference_t<E>>, std::in_place_t> && std::is_constructible_v<Err, E>, bool> = true>
+		constexpr explicit unexpected(E&& in DP_EXPECTED_TRACE_SITE_PARAM) : m_error{ std::forward<E>(in) } {
+			DP_EXPECTED_TRACE_ORIGIN(Err, inSite);
+		}
 
 		template<typename... Args, std::enable_if_t<std::is_constructible_v<Err, Args...>, bool> = true>
-		constexpr explicit unexpected(std::in_place_t, Args&&... args) : m_error{ std::forward<Args...>(args...) } {}
+		constexpr explicit unexpected([[maybe_unused]] detail::in_place_tag inTag, Args&&... args) : m_error{ std::forward<Args>(args)... } {
+			DP_EXPECTED_TRACE_ORIGIN(Err, inTag.site);
+		}
 
 		template<typename U, typename... Args, std::enable_if_t<std::is_constructible_v<Err, std::initializer_list<U>, Args...>, bool> = true>
-		constexpr explicit unexpected(std::in_place_t, std::initializer_list<U>& inList, Args&&... args) : m_error{ inList, std::forward<Args...>(args...) } {}
+		constexpr explicit unexpected([[maybe_unused]] detail::in_place_tag inTag, std::initializer_list<U>& inList, Args&&... args) : m_error{ inList, std::forward<Args>(args)... } {
+			DP_EXPECTED_TRACE_ORIGIN(Err, inTag.site);
+		}
 
 		constexpr Err& error() & noexcept {
 			return m_error;
@@ -106,10 +238,12 @@ namespace dp {
 	//Layover from the days of C++98 where we didn't have CTAD or mandatory prvalue elision
 	template<typename Err>
 	[[deprecated("dp::unex is deprecated. Use dp::unexpected(error) instead")]]
-	constexpr dp::unexpected<Err> unex(Err&& in) {
-		return dp::unexpected(std::forward<Err>(in));
+	constexpr dp::unexpected<Err> unex(Err&& in DP_EXPECTED_TRACE_SITE_PARAM) {
+		return dp::unexpected<Err>(std::forward<Err>(in) DP_EXPECTED_TRACE_SITE_ARG);
 	}
 
+	DP_EXPECTED_TRACE_NAMESPACE_END
+
 
 	struct unexpect_t {
 		explicit unexpect_t() = default;
@@ -117,6 +251,24 @@ namespace dp {
 
 	constexpr inline unexpect_t unexpect{};
 
+	namespace detail {
+		DP_EXPECTED_TRACE_NAMESPACE_BEGIN
+		//The tag which the unexpect_t constructors take, and the one the library uses to pass on an error which already exists
+#ifdef DP_EXPECTED_TRACE
+		using unexpect_tag = traced_tag<dp::unexpect_t>;
+		constexpr inline unexpect_tag unexpect_untraced{ error_site{ nullptr, 0 } };
+#else
+		using unexpect_tag = dp::unexpect_t;
+		constexpr inline unexpect_tag unexpect_untraced{};
+#endif
+		DP_EXPECTED_TRACE_NAMESPACE_END
+	}
+
+	DP_EXPECTED_TRACE_NAMESPACE_BEGIN
+	template<typename T, typename E>
+	class expected;
+	DP_EXPECTED_TRACE_NAMESPACE_END
+
 	namespace detail {
 		template<typename T>
 		static constexpr inline bool is_special_of_unexpected = false;
@@ -124,13 +276,109 @@ namespace dp {
 		template<typename T>
 		static constexpr inline bool is_special_of_unexpected<dp::unexpected<T>> = true;
 
+		template<typename T>
+		static constexpr inline bool is_special_of_expected = false;
+
+		template<typename T, typename E>
+		static constexpr inline bool is_special_of_expected<dp::expected<T, E>> = true;
+
 		template<typename T>
 		using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
+		//Tag for the constructor which cpp20/expected_coroutine.h uses to build a coroutine's result in place
+		struct coroutine_result_t {
+			explicit coroutine_result_t() = default;
+		};
+
+		//std::invoke isn't constexpr until C++20, so we only defer to it when we actually need pointer-to-member handling
+		template<typename F, typename... Args>
+		constexpr decltype(auto) invoke(F&& func, Args&&... args) {
+			if constexpr (std::is_member_pointer_v<std::decay_t<F>>) {
+				return std::invoke(std::forward<F>(func), std::forward<Args>(args)...);
+			}
+			else {
+				return std::forward<F>(func)(std::forward<Args>(args)...);
+			}
+		}
+
+		//Calls func with the held value of exp, or with no arguments if exp holds void
+		template<typename Exp, typename F>
+		constexpr decltype(auto) invoke_with_value(Exp&& exp, F&& func) {
+			if constexpr (std::is_void_v<typename remove_cvref_t<Exp>::value_type>) {
+				return detail::invoke(std::forward<F>(func));
+			}
+			else {
+				return detail::invoke(std::forward<F>(func), *std::forward<Exp>(exp));
+			}
+		}
+
+		/*
+		*  The monadic operations are written once against a forwarded expected, so every value category of both the primary
+		*  template and the void specialisation shares one implementation and rvalues move their payload along the chain.
+		*/
+		template<typename Exp, typename F>
+		constexpr auto expected_and_then(Exp&& exp, F&& func) {
+			using exp_type = remove_cvref_t<Exp>;
+			using result_type = remove_cvref_t<decltype(detail::invoke_with_value(std::forward<Exp>(exp), std::forward<F>(func)))>;
+			static_assert(is_special_of_expected<result_type>, "and_then must be given a function which returns a dp::expected");
+			static_assert(std::is_same_v<typename result_type::error_type, typename exp_type::error_type>, "and_then must not change the error type");
+
+			if (exp.has_value()) return result_type(detail::invoke_with_value(std::forward<Exp>(exp), std::forward<F>(func)));
+			return result_type(detail::unexpect_untraced, std::forward<Exp>(exp).error());
+		}
+
+		template<typename Exp, typename F>
+		constexpr auto expected_transform(Exp&& exp, F&& func) {
+			using exp_type = remove_cvref_t<Exp>;
+			using value_type = std::remove_cv_t<decltype(detail::invoke_with_value(std::forward<Exp>(exp), std::forward<F>(func)))>;
+			using result_type = dp::expected<value_type, typename exp_type::error_type>;
+
+			if (!exp.has_value()) return result_type(detail::unexpect_untraced, std::forward<Exp>(exp).error());
+			if constexpr (std::is_void_v<value_type>) {
+				detail::invoke_with_value(std::forward<Exp>(exp), std::forward<F>(func));
+				return result_type();
+			}
+			else {
+				return result_type(std::in_place, detail::invoke_with_value(std::forward<Exp>(exp), std::forward<F>(func)));
+			}
+		}
+
+		template<typename Exp, typename F>
+		constexpr auto expected_or_else(Exp&& exp, F&& func) {
+			using exp_type = remove_cvref_t<Exp>;
+			using result_type = remove_cvref_t<decltype(detail::invoke(std::forward<F>(func), std::forward<Exp>(exp).error()))>;
+			static_assert(is_special_of_expected<result_type>, "or_else must be given a function which returns a dp::expected");
+			static_assert(std::is_same_v<typename result_type::value_type, typename exp_type::value_type>, "or_else must not change the value type");
+
+			if (!exp.has_value()) return result_type(detail::invoke(std::forward<F>(func), std::forward<Exp>(exp).error()));
+			if constexpr (std::is_void_v<typename exp_type::value_type>) {
+				return result_type();
+			}
+			else {
+				return result_type(std::in_place, *std::forward<Exp>(exp));
+			}
+		}
+
+		template<typename Exp, typename F>
+		constexpr auto expected_transform_error(Exp&& exp, F&& func) {
+			using exp_type = remove_cvref_t<Exp>;
+			using error_type = std::remove_cv_t<decltype(detail::invoke(std::forward<F>(func), std::forward<Exp>(exp).error()))>;
+			using result_type = dp::expected<typename exp_type::value_type, error_type>;
+
+			if (!exp.has_value()) return result_type(detail::unexpect_untraced, detail::invoke(std::forward<F>(func), std::forward<Exp>(exp).error()));
+			if constexpr (std::is_void_v<typename exp_type::value_type>) {
+				return result_type();
+			}
+			else {
+				return result_type(std::in_place, *std::forward<Exp>(exp));
+			}
+		}
 	}
 
 
 
 
+	DP_EXPECTED_TRACE_NAMESPACE_BEGIN
 
 	template<typename T, typename E>
 	class expected {
@@ -144,6 +392,14 @@ namespace dp {
 		using data_type = std::variant<T, E>;
 		data_type m_data;
 
+		//The placeholder is always overwritten before the coroutine returns, but the variant still needs some alternative to start in.
+		//Only instantiated on compilers which convert a coroutine's return object before its body runs.
+		static data_type coroutine_placeholder() {
+			static_assert(std::is_default_constructible_v<T> || std::is_default_constructible_v<E>, "On this compiler, an expected returned from a coroutine needs a default constructible value or error type");
+			if constexpr (std::is_default_constructible_v<T>) return data_type{ std::in_place_index<0> };
+			else return data_type{ std::in_place_index<1> };
+		}
+
 	public:
 
 		using value_type = T;
@@ -177,10 +433,20 @@ namespace dp {
 		constexpr expected(std::in_place_t, std::initializer_list<U> inList, Args&&... args) : m_data{ std::in_place_index<0>, inList, std::forward<Args...>(args...) } {}
 
 		template<typename... Args, std::enable_if_t<std::is_constructible_v<E, Args...>, bool> = true>
-		constexpr expected(dp::unexpect_t, Args&&... args) : m_data{ std::in_place_index<1>, std::forward<Args...>(args...) } {}
+		constexpr expected([[maybe_unused]] detail::unexpect_tag inTag, Args&&... args) : m_data{ std::in_place_index<1>, std::forward<Args...>(args...) } {
+			DP_EXPECTED_TRACE_ORIGIN(E, inTag.site);
+		}
 
 		template<typename U, typename... Args, std::enable_if_t<std::is_constructible_v<E, std::initializer_list<U>&, Args...>, bool> = true>
-		constexpr expected(dp::unexpect_t, std::initializer_list<U> inList, Args&&... args) : m_data{ std::in_place_index<1>, inList, std::forward<Args...>(args...) } {}
+		constexpr expected([[maybe_unused]] detail::unexpect_tag inTag, std::initializer_list<U> inList, Args&&... args) : m_data{ std::in_place_index<1>, inList, std::forward<Args...>(args...) } {
+			DP_EXPECTED_TRACE_ORIGIN(E, inTag.site);
+		}
+
+		//Builds a placeholder directly in a coroutine's return slot and tells the promise where it lives, so the body can write its result there
+		template<typename Promise>
+		expected(detail::coroutine_result_t, Promise& promise) : m_data{ coroutine_placeholder() } {
+			promise.set_result_address(this);
+		}
 
 		//No constexpr destructors until C++20. Big sad.
 		~expected() = default;
@@ -315,6 +581,77 @@ namespace dp {
 			return static_cast<bool>(*this) ? std::move(**this) : static_cast<T>(std::forward<U>(in));
 		}
 
+		/*
+		*  Monadic operations. Each forwards the value category of *this so a chain of rvalues moves its payload rather than copying it.
+		*/
+		template<typename F>
+		constexpr auto and_then(F&& func)& {
+			return detail::expected_and_then(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto and_then(F&& func) const& {
+			return detail::expected_and_then(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto and_then(F&& func)&& {
+			return detail::expected_and_then(std::move(*this), std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto and_then(F&& func) const&& {
+			return detail::expected_and_then(std::move(*this), std::forward<F>(func));
+		}
+
+		template<typename F>
+		constexpr auto transform(F&& func)& {
+			return detail::expected_transform(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform(F&& func) const& {
+			return detail::expected_transform(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform(F&& func)&& {
+			return detail::expected_transform(std::move(*this), std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform(F&& func) const&& {
+			return detail::expected_transform(std::move(*this), std::forward<F>(func));
+		}
+
+		template<typename F>
+		constexpr auto or_else(F&& func)& {
+			return detail::expected_or_else(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto or_else(F&& func) const& {
+			return detail::expected_or_else(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto or_else(F&& func)&& {
+			return detail::expected_or_else(std::move(*this), std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto or_else(F&& func) const&& {
+			return detail::expected_or_else(std::move(*this), std::forward<F>(func));
+		}
+
+		template<typename F>
+		constexpr auto transform_error(F&& func)& {
+			return detail::expected_transform_error(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform_error(F&& func) const& {
+			return detail::expected_transform_error(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform_error(F&& func)&& {
+			return detail::expected_transform_error(std::move(*this), std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform_error(F&& func) const&& {
+			return detail::expected_transform_error(std::move(*this), std::forward<F>(func));
+		}
+
 		template<typename... Args>
 		constexpr T& emplace(Args&&... args) noexcept {
 			return m_data.emplace(std::forward<Args...>(args...));
@@ -370,10 +707,19 @@ namespace dp {
 		constexpr expected(std::in_place_t) noexcept {}
 
 		template<typename... Args, std::enable_if_t<std::is_constructible_v<E, Args...>, bool> = true>
-		constexpr expected(dp::unexpect_t, Args&&... args) : m_data{ std::in_place_index<1>, std::forward<Args...>(args...) } {}
+		constexpr expected([[maybe_unused]] detail::unexpect_tag inTag, Args&&... args) : m_data{ std::in_place_index<1>, std::forward<Args...>(args...) } {
+			DP_EXPECTED_TRACE_ORIGIN(E, inTag.site);
+		}
 
 		template<typename U, typename... Args, std::enable_if_t<std::is_constructible_v<E, std::initializer_list<U>&, Args...>, bool> = true>
-		constexpr expected(dp::unexpect_t, std::initializer_list<U> inList, Args&&... args) : m_data{ std::in_place_index<1>, inList, std::forward<Args...>(args...) } {}
+		constexpr expected([[maybe_unused]] detail::unexpect_tag inTag, std::initializer_list<U> inList, Args&&... args) : m_data{ std::in_place_index<1>, inList, std::forward<Args...>(args...) } {
+			DP_EXPECTED_TRACE_ORIGIN(E, inTag.site);
+		}
+
+		template<typename Promise>
+		expected(detail::coroutine_result_t, Promise& promise) {
+			promise.set_result_address(this);
+		}
 
 		~expected() noexcept = default;
 
@@ -440,6 +786,74 @@ namespace dp {
 			return std::move(std::get<1>(m_data));
 		}
 
+		template<typename F>
+		constexpr auto and_then(F&& func)& {
+			return detail::expected_and_then(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto and_then(F&& func) const& {
+			return detail::expected_and_then(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto and_then(F&& func)&& {
+			return detail::expected_and_then(std::move(*this), std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto and_then(F&& func) const&& {
+			return detail::expected_and_then(std::move(*this), std::forward<F>(func));
+		}
+
+		template<typename F>
+		constexpr auto transform(F&& func)& {
+			return detail::expected_transform(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform(F&& func) const& {
+			return detail::expected_transform(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform(F&& func)&& {
+			return detail::expected_transform(std::move(*this), std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform(F&& func) const&& {
+			return detail::expected_transform(std::move(*this), std::forward<F>(func));
+		}
+
+		template<typename F>
+		constexpr auto or_else(F&& func)& {
+			return detail::expected_or_else(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto or_else(F&& func) const& {
+			return detail::expected_or_else(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto or_else(F&& func)&& {
+			return detail::expected_or_else(std::move(*this), std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto or_else(F&& func) const&& {
+			return detail::expected_or_else(std::move(*this), std::forward<F>(func));
+		}
+
+		template<typename F>
+		constexpr auto transform_error(F&& func)& {
+			return detail::expected_transform_error(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform_error(F&& func) const& {
+			return detail::expected_transform_error(*this, std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform_error(F&& func)&& {
+			return detail::expected_transform_error(std::move(*this), std::forward<F>(func));
+		}
+		template<typename F>
+		constexpr auto transform_error(F&& func) const&& {
+			return detail::expected_transform_error(std::move(*this), std::forward<F>(func));
+		}
+
 		constexpr void emplace() noexcept {
 			m_data = std::monostate{};
 		}
@@ -461,6 +875,8 @@ namespace dp {
 		lhs.swap(rhs);
 	}
 
+	DP_EXPECTED_TRACE_NAMESPACE_END
+
 
 
 
@@ -0,0 +1,172 @@
+#ifndef DP_CPP17_EXPECTED_ALGORITHM
+#define DP_CPP17_EXPECTED_ALGORITHM
+
+#include "cpp17/expected.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+*	Algorithms for mapping a function which returns dp::expected over a range, giving either every result or the first error.
+*	"First" always means first in input order, so the sequential and parallel versions agree on which error is reported.
+*/
+namespace dp {
+
+	namespace detail {
+		template<typename F, typename Arg>
+		using collect_result_t = remove_cvref_t<decltype(detail::invoke(std::declval<F&>(), std::declval<Arg>()))>;
+
+		template<typename F, typename Arg>
+		struct collect_traits {
+			using result_type = collect_result_t<F, Arg>;
+			static_assert(is_special_of_expected<result_type>, "collect must be given a function which returns a dp::expected");
+
+			using value_type = typename result_type::value_type;
+			using error_type = typename result_type::error_type;
+			static_assert(!std::is_void_v<value_type>, "collect cannot gather the results of an expected<void, E>");
+
+			using return_type = dp::expected<std::vector<value_type>, error_type>;
+		};
+	}
+
+	template<typename InputIt, typename F>
+	auto collect(InputIt first, InputIt last, F&& func) {
+		using traits = detail::collect_traits<F, decltype(*first)>;
+		using return_type = typename traits::return_type;
+
+		std::vector<typename traits::value_type> values;
+		if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+			values.reserve(static_cast<std::size_t>(std::distance(first, last)));
+		}
+
+		for (; first != last; ++first) {
+			auto result = detail::invoke(func, *first);
+			if (!result.has_value()) return return_type(dp::detail::unexpect_untraced, std::move(result).error());
+			values.push_back(std::move(*result));
+		}
+		return return_type(std::in_place, std::move(values));
+	}
+
+	template<typename Range, typename F>
+	auto collect(Range&& range, F&& func) {
+		using std::begin;
+		using std::end;
+		return dp::collect(begin(range), end(range), std::forward<F>(func));
+	}
+
+
+	//The fewest elements parallel_collect gives each thread by default. Starting and joining a thread costs tens of microseconds, so
+	//splitting a range much finer than this costs more than it saves unless func is expensive.
+	inline constexpr std::size_t parallel_collect_min_chunk = 1024;
+
+	/*
+	*  Splits the range into one contiguous chunk per thread. Once any element fails, workers stop as soon as they pass the lowest
+	*  failing index seen so far, as nothing after it can affect the result. The element which fails first in input order is always
+	*  evaluated, so the reported error is the same one collect() would report. An exception thrown by func is treated as a failure
+	*  at that index and rethrown on the calling thread.
+	*  func is invoked concurrently and must be safe to call from several threads at once.
+	*  Threads are started for each call and joined before it returns. Each is given at least minChunk elements, so fewer threads are
+	*  used for a short range, and one with fewer than twice minChunk elements is collected on the calling thread without starting any.
+	*/
+	template<typename RandomIt, typename F>
+	auto parallel_collect(RandomIt first, RandomIt last, F&& func, std::size_t threadCount = std::thread::hardware_concurrency(), std::size_t minChunk = parallel_collect_min_chunk) {
+		static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<RandomIt>::iterator_category>, "parallel_collect requires random access iterators");
+		using traits = detail::collect_traits<F, decltype(*first)>;
+		using value_type = typename traits::value_type;
+		using error_type = typename traits::error_type;
+		using return_type = typename traits::return_type;
+
+		const std::size_t count = static_cast<std::size_t>(last - first);
+		threadCount = std::min(threadCount, count / std::max<std::size_t>(minChunk, 1));
+		if (threadCount <= 1) return dp::collect(first, last, func);
+
+		struct chunk {
+			std::size_t begin;
+			std::size_t end;
+			std::vector<value_type> values;
+			std::optional<error_type> error;
+			std::exception_ptr exception;
+		};
+
+		std::vector<chunk> chunks(threadCount);
+		std::atomic<std::size_t> firstFailure{ count };
+
+		auto record_failure = [&firstFailure](std::size_t index) {
+			std::size_t current = firstFailure.load(std::memory_order_relaxed);
+			while (index < current && !firstFailure.compare_exchange_weak(current, index, std::memory_order_relaxed)) {}
+		};
+
+		auto worker = [&](chunk& work) {
+			work.values.reserve(work.end - work.begin);
+			for (std::size_t i = work.begin; i < work.end; ++i) {
+				if (i > firstFailure.load(std::memory_order_relaxed)) return;
+				try {
+					auto result = detail::invoke(func, first[i]);
+					if (!result.has_value()) {
+						work.error.emplace(std::move(result).error());
+						record_failure(i);
+						return;
+					}
+					work.values.push_back(std::move(*result));
+				}
+				catch (...) {
+					work.exception = std::current_exception();
+					record_failure(i);
+					return;
+				}
+			}
+		};
+
+		for (std::size_t i = 0; i < threadCount; ++i) {
+			chunks[i].begin = i * count / threadCount;
+			chunks[i].end = (i + 1) * count / threadCount;
+		}
+
+		//The calling thread takes the last chunk itself
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount - 1);
+		try {
+			for (std::size_t i = 0; i + 1 < threadCount; ++i) {
+				threads.emplace_back(worker, std::ref(chunks[i]));
+			}
+		}
+		catch (...) {
+			firstFailure.store(0);
+			for (auto& thread : threads) thread.join();
+			throw;
+		}
+		worker(chunks.back());
+		for (auto& thread : threads) thread.join();
+
+		const std::size_t failure = firstFailure.load();
+		if (failure != count) {
+			chunk& failed = *std::find_if(chunks.begin(), chunks.end(), [failure](const chunk& c) { return failure < c.end; });
+			if (failed.exception) std::rethrow_exception(failed.exception);
+			return return_type(dp::detail::unexpect_untraced, std::move(*failed.error));
+		}
+
+		std::vector<value_type> values;
+		values.reserve(count);
+		for (auto& work : chunks) {
+			std::move(work.values.begin(), work.values.end(), std::back_inserter(values));
+		}
+		return return_type(std::in_place, std::move(values));
+	}
+
+	template<typename Range, typename F>
+	auto parallel_collect(Range&& range, F&& func, std::size_t threadCount = std::thread::hardware_concurrency(), std::size_t minChunk = parallel_collect_min_chunk) {
+		using std::begin;
+		using std::end;
+		return dp::parallel_collect(begin(range), end(range), std::forward<F>(func), threadCount, minChunk);
+	}
+
+}
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef DP_CPP17_EXPECTED_BATCH
+#define DP_CPP17_EXPECTED_BATCH
+
+#include "cpp17/expected.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/*
+*	A structure-of-arrays container for a batch of dp::expected results.
+*	Rather than a vector of variants, the batch keeps its values and its errors in two dense arrays, plus one bit per element saying
+*	which array it lives in. Alongside the bitmask we keep the number of values before each 64-bit word, so finding an element's slot
+*	is one lookup and one popcount.
+*	Counting, and visiting only the successes or only the failures, work a word at a time, so a batch with sparse errors skips whole
+*	words of successes when looking for them.
+*	Adding an element gives the strong guarantee: if it throws, the batch is left as it was.
+*/
+namespace dp {
+
+	namespace detail {
+		inline unsigned int popcount64(std::uint64_t in) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<unsigned int>(__builtin_popcountll(in));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			return static_cast<unsigned int>(__popcnt64(in));
+#else
+			in = in - ((in >> 1) & 0x5555555555555555ULL);
+			in = (in & 0x3333333333333333ULL) + ((in >> 2) & 0x3333333333333333ULL);
+			in = (in + (in >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+			return static_cast<unsigned int>((in * 0x0101010101010101ULL) >> 56);
+#endif
+		}
+
+		//The index of the lowest set bit. in must not be zero.
+		inline unsigned int lowest_bit64(std::uint64_t in) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<unsigned int>(__builtin_ctzll(in));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			unsigned long index;
+			_BitScanForward64(&index, in);
+			return static_cast<unsigned int>(index);
+#else
+			return popcount64((in & (0 - in)) - 1);
+#endif
+		}
+	}
+
+
+	template<typename T, typename E>
+	class expected_batch {
+		static_assert(!std::is_void_v<T>, "expected_batch cannot hold the results of an expected<void, E>");
+
+		static constexpr std::size_t word_bits = 64;
+
+		std::vector<T> m_values;
+		std::vector<E> m_errors;
+		std::vector<std::uint64_t> m_mask;
+		//The number of values in all words before each word
+		std::vector<std::size_t> m_rank;
+		std::size_t m_size = 0;
+
+		//Grows inVector geometrically if it is full, so that its next push_back cannot throw
+		template<typename U>
+		static void make_room_for_one(std::vector<U>& inVector) {
+			if (inVector.size() == inVector.capacity()) inVector.reserve(inVector.empty() ? 1 : inVector.size() * 2);
+		}
+
+		//Makes room for the next element's bit. Called before its value or error is stored, so that the arrays and the mask cannot
+		//fall out of step if an allocation fails.
+		void reserve_bit() {
+			if (m_size % word_bits != 0) return;
+			make_room_for_one(m_rank);
+			make_room_for_one(m_mask);
+		}
+
+		//Records whether the next element is a value, starting a new word when needed. reserve_bit must have been called first.
+		void push_bit(bool hasValue) noexcept {
+			const std::size_t bit = m_size % word_bits;
+			if (bit == 0) {
+				m_rank.push_back(m_mask.empty() ? 0 : m_rank.back() + detail::popcount64(m_mask.back()));
+				m_mask.push_back(0);
+			}
+			if (hasValue) m_mask.back() |= std::uint64_t{ 1 } << bit;
+			++m_size;
+		}
+
+		//The number of values before index
+		std::size_t rank(std::size_t index) const noexcept {
+			const std::size_t word = index / word_bits;
+			const std::uint64_t below = (std::uint64_t{ 1 } << (index % word_bits)) - 1;
+			return m_rank[word] + detail::popcount64(m_mask[word] & below);
+		}
+
+		//As rank, but also accepts one past the end
+		std::size_t values_before(std::size_t index) const noexcept {
+			return index == m_size ? m_values.size() : this->rank(index);
+		}
+
+		//The bits of a word which refer to real elements
+		std::uint64_t valid_bits(std::size_t word) const noexcept {
+			const std::size_t remaining = m_size - word * word_bits;
+			return remaining >= word_bits ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << remaining) - 1;
+		}
+
+	public:
+		using value_type = T;
+		using error_type = E;
+		using expected_type = dp::expected<T, E>;
+
+		expected_batch() = default;
+
+		template<typename InputIt>
+		expected_batch(InputIt first, InputIt last) {
+			if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+				this->reserve(static_cast<std::size_t>(std::distance(first, last)));
+			}
+			for (; first != last; ++first) this->push_back(*first);
+		}
+
+		//Reserves room for inCount elements, assuming they are mostly values
+		void reserve(std::size_t inCount) {
+			m_values.reserve(inCount);
+			m_mask.reserve((inCount + word_bits - 1) / word_bits);
+			m_rank.reserve((inCount + word_bits - 1) / word_bits);
+		}
+
+		void push_value(const T& in) {
+			this->reserve_bit();
+			m_values.push_back(in);
+			push_bit(true);
+		}
+		void push_value(T&& in) {
+			this->reserve_bit();
+			m_values.push_back(std::move(in));
+			push_bit(true);
+		}
+		void push_error(const E& in) {
+			this->reserve_bit();
+			m_errors.push_back(in);
+			push_bit(false);
+		}
+		void push_error(E&& in) {
+			this->reserve_bit();
+			m_errors.push_back(std::move(in));
+			push_bit(false);
+		}
+
+		void push_back(const expected_type& in) {
+			if (in.has_value()) push_value(*in);
+			else push_error(in.error());
+		}
+		void push_back(expected_type&& in) {
+			if (in.has_value()) push_value(std::move(*in));
+			else push_error(std::move(in).error());
+		}
+
+		std::size_t size() const noexcept {
+			return m_size;
+		}
+		bool empty() const noexcept {
+			return m_size == 0;
+		}
+
+		bool has_value(std::size_t index) const noexcept {
+			return (m_mask[index / word_bits] >> (index % word_bits)) & 1;
+		}
+
+		//Rebuilds the individual result at index
+		expected_type get(std::size_t index) const {
+			if (index >= m_size) throw std::out_of_range("Index out of range in expected_batch::get");
+			const std::size_t values = this->rank(index);
+			if (this->has_value(index)) return expected_type{ std::in_place, m_values[values] };
+			return expected_type{ dp::detail::unexpect_untraced, m_errors[index - values] };
+		}
+		expected_type operator[](std::size_t index) const {
+			return this->get(index);
+		}
+
+		std::size_t value_count() const noexcept {
+			return m_values.size();
+		}
+		std::size_t error_count() const noexcept {
+			return m_errors.size();
+		}
+
+		//The number of values in [first, last)
+		std::size_t count_values(std::size_t first, std::size_t last) const {
+			if (first > last || last > m_size) throw std::out_of_range("Invalid range in expected_batch::count_values");
+			return this->values_before(last) - this->values_before(first);
+		}
+		std::size_t count_errors(std::size_t first, std::size_t last) const {
+			return (last - first) - this->count_values(first, last);
+		}
+
+		//The dense arrays, in the order their elements appear in the batch
+		const std::vector<T>& values() const noexcept {
+			return m_values;
+		}
+		const std::vector<E>& errors() const noexcept {
+			return m_errors;
+		}
+
+		//Calls func(index, value) for every success, in order
+		template<typename F>
+		void for_each_value(F&& func) const {
+			std::size_t slot = 0;
+			for (std::size_t word = 0; word < m_mask.size(); ++word) {
+				std::uint64_t bits = m_mask[word];
+				while (bits) {
+					detail::invoke(func, word * word_bits + detail::lowest_bit64(bits), m_values[slot++]);
+					bits &= bits - 1;
+				}
+			}
+		}
+
+		//Calls func(index, error) for every failure, in order
+		template<typename F>
+		void for_each_error(F&& func) const {
+			std::size_t slot = 0;
+			for (std::size_t word = 0; word < m_mask.size() && slot < m_errors.size(); ++word) {
+				std::uint64_t bits = ~m_mask[word] & this->valid_bits(word);
+				while (bits) {
+					detail::invoke(func, word * word_bits + detail::lowest_bit64(bits), m_errors[slot++]);
+					bits &= bits - 1;
+				}
+			}
+		}
+
+		std::vector<expected_type> to_vector() const {
+			std::vector<expected_type> result;
+			result.reserve(m_size);
+			std::size_t valueSlot = 0;
+			std::size_t errorSlot = 0;
+			for (std::size_t i = 0; i < m_size; ++i) {
+				if (this->has_value(i)) result.emplace_back(std::in_place, m_values[valueSlot++]);
+				else result.emplace_back(dp::detail::unexpect_untraced, m_errors[errorSlot++]);
+			}
+			return result;
+		}
+
+		void clear() noexcept {
+			m_values.clear();
+			m_errors.clear();
+			m_mask.clear();
+			m_rank.clear();
+			m_size = 0;
+		}
+
+		void swap(expected_batch& other) noexcept {
+			using std::swap;
+			swap(m_values, other.m_values);
+			swap(m_errors, other.m_errors);
+			swap(m_mask, other.m_mask);
+			swap(m_rank, other.m_rank);
+			swap(m_size, other.m_size);
+		}
+	};
+
+	template<typename T, typename E>
+	void swap(expected_batch<T, E>& lhs, expected_batch<T, E>& rhs) noexcept {
+		lhs.swap(rhs);
+	}
+
+}
+
+#endif
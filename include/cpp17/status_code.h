@@ -0,0 +1,176 @@
+#ifndef DP_CPP17_STATUS_CODE
+#define DP_CPP17_STATUS_CODE
+
+#include "cpp17/expected.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+
+/*
+*	A compact status code, intended as a cheap error type for dp::expected
+*	A status_code is 8 bytes: a 32-bit index naming a registered domain and a 32-bit code. It never allocates, copying it is trivial,
+*	and comparisons are integer comparisons. Human-readable messages are only looked up from the domain when asked for.
+*
+*	Each domain takes the next slot of a fixed-size process-wide table when it is constructed, and gives it up when it is destroyed.
+*	The table holds DP_STATUS_DOMAIN_CAPACITY domains, 256 unless defined otherwise before this header is included; constructing a
+*	domain once the table is full calls std::terminate. Slots are never reused, so a code from a destroyed domain reports no domain.
+*/
+
+#ifndef DP_STATUS_DOMAIN_CAPACITY
+#define DP_STATUS_DOMAIN_CAPACITY 256
+#endif
+
+namespace dp {
+
+	class status_domain;
+
+	namespace detail {
+		struct status_domain_table {
+			std::atomic<const status_domain*> slots[DP_STATUS_DOMAIN_CAPACITY];
+			std::atomic<std::uint32_t> used;
+		};
+
+		inline status_domain_table& status_domains() noexcept {
+			static status_domain_table table{};
+			return table;
+		}
+
+		//Claims the next slot for inDomain and returns its index. Index 0 is reserved to mean no domain.
+		inline std::uint32_t register_status_domain(const status_domain* inDomain) noexcept {
+			status_domain_table& table = status_domains();
+			const std::uint32_t slot = table.used.fetch_add(1, std::memory_order_relaxed);
+			if (slot >= DP_STATUS_DOMAIN_CAPACITY) std::terminate();
+			table.slots[slot].store(inDomain, std::memory_order_release);
+			return slot + 1;
+		}
+
+		inline const status_domain* find_status_domain(std::uint32_t inIndex) noexcept {
+			if (inIndex == 0 || inIndex > DP_STATUS_DOMAIN_CAPACITY) return nullptr;
+			return status_domains().slots[inIndex - 1].load(std::memory_order_acquire);
+		}
+	}
+
+	/*
+	*  A status domain gives meaning to a set of codes. Domains are expected to be static objects which outlive every status_code
+	*  which refers to them; a domain's identity is the table index it was given on construction.
+	*/
+	class status_domain {
+		std::uint32_t m_index;
+
+	public:
+		status_domain() noexcept : m_index{ detail::register_status_domain(this) } {}
+		status_domain(const status_domain&) = delete;
+		status_domain& operator=(const status_domain&) = delete;
+
+		virtual const char* name() const noexcept = 0;
+		virtual const char* message(int code) const noexcept = 0;
+
+		std::uint32_t index() const noexcept {
+			return m_index;
+		}
+
+	protected:
+		virtual ~status_domain() {
+			detail::status_domains().slots[m_index - 1].store(nullptr, std::memory_order_release);
+		}
+	};
+
+	//A domain whose messages are a static table indexed by code
+	class table_status_domain : public status_domain {
+		const char* m_name;
+		const char* const* m_messages;
+		std::size_t m_count;
+
+	public:
+		template<std::size_t N>
+		table_status_domain(const char* name, const char* const (&messages)[N]) noexcept : m_name{ name }, m_messages{ messages }, m_count{ N } {}
+
+		const char* name() const noexcept override {
+			return m_name;
+		}
+		const char* message(int code) const noexcept override {
+			return (code >= 0 && static_cast<std::size_t>(code) < m_count) ? m_messages[code] : "Unknown status code";
+		}
+	};
+
+
+	class status_code {
+		std::uint32_t m_domain;
+		std::int32_t m_code;
+
+	public:
+		constexpr status_code() noexcept : m_domain{ 0 }, m_code{ 0 } {}
+		status_code(const status_domain& inDomain, int inCode) noexcept : m_domain{ inDomain.index() }, m_code{ inCode } {}
+
+		constexpr int code() const noexcept {
+			return m_code;
+		}
+		//The domain of this code, or nullptr if it has none
+		const status_domain* domain() const noexcept {
+			return detail::find_status_domain(m_domain);
+		}
+		constexpr std::uint32_t domain_index() const noexcept {
+			return m_domain;
+		}
+		bool in_domain(const status_domain& inDomain) const noexcept {
+			return m_domain == inDomain.index();
+		}
+
+		const char* domain_name() const noexcept {
+			const status_domain* domain = this->domain();
+			return domain ? domain->name() : "No domain";
+		}
+		const char* message() const noexcept {
+			const status_domain* domain = this->domain();
+			return domain ? domain->message(m_code) : "Unknown status code";
+		}
+	};
+
+	static_assert(sizeof(status_code) == 8, "status_code must stay 8 bytes");
+	//Keep the error alternative of an expected trivial, so expected<T, status_code> is trivially copyable whenever T is
+	static_assert(std::is_trivially_copyable_v<status_code>, "status_code must remain trivially copyable");
+
+	constexpr bool operator==(const dp::status_code& lhs, const dp::status_code& rhs) noexcept {
+		return lhs.domain_index() == rhs.domain_index() && lhs.code() == rhs.code();
+	}
+	constexpr bool operator!=(const dp::status_code& lhs, const dp::status_code& rhs) noexcept {
+		return !(lhs == rhs);
+	}
+
+
+	//Unlike the general case, a status_code can give a meaningful what() without needing to store a string
+	template<>
+	class bad_expected_access<dp::status_code> : public bad_expected_access<void> {
+		dp::status_code m_error;
+
+	public:
+		explicit bad_expected_access(dp::status_code e) noexcept : m_error{ e } {}
+
+		const char* what() const noexcept override {
+			return m_error.message();
+		}
+
+		dp::status_code& error() & noexcept {
+			return m_error;
+		}
+		const dp::status_code& error() const& noexcept {
+			return m_error;
+		}
+		dp::status_code&& error() && noexcept {
+			return std::move(m_error);
+		}
+		const dp::status_code&& error() const&& noexcept {
+			return std::move(m_error);
+		}
+	};
+
+	inline dp::unexpected<dp::status_code> make_unexpected(const dp::status_domain& inDomain, int inCode DP_EXPECTED_TRACE_SITE_PARAM) noexcept {
+		return dp::unexpected<dp::status_code>(dp::status_code{ inDomain, inCode } DP_EXPECTED_TRACE_SITE_ARG);
+	}
+
+}
+
+#endif
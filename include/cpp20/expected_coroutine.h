@@ -0,0 +1,280 @@
+#ifndef DP_CPP20_EXPECTED_COROUTINE
+#define DP_CPP20_EXPECTED_COROUTINE
+
+#include "cpp17/expected.h"
+
+#if !defined(__cpp_impl_coroutine)
+#error "dp::expected coroutine support requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/*
+*	Allows dp::expected<T, E> to be used as the return type of a coroutine.
+*	Inside such a coroutine, co_await on a dp::expected unwraps the value, or returns its error from the coroutine immediately.
+*	co_await dp::unexpected(e) returns an error directly, which is the only way to fail an expected<void, E> coroutine.
+*
+*	These coroutines never suspend, so their frames have strictly nested lifetimes. If the first parameter of the coroutine
+*	is a dp::coroutine_frame_buffer&, the frame is taken from that buffer and nothing touches the heap.
+*/
+namespace dp {
+
+	//A caller-supplied stack of memory for coroutine frames. Frames are released in the reverse order to which they were taken.
+	class coroutine_frame_buffer {
+		unsigned char* m_begin;
+		std::size_t m_size;
+		std::size_t m_used;
+
+	public:
+		coroutine_frame_buffer(void* inStorage, std::size_t inSize) noexcept : m_begin{ static_cast<unsigned char*>(inStorage) }, m_size{ inSize }, m_used{ 0 } {}
+
+		template<std::size_t N>
+		explicit coroutine_frame_buffer(unsigned char(&inStorage)[N]) noexcept : coroutine_frame_buffer(inStorage, N) {}
+
+		coroutine_frame_buffer(const coroutine_frame_buffer&) = delete;
+		coroutine_frame_buffer& operator=(const coroutine_frame_buffer&) = delete;
+
+		void* allocate(std::size_t size) {
+			constexpr std::size_t align = alignof(std::max_align_t);
+			const std::size_t address = reinterpret_cast<std::size_t>(m_begin + m_used);
+			const std::size_t padding = (align - address % align) % align;
+			if (padding + size > m_size - m_used) throw std::bad_alloc{};
+			void* result = m_begin + m_used + padding;
+			m_used += padding + size;
+			return result;
+		}
+
+		//Returns the buffer to the state it was in when used() returned inUsed
+		void release(std::size_t inUsed) noexcept {
+			m_used = inUsed;
+		}
+
+		std::size_t used() const noexcept {
+			return m_used;
+		}
+		std::size_t capacity() const noexcept {
+			return m_size;
+		}
+	};
+
+
+	namespace detail {
+
+		//Every buffered frame is prefixed with where it came from, as operator delete cannot be given the buffer
+		struct coroutine_frame_header {
+			dp::coroutine_frame_buffer* buffer;
+			std::size_t previous_used;
+		};
+		constexpr std::size_t coroutine_header_size = (sizeof(coroutine_frame_header) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+		template<typename T, typename E>
+		class expected_promise_base;
+
+		/*
+		*  The object returned by get_return_object. It is converted to the coroutine's return type after the body has run, by which
+		*  time the result is waiting in m_result; GCC, Clang 17 and later do this. Older Clang and MSVC convert it before the body
+		*  runs, so for those DP_EXPECTED_COROUTINE_EAGER_RETURN builds the expected directly in the caller's return slot and the
+		*  promise writes into it there. In that case either T or E must be default constructible to give the slot a starting value.
+		*/
+#ifndef DP_EXPECTED_COROUTINE_EAGER_RETURN
+#if defined(_MSC_VER) && !defined(__clang__) || defined(__clang__) && __clang_major__ < 17
+#define DP_EXPECTED_COROUTINE_EAGER_RETURN 1
+#else
+#define DP_EXPECTED_COROUTINE_EAGER_RETURN 0
+#endif
+#endif
+		template<typename T, typename E>
+		class expected_return_object {
+#if DP_EXPECTED_COROUTINE_EAGER_RETURN
+			expected_promise_base<T, E>* m_promise;
+#endif
+			std::optional<dp::expected<T, E>> m_result;
+
+			friend class expected_promise_base<T, E>;
+
+		public:
+			explicit expected_return_object(expected_promise_base<T, E>& inPromise) noexcept
+#if DP_EXPECTED_COROUTINE_EAGER_RETURN
+				: m_promise{ &inPromise }
+#endif
+			{
+				inPromise.m_return = this;
+			}
+			expected_return_object(const expected_return_object&) = delete;
+			expected_return_object& operator=(const expected_return_object&) = delete;
+
+			operator dp::expected<T, E>() {
+#if DP_EXPECTED_COROUTINE_EAGER_RETURN
+				if (!m_result) return dp::expected<T, E>(detail::coroutine_result_t{}, *m_promise);
+#endif
+				return std::move(*m_result);
+			}
+		};
+
+		template<typename Exp>
+		struct expected_awaiter {
+			Exp&& m_exp;
+
+			bool await_ready() const noexcept {
+				return m_exp.has_value();
+			}
+
+			//Lvalues are unwrapped by reference, temporaries by value so the result cannot dangle
+			decltype(auto) await_resume() {
+				using value_type = typename remove_cvref_t<Exp>::value_type;
+				if constexpr (std::is_void_v<value_type>) return;
+				else if constexpr (std::is_lvalue_reference_v<Exp>) return *m_exp;
+				else return value_type(*std::move(m_exp));
+			}
+
+			template<typename Promise>
+			void await_suspend(std::coroutine_handle<Promise> handle) {
+				handle.promise().return_error(std::forward<Exp>(m_exp).error());
+				handle.destroy();
+			}
+		};
+
+		template<typename Err>
+		struct unexpected_awaiter {
+			Err&& m_unex;
+
+			constexpr bool await_ready() const noexcept {
+				return false;
+			}
+			constexpr void await_resume() const noexcept {}
+
+			template<typename Promise>
+			void await_suspend(std::coroutine_handle<Promise> handle) {
+				handle.promise().return_error(std::forward<Err>(m_unex).error());
+				handle.destroy();
+			}
+		};
+
+		template<typename T, typename E>
+		class expected_promise_base {
+			expected_return_object<T, E>* m_return = nullptr;
+#if DP_EXPECTED_COROUTINE_EAGER_RETURN
+			dp::expected<T, E>* m_eager = nullptr;
+#endif
+
+			friend class expected_return_object<T, E>;
+
+		protected:
+			template<typename... Args>
+			void set_result(Args&&... args) {
+#if DP_EXPECTED_COROUTINE_EAGER_RETURN
+				if (m_eager) {
+					*m_eager = dp::expected<T, E>(std::forward<Args>(args)...);
+					return;
+				}
+#endif
+				m_return->m_result.emplace(std::forward<Args>(args)...);
+			}
+
+		public:
+			using result_type = dp::expected<T, E>;
+
+			expected_return_object<T, E> get_return_object() noexcept {
+				return expected_return_object<T, E>{ *this };
+			}
+
+			std::suspend_never initial_suspend() const noexcept {
+				return {};
+			}
+			std::suspend_never final_suspend() const noexcept {
+				return {};
+			}
+
+			//Exceptions are not errors, so they leave the coroutine as they would any other function
+			void unhandled_exception() {
+				throw;
+			}
+
+#if DP_EXPECTED_COROUTINE_EAGER_RETURN
+			void set_result_address(dp::expected<T, E>* inResult) noexcept {
+				m_eager = inResult;
+			}
+#endif
+
+			template<typename G>
+			void return_error(G&& inError) {
+				this->set_result(dp::detail::unexpect_untraced, std::forward<G>(inError));
+			}
+
+			template<typename Exp, std::enable_if_t<is_special_of_expected<remove_cvref_t<Exp>>, bool> = true>
+			auto await_transform(Exp&& inExp) noexcept {
+				static_assert(std::is_constructible_v<E, decltype(std::forward<Exp>(inExp).error())>, "Cannot co_await an expected whose error type cannot convert to this coroutine's error type");
+				return expected_awaiter<Exp>{ std::forward<Exp>(inExp) };
+			}
+
+			template<typename Err, std::enable_if_t<is_special_of_unexpected<remove_cvref_t<Err>>, bool> = true>
+			auto await_transform(Err&& inUnex) noexcept {
+				return unexpected_awaiter<Err>{ std::forward<Err>(inUnex) };
+			}
+		};
+
+		template<typename T, typename E>
+		struct expected_promise : expected_promise_base<T, E> {
+			template<typename U = T>
+			void return_value(U&& inValue) {
+				this->set_result(std::forward<U>(inValue));
+			}
+		};
+
+		template<typename E>
+		struct expected_promise<void, E> : expected_promise_base<void, E> {
+			void return_void() {
+				this->set_result();
+			}
+		};
+
+		/*
+		*  The promise of a coroutine whose first parameter is a coroutine_frame_buffer&, with the types of its other parameters as Args.
+		*  Knowing them up front means its operator new need not be a template, so it pairs with the usual operator delete below.
+		*/
+		template<typename T, typename E, typename... Args>
+		struct buffered_expected_promise : expected_promise<T, E> {
+			static void* operator new(std::size_t size, dp::coroutine_frame_buffer& buffer, Args&...) {
+				const std::size_t previous = buffer.used();
+				void* raw = buffer.allocate(size + coroutine_header_size);
+				::new (raw) coroutine_frame_header{ &buffer, previous };
+				return static_cast<unsigned char*>(raw) + coroutine_header_size;
+			}
+
+			//Matches the operator new above. Frames themselves are always freed through the usual operator delete.
+			static void operator delete(void* ptr, dp::coroutine_frame_buffer&, Args&...) noexcept {
+				release(ptr);
+			}
+
+			static void operator delete(void* ptr, std::size_t) noexcept {
+				release(ptr);
+			}
+
+		private:
+			static void release(void* ptr) noexcept {
+				const void* raw = static_cast<unsigned char*>(ptr) - coroutine_header_size;
+				const coroutine_frame_header* header = static_cast<const coroutine_frame_header*>(raw);
+				header->buffer->release(header->previous_used);
+			}
+		};
+	}
+
+}
+
+template<typename T, typename E, typename... Args>
+struct std::coroutine_traits<dp::expected<T, E>, Args...> {
+	using promise_type = dp::detail::expected_promise<T, E>;
+};
+
+template<typename T, typename E, typename... Args>
+struct std::coroutine_traits<dp::expected<T, E>, dp::coroutine_frame_buffer&, Args...> {
+	using promise_type = dp::detail::buffered_expected_promise<T, E, Args...>;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef DP_CPP98_CLONE_CONTEXT
+#define DP_CPP98_CLONE_CONTEXT
+
+#include "bits/version_defs.h"
+
+#include <cstddef>
+#include <map>
+#include <utility>
+
+/*
+*	A clone context, for deep copies of object graphs which mix owning value pointers and non-owning links.
+*	A value_ptr or poly_value_ptr is the only owner of its object, so in a DAG-shaped model each shared node is owned once and every
+*	other path reaches it through a plain pointer. A memberwise copy of such a graph leaves those plain pointers aimed at the original.
+*
+*	While a clone_context is alive, every object copied by a value_ptr or poly_value_ptr on this thread is recorded against its source.
+*	A copy constructor can then pass its plain links through relink(), which redirects each one to the copy of its target. A link whose
+*	target has not been copied yet is patched as soon as it is, so the order in which the graph is walked does not matter.
+*	Links must have the same type as the owned object, or a base at the same address. A link whose target is never copied keeps
+*	pointing at the original.
+*
+*	Recording costs every value_ptr and poly_value_ptr copy a lookup of the current context, so it is opt-in: define DP_CLONE_CONTEXT
+*	for the whole program, before any of these headers are included. Without it the pointers do not include this header or record anything.
+*
+*	The current context is per thread. Before C++11 this relies on the compiler's own thread-local storage, where there is one; on a
+*	compiler with none it is a single static, and contexts must then only be used while no other thread copies a value_ptr or poly_value_ptr.
+*
+*	Contexts nest; an inner context hides any outer one until it is destroyed.
+*/
+
+namespace dp {
+
+	class clone_context {
+
+		struct pending_link {
+			void* link;
+			void (*assign)(void*, void*);
+		};
+
+		typedef std::map<const void*, void*> copy_map;
+		typedef std::multimap<const void*, pending_link> pending_map;
+
+		copy_map m_copies;
+		pending_map m_pending;
+		clone_context* m_previous;
+
+		template<typename T>
+		static void assign_link(void* inLink, void* inCopy) {
+			*static_cast<T**>(inLink) = static_cast<T*>(inCopy);
+		}
+
+		static clone_context*& active_context() {
+#if defined(DP_CPP11_OR_HIGHER)
+			static thread_local clone_context* active = NULL;
+#elif defined(__GNUC__)
+			static __thread clone_context* active = NULL;
+#elif defined(_MSC_VER)
+			static __declspec(thread) clone_context* active = NULL;
+#else
+			static clone_context* active = NULL;
+#endif
+			return active;
+		}
+
+		//Non-copyable
+		clone_context(const clone_context&);
+		clone_context& operator=(const clone_context&);
+
+	public:
+		clone_context() : m_copies(), m_pending(), m_previous(active_context()) {
+			active_context() = this;
+		}
+
+		~clone_context() {
+			active_context() = m_previous;
+		}
+
+		//The innermost live context on this thread, or NULL if there is none
+		static clone_context* current() {
+			return active_context();
+		}
+
+		//Records that inCopy was cloned from inSource, and patches any links which were waiting for it
+		template<typename T>
+		static void record(const T* inSource, T* inCopy) {
+			clone_context* context = active_context();
+			if (!context || !inSource) return;
+			const void* source = static_cast<const void*>(inSource);
+			void* copy = static_cast<void*>(inCopy);
+			context->m_copies[source] = copy;
+
+			std::pair<pending_map::iterator, pending_map::iterator> waiting = context->m_pending.equal_range(source);
+			for (pending_map::iterator it = waiting.first; it != waiting.second; ++it) {
+				it->second.assign(it->second.link, copy);
+			}
+			context->m_pending.erase(waiting.first, waiting.second);
+		}
+
+		//The copy made of inSource in the current context, or NULL if it has not been copied
+		template<typename T>
+		static T* copy_of(const T* inSource) {
+			clone_context* context = active_context();
+			if (!context || !inSource) return NULL;
+			copy_map::const_iterator it = context->m_copies.find(static_cast<const void*>(inSource));
+			return it == context->m_copies.end() ? NULL : static_cast<T*>(it->second);
+		}
+
+		//Redirects inLink to the copy of its target, now or once the target is copied.
+		//Until then the context holds the address of inLink itself, so the link must stay where it is: it must not be moved, or be in a
+		//container which reallocates, before its target is copied or the context ends.
+		template<typename T>
+		static void relink(T*& inLink) {
+			clone_context* context = active_context();
+			if (!context || !inLink) return;
+			const void* source = static_cast<const void*>(inLink);
+			copy_map::const_iterator it = context->m_copies.find(source);
+			if (it != context->m_copies.end()) {
+				inLink = static_cast<T*>(it->second);
+				return;
+			}
+			pending_link newLink = { static_cast<void*>(&inLink), &assign_link<T> };
+			context->m_pending.insert(std::make_pair(source, newLink));
+		}
+
+		//The number of objects copied so far in this context
+		std::size_t size() const {
+			return m_copies.size();
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef DP_CPP98_COW_MEMO
+#define DP_CPP98_COW_MEMO
+
+#include "cpp98/cow_ptr.h"
+
+#include <cstddef>
+
+/*
+*	Memoizes a function of one to three cow_ptr inputs, using their generation stamps to decide when to recompute.
+*	The result is only recomputed when one of the inputs has a different stamp from last time, i.e. when it holds a different object
+*	or has been accessed in a non-const context since. Checking costs one comparison per input. An input written through a reference
+*	or pointer which was kept from an earlier access keeps its stamp, so touch() must be called on it for the change to be seen.
+*	Inputs must not be null, and R must be default constructible and assignable.
+*/
+
+namespace dp {
+
+	template<typename R>
+	class cow_memo {
+
+		R m_result;
+		std::size_t m_generations[3];
+		bool m_valid;
+
+		bool current(std::size_t inFirst, std::size_t inSecond, std::size_t inThird) const {
+			return m_valid && m_generations[0] == inFirst && m_generations[1] == inSecond && m_generations[2] == inThird;
+		}
+
+		void stamp(std::size_t inFirst, std::size_t inSecond, std::size_t inThird) {
+			m_generations[0] = inFirst;
+			m_generations[1] = inSecond;
+			m_generations[2] = inThird;
+			m_valid = true;
+		}
+
+	public:
+		typedef R result_type;
+
+		cow_memo() : m_result(), m_valid(false) {
+			m_generations[0] = m_generations[1] = m_generations[2] = 0;
+		}
+
+		template<typename T, typename F>
+		const R& get(const dp::cow_ptr<T>& inFirst, F func) {
+			if (!this->current(inFirst.generation(), 0, 0)) {
+				m_result = func(*inFirst);
+				this->stamp(inFirst.generation(), 0, 0);
+			}
+			return m_result;
+		}
+
+		template<typename T, typename U, typename F>
+		const R& get(const dp::cow_ptr<T>& inFirst, const dp::cow_ptr<U>& inSecond, F func) {
+			if (!this->current(inFirst.generation(), inSecond.generation(), 0)) {
+				m_result = func(*inFirst, *inSecond);
+				this->stamp(inFirst.generation(), inSecond.generation(), 0);
+			}
+			return m_result;
+		}
+
+		template<typename T, typename U, typename V, typename F>
+		const R& get(const dp::cow_ptr<T>& inFirst, const dp::cow_ptr<U>& inSecond, const dp::cow_ptr<V>& inThird, F func) {
+			if (!this->current(inFirst.generation(), inSecond.generation(), inThird.generation())) {
+				m_result = func(*inFirst, *inSecond, *inThird);
+				this->stamp(inFirst.generation(), inSecond.generation(), inThird.generation());
+			}
+			return m_result;
+		}
+
+		bool valid() const {
+			return m_valid;
+		}
+
+		//Forces the next get to recompute
+		void invalidate() {
+			m_valid = false;
+		}
+	};
+
+}
+
+#endif
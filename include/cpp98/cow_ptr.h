@@ -3,15 +3,18 @@
 
 #include "cpp98/type_traits.h"
 
+#include "cpp98/detail/cow_control_block.h"
+
 #include "bits/smart_ptr_bases.h"
 #include "bits/static_assert_no_macro.h"
 #include "bits/version_defs.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <new>
 #include <ostream>
 
 
-
 #ifndef DP_CPP17_OR_HIGHER
 #include <memory>
 #endif
@@ -25,6 +28,13 @@ namespace dp {
 	template<typename T, typename DelT>
 	class lite_ptr;
 
+	template<typename T>
+	class weak_cow_ptr;
+
+	namespace detail {
+		struct cow_ptr_access;
+	}
+
 
 	/*
 	*	A copy-on-write smart pointer.
@@ -32,11 +42,20 @@ namespace dp {
 	*	Unlike shared_ptr, this pointer uses copy-on-write. When access to the underlying resource is requested in a non-const context, and if the pointer is not the only
 	*   owner of the resource, it makes a copy of the resource. Pointers in use previous to this change remain unchanged and point to the same "immutable" resource, but 
 	*   changes are reflected in any pointer that makes them (and any pointer spawned off of that pointer).
+	*	A resource which a weak_cow_ptr has observed is treated as shared from then on, so even its only owner copies it before modifying
+	*	it, and the observed snapshot is never changed through a later non-const access.
+	*
+	*	Each object also carries a generation stamp, kept in its control block. Copies of a pointer share their source's stamp, and the stamp
+	*	changes to a new, never before used value whenever the object may have changed: when a pointer is given a new object, detaches to
+	*	its own copy, or is accessed in a non-const context by the object's only owner. Two pointers with the same non-zero stamp therefore
+	*	see the same object in the same state, which makes the stamp a cheap key for detecting change.
+	*	A write through a T& or T* which was obtained from a non-const access and kept is not seen by the pointer at all, so code which
+	*	writes that way, and needs observers of the stamp to notice, should call touch() afterwards.
 	*/
 	template<typename StoredT>
 	class cow_ptr {
 
-		typedef typename dp::detail::shared_control_block_base BlockT;
+		typedef dp::detail::cow_block_base BlockT;
 		typedef typename dp::remove_extent<StoredT>::type stored_type;
 
 
@@ -46,9 +65,22 @@ namespace dp {
 		template<typename U>
 		friend class cow_ptr;
 
+		template<typename U>
+		friend class weak_cow_ptr;
+
+		friend struct dp::detail::cow_ptr_access;
+
+		//Adopts a reference which the caller has already counted, for weak_cow_ptr::lock and cow_ptr_access
+		cow_ptr(stored_type* inPtr, BlockT* inControl) : m_ptr(inPtr), m_control(inControl) {}
+
 		void make_copy() {
-			//If we're not the only pointer using the resource
-			if (m_control && !this->unique()) {
+			if (!m_control) return;
+			//The only owner may write in place, so the object gets a new stamp
+			if (m_control->writable()) {
+				m_control->restamp();
+			}
+			//If we're not the only pointer using the resource, or a weak_cow_ptr has watched this snapshot
+			else {
 				BlockT* newBlock = m_control->clone();
 				m_control->dec_shared();
 				m_control = newBlock;
@@ -65,41 +97,21 @@ namespace dp {
 		explicit cow_ptr(dp::null_ptr_t) : m_ptr(NULL), m_control(NULL) {}
 
 		template<typename U>
-		explicit cow_ptr(U* in) : m_ptr(in), m_control(new dp::detail::shared_block_no_deleter<StoredT>(in)) {
+		explicit cow_ptr(U* in) : m_ptr(in), m_control(new dp::detail::cow_block_no_deleter<StoredT>(in)) {
 			dp::static_assert_98<dp::detail::compatible_ptr_type<U, StoredT>::value>();
 		}
 
 		template<typename U, typename DelT>
-		cow_ptr(U* in, DelT inDel) : m_ptr(in), m_control(new dp::detail::shared_block_with_deleter<StoredT, DelT>(in, inDel)) {
+		cow_ptr(U* in, DelT inDel) : m_ptr(in), m_control(new dp::detail::cow_block_with_deleter<StoredT, DelT>(in, inDel)) {
 			dp::static_assert_98<dp::detail::compatible_ptr_type<U, StoredT>::value>();
 		}
 
+		//The control block, and the blocks of every copy made on detach, are allocated through inAlloc rebound to the block type.
+		//If that allocation fails, inPtr is released through inDel.
 		template<typename U, typename DelT, typename Alloc>
-		cow_ptr(U* inPtr, DelT inDel, Alloc inAlloc) : m_ptr(inPtr) {
+		cow_ptr(U* inPtr, DelT inDel, Alloc inAlloc) : m_ptr(inPtr), m_control(NULL) {
 			dp::static_assert_98<dp::detail::compatible_ptr_type<U, StoredT>::value>();
-#if !defined(DP_CPP20_OR_HIGHER)
-			typedef typename Alloc::rebind<dp::detail::shared_block_with_allocator<U, DelT, Alloc> >::other Rebind;
-			Rebind rb;
-			m_control = rb.allocate(sizeof(dp::detail::shared_block_with_allocator<U, DelT, Alloc>));
-			try {
-
-				rb.construct(m_control, dp::detail::shared_block_with_allocator<U, DelT, Alloc>(inPtr, inDel, inAlloc));
-
-			}
-			catch (...) {
-				rb.deallocate(static_cast<dp::detail::shared_block_with_allocator<U, DelT, Alloc>*>(m_control), sizeof(dp::detail::shared_block_with_allocator<U, DelT, Alloc>));
-				throw;
-			}
-#else
-			m_control = std::allocator_traits<Alloc>::allocate(inAlloc, sizeof(dp::detail::shared_block_with_allocator<U, DelT, Alloc>));
-			try {
-				std::allocator_traits<Alloc>::construct(inAlloc, m_control, dp::detail::shared_block_with_allocator<U, DelT, Alloc>(inPtr, inDel, inAlloc));
-			}
-			catch (...) {
-				std::allocator_traits<Alloc>::deallocate(inAlloc, static_cast<dp::detail::shared_block_with_allocator<U, DelT, Alloc>*>(m_control), sizeof(dp::detail::shared_block_with_allocator<U, DelT, Alloc>));
-				throw;
-			}
-#endif
+			m_control = dp::detail::cow_block_with_allocator<U, DelT, Alloc>::create(inPtr, inDel, inAlloc);
 		}
 
 
@@ -109,18 +121,18 @@ namespace dp {
 
 		//Other smart ptr constructors
 		template<typename U, typename DelT>
-		cow_ptr(dp::scoped_ptr<U, DelT>& in) : m_ptr(in.get()), m_control(new dp::detail::shared_block_with_deleter<StoredT, DelT>(in.release(), in.get_deleter())) {
+		cow_ptr(dp::scoped_ptr<U, DelT>& in) : m_ptr(in.get()), m_control(new dp::detail::cow_block_with_deleter<StoredT, DelT>(in.release(), in.get_deleter())) {
 			dp::static_assert_98<dp::detail::compatible_ptr_type<U, StoredT>::value>();
 		}
 
 		template<typename U, typename DelT>
-		cow_ptr(dp::lite_ptr<U, DelT>& in) : m_ptr(in.get()), m_control(new dp::detail::shared_block_with_deleter<StoredT, DelT>(in.release(), in.get_deleter())) {
+		cow_ptr(dp::lite_ptr<U, DelT>& in) : m_ptr(in.get()), m_control(new dp::detail::cow_block_with_deleter<StoredT, DelT>(in.release(), in.get_deleter())) {
 			dp::static_assert_98<dp::detail::compatible_ptr_type<U, StoredT>::value>();
 		}
 
 #ifndef DP_CPP17_OR_HIGHER
 		template<typename U>
-		cow_ptr(std::auto_ptr<U>& in) : m_ptr(in.get()), m_control(new dp::detail::shared_block_no_deleter<StoredT>(in.release())) {
+		cow_ptr(std::auto_ptr<U>& in) : m_ptr(in.get()), m_control(new dp::detail::cow_block_no_deleter<StoredT>(in.release())) {
 			dp::static_assert_98<dp::detail::compatible_ptr_type<U, StoredT>::value>();
 		}
 #endif
@@ -182,18 +194,18 @@ namespace dp {
 			m_control = NULL;
 		}
 
-		void reset(StoredT* in) {
-			BlockT* newBlock = new BlockT(in);
+		void reset(element_type* in) {
+			BlockT* newBlock = new dp::detail::cow_block_no_deleter<StoredT>(in);
 
 			if (m_control) m_control->dec_shared();
 			m_ptr = in;
 			m_control = newBlock;
 		}
 
-		const StoredT* get() const {
+		const element_type* get() const {
 			return m_ptr;
 		}
-		StoredT* get() {
+		element_type* get() {
 			make_copy();
 			return m_ptr;
 		}
@@ -222,17 +234,28 @@ namespace dp {
 		}
 		element_type& operator[](std::size_t index) {
 			dp::static_assert_98<dp::is_array<StoredT>::value>();
-			return m_ptr[index];
+			return get()[index];
 		}
 
 		std::size_t use_count() const {
-			return m_control ? m_control->shared_count : 0;
+			return m_control ? m_control->use_count() : 0;
 		}
 
 		bool unique() const {
 			return use_count() == 1;
 		}
 
+		//Zero for a null pointer, otherwise the stamp of the object, which changes whenever it may have been modified
+		std::size_t generation() const {
+			return m_control ? m_control->generation() : 0;
+		}
+
+		//Marks a modification made through a kept reference or pointer. This counts as a non-const access, so the object gets a new stamp,
+		//or a shared pointer detaches to its own copy.
+		void touch() {
+			make_copy();
+		}
+
 		operator bool() const {
 			return get() != NULL;
 		}
@@ -247,6 +270,16 @@ namespace dp {
 	template<typename T>
 	class cow_ptr<T&>;
 
+	namespace detail {
+		//Lets other parts of the library wrap a control block of their own in a cow_ptr. The block's count of one becomes the new pointer.
+		struct cow_ptr_access {
+			template<typename T>
+			static dp::cow_ptr<T> adopt(typename dp::remove_extent<T>::type* inPtr, dp::detail::cow_block_base* inBlock) {
+				return dp::cow_ptr<T>(inPtr, inBlock);
+			}
+		};
+	}
+
 	template<typename StoredT>
 	void swap(dp::cow_ptr<StoredT>& lhs, dp::cow_ptr<StoredT>& rhs){
 		lhs.swap(rhs);
@@ -289,7 +322,8 @@ namespace dp {
 	typename dp::enable_if<dp::is_unbounded_array<T>::value, dp::cow_ptr<T> >::type make_cow(std::size_t N, const typename dp::remove_extent<T>::type& u) {
 		typedef typename dp::remove_extent<T>::type elemT;
 		dp::cow_ptr<T> temp(new elemT[N]);
-		for (std::size_t i = 0; i < N; ++i) temp[i] = u;
+		elemT* data = temp.get();
+		for (std::size_t i = 0; i < N; ++i) data[i] = u;
 		return temp;
 	}
 
@@ -297,10 +331,30 @@ namespace dp {
 	typename dp::enable_if<dp::is_bounded_array<T>::value, dp::cow_ptr<T> >::type make_cow(const typename dp::remove_extent<T>::type& u) {
 		typedef typename dp::remove_extent<T>::type elemT;
 		dp::cow_ptr<T> temp(new elemT[dp::extent<T>::value]);
-		for (std::size_t i = 0; i < dp::extent<T>::value; ++i) temp[i] = u;
+		elemT* data = temp.get();
+		for (std::size_t i = 0; i < dp::extent<T>::value; ++i) data[i] = u;
 		return temp;
 	}
 
+	//As make_cow, but the control block is allocated through inAlloc, as are the blocks of the copies made on detach.
+	//The object itself is still created with new, so that a detach can copy it the same way.
+	template<typename T, typename Alloc>
+	typename dp::enable_if<!dp::is_array<T>::value, dp::cow_ptr<T> >::type allocate_cow(const Alloc& inAlloc) {
+		return dp::cow_ptr<T>(new T, dp::default_delete<T>(), inAlloc);
+	}
+	template<typename T, typename Alloc, typename U>
+	typename dp::enable_if<!dp::is_array<T>::value, dp::cow_ptr<T> >::type allocate_cow(const Alloc& inAlloc, const U& in) {
+		return dp::cow_ptr<T>(new T(in), dp::default_delete<T>(), inAlloc);
+	}
+	template<typename T, typename Alloc, typename U, typename V>
+	typename dp::enable_if<!dp::is_array<T>::value, dp::cow_ptr<T> >::type allocate_cow(const Alloc& inAlloc, const U& inU, const V& inV) {
+		return dp::cow_ptr<T>(new T(inU, inV), dp::default_delete<T>(), inAlloc);
+	}
+	template<typename T, typename Alloc, typename U, typename V, typename W>
+	typename dp::enable_if<!dp::is_array<T>::value, dp::cow_ptr<T> >::type allocate_cow(const Alloc& inAlloc, const U& inU, const V& inV, const W& inW) {
+		return dp::cow_ptr<T>(new T(inU, inV, inW), dp::default_delete<T>(), inAlloc);
+	}
+
 	template<typename T, typename U>
 	bool operator==(const dp::cow_ptr<T>& lhs, const dp::cow_ptr<U>& rhs) {
 		return lhs.get() == rhs.get();
@@ -0,0 +1,366 @@
+#ifndef DP_CPP98_COW_SNAPSHOT
+#define DP_CPP98_COW_SNAPSHOT
+
+#include "cpp98/cow_ptr.h"
+#include "cpp98/slab_pool.h"
+#include "cpp98/detail/cow_control_block.h"
+#include "cpp98/detail/cow_snapshot_mapping.h"
+
+#include "bits/static_assert_no_macro.h"
+#include "bits/version_defs.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#ifdef DP_CPP11_OR_HIGHER
+#include <type_traits>
+#endif
+
+/*
+*	A memory-mappable snapshot format for cow_ptr objects.
+*	A cow_snapshot_writer collects cow_ptr objects and writes their bytes to a file, along with a table of where each one lives. Objects
+*	are identified by address, so an object shared by several cow_ptrs is written once and given a single entry. The writer keeps a
+*	handle to every object it has added, so an address cannot be reused by a different object while the writer is alive.
+*	A cow_snapshot_file maps that file and hands out cow_ptrs which point straight into the mapping, so loading costs one mmap no matter
+*	how large the snapshot is, and pages are only read in as they are touched. The mapping is read-only, so its control blocks are pinned:
+*	the first non-const access through a handle always detaches onto the heap, even for the only owner. Each entry gets one control
+*	block, and every block keeps the mapping alive, so handles may outlive the cow_snapshot_file they came from.
+*
+*	The stored types must be trivially copyable, which is checked from C++11, and must not contain pointers, which includes cow_ptr
+*	members. A graph of cow_ptr-shared objects is stored by giving each object a cow_snapshot_ref in place of each cow_ptr it links to.
+*	The ref is the target's entry index, which stays valid wherever the file is mapped, and a shared target is written once, so every
+*	ref to it resolves to the same handle and the sharing survives the round trip.
+*	Each entry records its size and a tag for its type, and get<T> rejects an entry written from a different type. The default tag
+*	is a hash of the type's name as the compiler spells it, so a file can only be read by a build with the same compiler and type
+*	layouts as the one which wrote it. Specialise cow_snapshot_type_tag to give a type a fixed tag. Entries are aligned to 16 bytes,
+*	so a stored type must not need more than that, which is checked at compile time.
+*/
+
+namespace dp {
+
+	namespace detail {
+		//Every field has a fixed width, so the layout does not depend on the size of std::size_t
+		struct cow_snapshot_header {
+			char magic[8];
+			uint64_t entry_count;
+		};
+
+		struct cow_snapshot_entry {
+			uint64_t offset;
+			uint64_t size;
+			uint64_t type_tag;
+		};
+
+		static const char cow_snapshot_magic[8] = { 'D', 'P', 'S', 'N', 'A', 'P', '0', '2' };
+		static const std::size_t cow_snapshot_alignment = 16;
+
+		inline uint64_t cow_snapshot_hash(const char* inText, uint64_t inSeed) {
+			//64-bit FNV-1a
+			uint64_t hash = 14695981039346656037ULL ^ inSeed;
+			for (; *inText; ++inText) {
+				hash ^= static_cast<unsigned char>(*inText);
+				hash *= 1099511628211ULL;
+			}
+			return hash;
+		}
+
+		//The signature of this function names T, which is as close to a type name as we can get without RTTI
+		template<typename T>
+		const char* cow_snapshot_type_name() {
+#if defined(__GNUC__) || defined(__clang__)
+			return __PRETTY_FUNCTION__;
+#elif defined(_MSC_VER)
+			return __FUNCSIG__;
+#else
+			return "";
+#endif
+		}
+
+		//A type-erased copy of a cow_ptr, so that one list can keep handles of every type alive
+		struct cow_snapshot_handle {
+			void* handle;
+			void (*destroy)(void*);
+		};
+
+		template<typename T>
+		void cow_snapshot_destroy_handle(void* in) {
+			delete static_cast<dp::cow_ptr<T>*>(in);
+		}
+
+		inline void cow_snapshot_release(std::vector<cow_snapshot_handle>& inHandles) {
+			for (std::size_t i = 0; i < inHandles.size(); ++i) {
+				if (inHandles[i].handle) inHandles[i].destroy(inHandles[i].handle);
+			}
+			inHandles.clear();
+		}
+
+		template<typename T>
+		void cow_snapshot_check_type() {
+#ifdef DP_CPP11_OR_HIGHER
+			static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be stored in a cow_snapshot");
+#endif
+			dp::static_assert_98<dp::detail::slab_alignment_of<T>::value <= cow_snapshot_alignment>();
+		}
+
+		//A mapping shared by a cow_snapshot_file and every control block it has handed out, unmapped when the last of them goes
+		struct cow_snapshot_mapping_state {
+			dp::detail::cow_count_type refs;
+			dp::detail::read_only_file_mapping mapping;
+
+			explicit cow_snapshot_mapping_state(const char* inPath) : refs(1), mapping(inPath) {}
+
+			void acquire() {
+				++refs;
+			}
+			void release() {
+				if (--refs == 0) delete this;
+			}
+		};
+
+		//The control block of an entry. The object lives in the mapping, so the block is pinned, and a detach copies it onto the heap.
+		template<typename T>
+		class cow_snapshot_block : public dp::detail::cow_block_base {
+			T* m_ptr;
+			cow_snapshot_mapping_state* m_state;
+
+		protected:
+			//The object belongs to the mapping
+			void destroy_resource() {}
+			void destroy_block() {
+				cow_snapshot_mapping_state* state = m_state;
+				delete this;
+				state->release();
+			}
+
+		public:
+			cow_snapshot_block(T* inPtr, cow_snapshot_mapping_state* inState) : m_ptr(inPtr), m_state(inState) {
+				m_state->acquire();
+				this->pin();
+			}
+
+			void* get() {
+				return m_ptr;
+			}
+			dp::detail::cow_block_base* clone() {
+				T* copy = new T(*m_ptr);
+				try {
+					return new dp::detail::cow_block_no_deleter<T>(copy);
+				}
+				catch (...) {
+					delete copy;
+					throw;
+				}
+			}
+		};
+	}
+
+	//The tag stored with each entry of type T. Specialise it with a fixed value to read a file written by a different compiler.
+	template<typename T>
+	struct cow_snapshot_type_tag {
+		static uint64_t value() {
+			return dp::detail::cow_snapshot_hash(dp::detail::cow_snapshot_type_name<T>(), sizeof(T));
+		}
+	};
+
+	//A link to another entry of the same snapshot, for objects which would otherwise hold a cow_ptr. It is trivially copyable.
+	template<typename T>
+	struct cow_snapshot_ref {
+		//All bits set for a null ref
+		uint64_t index;
+
+		static cow_snapshot_ref null() {
+			cow_snapshot_ref result = { ~static_cast<uint64_t>(0) };
+			return result;
+		}
+		bool is_null() const {
+			return index == ~static_cast<uint64_t>(0);
+		}
+	};
+
+
+	class cow_snapshot_writer {
+		std::vector<char> m_data;
+		std::vector<dp::detail::cow_snapshot_entry> m_entries;
+		std::map<const void*, std::size_t> m_indices;
+		std::vector<dp::detail::cow_snapshot_handle> m_handles;
+
+		//Non-copyable
+		cow_snapshot_writer(const cow_snapshot_writer&);
+		cow_snapshot_writer& operator=(const cow_snapshot_writer&);
+
+	public:
+		cow_snapshot_writer() : m_data(), m_entries(), m_indices(), m_handles() {}
+
+		~cow_snapshot_writer() {
+			dp::detail::cow_snapshot_release(m_handles);
+		}
+
+		//Adds the object held by inPtr, if it is not already in the snapshot, and returns its entry index. inPtr must not be null.
+		template<typename T>
+		std::size_t add(const dp::cow_ptr<T>& inPtr) {
+			dp::detail::cow_snapshot_check_type<T>();
+			const T* object = inPtr.get();
+			if (!object) throw std::invalid_argument("Cannot add a null cow_ptr to a snapshot");
+
+			std::map<const void*, std::size_t>::const_iterator it = m_indices.find(object);
+			if (it != m_indices.end()) return it->second;
+
+			//Pushed empty first, so that nothing leaks if either allocation throws
+			dp::detail::cow_snapshot_handle held = { NULL, &dp::detail::cow_snapshot_destroy_handle<T> };
+			m_handles.push_back(held);
+			m_handles.back().handle = new dp::cow_ptr<T>(inPtr);
+
+			const std::size_t alignment = dp::detail::cow_snapshot_alignment;
+			const std::size_t offset = (m_data.size() + alignment - 1) / alignment * alignment;
+			dp::detail::cow_snapshot_entry newEntry;
+			newEntry.offset = offset;
+			newEntry.size = sizeof(T);
+			newEntry.type_tag = dp::cow_snapshot_type_tag<T>::value();
+			m_data.resize(offset + sizeof(T));
+			std::memcpy(&m_data[offset], object, sizeof(T));
+
+			m_entries.push_back(newEntry);
+			m_indices[object] = m_entries.size() - 1;
+			return m_entries.size() - 1;
+		}
+
+		//As add, but returns a ref which another stored object can hold. A null inPtr gives a null ref.
+		template<typename T>
+		dp::cow_snapshot_ref<T> ref(const dp::cow_ptr<T>& inPtr) {
+			if (!inPtr) return dp::cow_snapshot_ref<T>::null();
+			dp::cow_snapshot_ref<T> result = { static_cast<uint64_t>(this->add(inPtr)) };
+			return result;
+		}
+
+		std::size_t size() const {
+			return m_entries.size();
+		}
+
+		void write(const char* inPath) const {
+			const std::size_t alignment = dp::detail::cow_snapshot_alignment;
+			const std::size_t tableBytes = sizeof(dp::detail::cow_snapshot_header) + m_entries.size() * sizeof(dp::detail::cow_snapshot_entry);
+			const std::size_t dataStart = (tableBytes + alignment - 1) / alignment * alignment;
+
+			dp::detail::cow_snapshot_header header;
+			std::memcpy(header.magic, dp::detail::cow_snapshot_magic, sizeof(header.magic));
+			header.entry_count = m_entries.size();
+
+			//Offsets in the file are measured from its start
+			std::vector<dp::detail::cow_snapshot_entry> entries(m_entries);
+			for (std::size_t i = 0; i < entries.size(); ++i) entries[i].offset += dataStart;
+
+			std::FILE* file = std::fopen(inPath, "wb");
+			if (!file) throw std::runtime_error("Could not open snapshot file for writing");
+			const std::vector<char> padding(dataStart - tableBytes, 0);
+			bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+			if (ok && !entries.empty()) ok = std::fwrite(&entries[0], sizeof(entries[0]), entries.size(), file) == entries.size();
+			if (ok && !padding.empty()) ok = std::fwrite(&padding[0], 1, padding.size(), file) == padding.size();
+			if (ok && !m_data.empty()) ok = std::fwrite(&m_data[0], 1, m_data.size(), file) == m_data.size();
+			if (std::fclose(file) != 0) ok = false;
+			if (!ok) throw std::runtime_error("Could not write snapshot file");
+		}
+	};
+
+
+	class cow_snapshot_file {
+
+		dp::detail::cow_snapshot_mapping_state* m_state;
+		const char* m_data;
+		std::size_t m_length;
+		std::size_t m_count;
+		std::vector<dp::detail::cow_snapshot_handle> m_handles;
+
+		const dp::detail::cow_snapshot_entry& entry(std::size_t index) const {
+			return reinterpret_cast<const dp::detail::cow_snapshot_entry*>(m_data + sizeof(dp::detail::cow_snapshot_header))[index];
+		}
+
+		void validate() {
+			typedef dp::detail::cow_snapshot_header header_type;
+			if (m_length < sizeof(header_type)) throw std::runtime_error("Snapshot file is too small");
+			const header_type* header = reinterpret_cast<const header_type*>(m_data);
+			if (std::memcmp(header->magic, dp::detail::cow_snapshot_magic, sizeof(header->magic)) != 0) throw std::runtime_error("Not a snapshot file");
+			if (header->entry_count > (m_length - sizeof(header_type)) / sizeof(dp::detail::cow_snapshot_entry)) throw std::runtime_error("Snapshot file is truncated");
+			m_count = static_cast<std::size_t>(header->entry_count);
+			for (std::size_t i = 0; i < m_count; ++i) {
+				if (entry(i).offset > m_length || entry(i).size > m_length - entry(i).offset) throw std::runtime_error("Snapshot file is truncated");
+			}
+		}
+
+		//Non-copyable
+		cow_snapshot_file(const cow_snapshot_file&);
+		cow_snapshot_file& operator=(const cow_snapshot_file&);
+
+	public:
+		explicit cow_snapshot_file(const char* inPath) : m_state(new dp::detail::cow_snapshot_mapping_state(inPath)), m_data(m_state->mapping.data()),
+			m_length(m_state->mapping.size()), m_count(0), m_handles() {
+			try {
+				this->validate();
+				dp::detail::cow_snapshot_handle empty = { NULL, NULL };
+				m_handles.resize(m_count, empty);
+			}
+			catch (...) {
+				m_state->release();
+				throw;
+			}
+		}
+
+		//Handles which are still held elsewhere keep the mapping alive
+		~cow_snapshot_file() {
+			dp::detail::cow_snapshot_release(m_handles);
+			m_state->release();
+		}
+
+		//The number of entries in the snapshot
+		std::size_t size() const {
+			return m_count;
+		}
+
+		//A handle to entry index, which must have been written from a T. Every handle to the same entry shares one control block.
+		template<typename T>
+		dp::cow_ptr<T> get(std::size_t index) {
+			dp::detail::cow_snapshot_check_type<T>();
+			if (index >= m_count) throw std::out_of_range("Index out of range in cow_snapshot_file::get");
+			if (entry(index).size != sizeof(T) || entry(index).type_tag != dp::cow_snapshot_type_tag<T>::value()) {
+				throw std::invalid_argument("Snapshot entry does not match the requested type");
+			}
+
+			dp::detail::cow_snapshot_handle& held = m_handles[index];
+			if (!held.handle) {
+				T* object = reinterpret_cast<T*>(const_cast<char*>(m_data + entry(index).offset));
+				dp::cow_ptr<T>* handle = new dp::cow_ptr<T>();
+				try {
+					*handle = dp::detail::cow_ptr_access::adopt<T>(object, new dp::detail::cow_snapshot_block<T>(object, m_state));
+				}
+				catch (...) {
+					delete handle;
+					throw;
+				}
+				held.handle = handle;
+				held.destroy = &dp::detail::cow_snapshot_destroy_handle<T>;
+			}
+			return *static_cast<const dp::cow_ptr<T>*>(held.handle);
+		}
+
+		//The handle inRef links to, or a null cow_ptr for a null ref
+		template<typename T>
+		dp::cow_ptr<T> get(const dp::cow_snapshot_ref<T>& inRef) {
+			if (inRef.is_null()) return dp::cow_ptr<T>();
+			if (inRef.index >= m_count) throw std::out_of_range("Ref out of range in cow_snapshot_file::get");
+			return this->get<T>(static_cast<std::size_t>(inRef.index));
+		}
+
+		//Whether in points into the mapping, i.e. whether an object has not yet been detached onto the heap
+		bool contains(const void* in) const {
+			const char* address = static_cast<const char*>(in);
+			return address >= m_data && address < m_data + m_length;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef DP_CPP98_DEFERRED_DELETE
+#define DP_CPP98_DEFERRED_DELETE
+
+#include "cpp98/type_traits.h"
+#include "bits/smart_ptr_bases.h"
+#include "bits/version_defs.h"
+
+#include <cstddef>
+#include <vector>
+
+#ifdef DP_CPP11_OR_HIGHER
+#include <mutex>
+#endif
+
+/*
+*	Deferred reclamation for smart pointers.
+*	Releasing the last owner of a large object graph runs every destructor in that graph on the releasing thread. A deferred_delete
+*	deleter instead retires the object to a reclaim_queue, and the owner of the queue destroys retired objects at a point of its
+*	choosing, e.g. between requests, by calling flush().
+*
+*	deferred_delete is an ordinary deleter, so it can be passed to any cow_ptr constructor which accepts one, including the allocator-aware
+*	constructor.
+*/
+
+namespace dp {
+
+	/*
+	*	A bounded queue of objects awaiting destruction. Its storage is reserved up front and never grows; an object retired to a full
+	*	queue is destroyed immediately instead, on the retiring thread.
+	*	The last owner of a shared object can be released on any thread, so retiring takes a lock, and any thread may retire to the
+	*	queue while its owner flushes it. Destructors run outside the lock, so they may retire further objects to the same queue.
+	*	Before C++11 there is no standard mutex, so the queue and every pointer whose deleter refers to it must be used from one thread.
+	*
+	*	A deferred_delete refers to its queue by address, so the queue must outlive every pointer which was given one. Destroy or
+	*	reset those first; the queue's destructor then flushes whatever they retired.
+	*/
+	class reclaim_queue {
+
+		struct entry {
+			void* ptr;
+			void (*destroy)(void*);
+		};
+
+		std::vector<entry> m_pending;
+		std::size_t m_capacity;
+#ifdef DP_CPP11_OR_HIGHER
+		mutable std::mutex m_lock;
+#endif
+
+		//Takes the newest retired object off the queue, if there is one
+		bool pop(entry& out) {
+#ifdef DP_CPP11_OR_HIGHER
+			std::lock_guard<std::mutex> guard(m_lock);
+#endif
+			if (m_pending.empty()) return false;
+			out = m_pending.back();
+			m_pending.pop_back();
+			return true;
+		}
+
+		template<typename T>
+		static void destroy_object(void* in) {
+			typedef typename dp::remove_extent<T>::type element_type;
+			dp::default_delete<T>()(static_cast<element_type*>(in));
+		}
+
+		//Non-copyable
+		reclaim_queue(const reclaim_queue&);
+		reclaim_queue& operator=(const reclaim_queue&);
+
+	public:
+		explicit reclaim_queue(std::size_t inCapacity) : m_pending(), m_capacity(inCapacity)
+#ifdef DP_CPP11_OR_HIGHER
+			, m_lock()
+#endif
+		{
+			m_pending.reserve(inCapacity);
+		}
+
+		~reclaim_queue() {
+			this->flush();
+		}
+
+		template<typename T>
+		void retire(typename dp::remove_extent<T>::type* in) {
+			if (!in) return;
+			{
+#ifdef DP_CPP11_OR_HIGHER
+				std::lock_guard<std::mutex> guard(m_lock);
+#endif
+				if (m_pending.size() < m_capacity) {
+					entry newEntry = { in, &destroy_object<T> };
+					m_pending.push_back(newEntry);
+					return;
+				}
+			}
+			destroy_object<T>(in);
+		}
+
+		//Destroys every retired object, including any retired by those destructors, and returns how many were destroyed
+		std::size_t flush() {
+			return this->flush(static_cast<std::size_t>(-1));
+		}
+
+		//Destroys at most inMax retired objects, to bound the length of a single pause
+		std::size_t flush(std::size_t inMax) {
+			std::size_t count = 0;
+			entry toDestroy;
+			while (count < inMax && this->pop(toDestroy)) {
+				toDestroy.destroy(toDestroy.ptr);
+				++count;
+			}
+			return count;
+		}
+
+		std::size_t size() const {
+#ifdef DP_CPP11_OR_HIGHER
+			std::lock_guard<std::mutex> guard(m_lock);
+#endif
+			return m_pending.size();
+		}
+		std::size_t capacity() const {
+			return m_capacity;
+		}
+		bool empty() const {
+			return this->size() == 0;
+		}
+	};
+
+
+	template<typename T>
+	class deferred_delete {
+		dp::reclaim_queue* m_queue;
+
+	public:
+		typedef typename dp::remove_extent<T>::type element_type;
+
+		explicit deferred_delete(dp::reclaim_queue& inQueue) : m_queue(&inQueue) {}
+
+		void operator()(element_type* in) const {
+			m_queue->retire<T>(in);
+		}
+
+		dp::reclaim_queue& queue() const {
+			return *m_queue;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,308 @@
+#ifndef DP_CPP98_COW_CONTROL_BLOCK
+#define DP_CPP98_COW_CONTROL_BLOCK
+
+#include "cpp98/slab_pool.h"
+#include "cpp98/type_traits.h"
+
+#include "bits/smart_ptr_bases.h"
+#include "bits/static_assert_no_macro.h"
+#include "bits/version_defs.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+
+#ifdef DP_CPP11_OR_HIGHER
+#include <atomic>
+#include <memory>
+#endif
+
+/*
+*	The control blocks behind cow_ptr and weak_cow_ptr.
+*	These belong to this repo rather than to the core library's shared_ptr internals, as copy-on-write needs more of a block than
+*	shared ownership does: a block copies its object onto a new block when an owner detaches, and keeps a count of the weak_cow_ptrs
+*	observing it. Only default_delete is taken from the core library.
+*	Counts are std::atomic from C++11, so pointers to the same block can be copied and released on different threads, and plain
+*	integers before it.
+*	From C++11 the blocks themselves come from slab_pool, so creating and detaching a cow_ptr does not go to the general heap for
+*	its block. Before C++11 the pool is not safe to use from more than one thread, so blocks use plain new there. Either way, a
+*	deleter must not need more alignment than slab_pool gives.
+*/
+
+namespace dp {
+
+	namespace detail {
+
+#ifdef DP_CPP11_OR_HIGHER
+		typedef std::atomic<std::size_t> cow_count_type;
+#else
+		typedef std::size_t cow_count_type;
+#endif
+
+#ifdef DP_CPP11_OR_HIGHER
+		//How many generation stamps a thread takes from the shared source at once
+		constexpr std::size_t cow_generation_batch = 1024;
+#endif
+
+		//A process-wide source of generation stamps. Zero is never handed out, so it can stand for a null pointer.
+		//From C++11 each thread draws a range of stamps at a time and hands them out from there, so that stamping does not make every
+		//thread contend on one shared counter.
+		inline std::size_t next_cow_generation() {
+#ifdef DP_CPP11_OR_HIGHER
+			static std::atomic<std::size_t> source(1);
+			static thread_local std::size_t next = 0;
+			static thread_local std::size_t end = 0;
+			if (next == end) {
+				next = source.fetch_add(cow_generation_batch, std::memory_order_relaxed);
+				end = next + cow_generation_batch;
+			}
+			return next++;
+#else
+			static std::size_t counter = 0;
+			return ++counter;
+#endif
+		}
+
+		//Copies a held resource for a detaching block. An unbounded array does not know its own length, so it cannot be copied.
+		template<typename T>
+		struct cow_clone_resource {
+			static T* clone(const T* in) {
+				return new T(*in);
+			}
+		};
+		template<typename T, std::size_t N>
+		struct cow_clone_resource<T[N]> {
+			static T* clone(const T* in) {
+				T* copy = new T[N];
+				try {
+					std::copy(in, in + N, copy);
+				}
+				catch (...) {
+					delete[] copy;
+					throw;
+				}
+				return copy;
+			}
+		};
+		template<typename T>
+		struct cow_clone_resource<T[]> {
+			static T* clone(const T*) {
+				throw std::logic_error("An array of unknown bound cannot be copied");
+			}
+		};
+
+		class cow_block_base {
+			//The top bit of the owner count is set for good once a weak_cow_ptr has observed the block, or by a block whose object must
+			//never be written. The count then never reads as exactly one, so that writable() can tell with a single load that the object
+			//may be modified in place.
+			cow_count_type m_shared;
+			//One for every weak_cow_ptr, plus one held by the owners together, so that the block outlives whichever goes last
+			cow_count_type m_weak;
+			//Only ever changed by the block's only owner, so it needs no synchronisation of its own
+			std::size_t m_generation;
+
+			static const std::size_t pinned_flag = ~(std::size_t(-1) >> 1);
+
+			//Non-copyable
+			cow_block_base(const cow_block_base&);
+			cow_block_base& operator=(const cow_block_base&);
+
+		protected:
+			//Destroys the held object, once the last owner has gone
+			virtual void destroy_resource() = 0;
+			//Frees the block itself, once nothing refers to it
+			virtual void destroy_block() {
+				delete this;
+			}
+			//Stops the object ever being modified in place, so that even its only owner copies it first
+			void pin() {
+				m_shared |= pinned_flag;
+			}
+
+		public:
+#ifdef DP_CPP11_OR_HIGHER
+			static void* operator new(std::size_t inSize) {
+				return dp::slab_pool::allocate(inSize);
+			}
+			//The destructor is virtual, so this is given the size of the most derived block
+			static void operator delete(void* in, std::size_t inSize) {
+				dp::slab_pool::deallocate(in, inSize);
+			}
+#endif
+
+			cow_block_base() : m_shared(1), m_weak(1), m_generation(dp::detail::next_cow_generation()) {}
+			virtual ~cow_block_base() {}
+
+			virtual void* get() = 0;
+			//A new block, with a count of one, owning a copy of the held object
+			virtual cow_block_base* clone() = 0;
+
+			std::size_t use_count() const {
+				return m_shared & ~pinned_flag;
+			}
+			//Whether the only owner may modify the object in place: there are no other owners, and the block has not been pinned
+			bool writable() const {
+				return m_shared == 1;
+			}
+
+			std::size_t generation() const {
+				return m_generation;
+			}
+			//Gives the block a new stamp, when its only owner may be about to modify the object in place
+			void restamp() {
+				m_generation = dp::detail::next_cow_generation();
+			}
+
+			void inc_shared() {
+				++m_shared;
+			}
+			//Adds an owner only if one is still left, for weak_cow_ptr::lock. A separate check and increment could race with the last
+			//owner's release, and revive an object which is already being destroyed.
+			bool try_inc_shared() {
+#ifdef DP_CPP11_OR_HIGHER
+				std::size_t count = m_shared.load();
+				do {
+					if ((count & ~pinned_flag) == 0) return false;
+				} while (!m_shared.compare_exchange_weak(count, count + 1));
+				return true;
+#else
+				if (this->use_count() == 0) return false;
+				++m_shared;
+				return true;
+#endif
+			}
+			void dec_shared() {
+				if (((--m_shared) & ~pinned_flag) == 0) {
+					this->destroy_resource();
+					this->dec_weak();
+				}
+			}
+			void inc_weak() {
+				++m_weak;
+				this->pin();
+			}
+			void dec_weak() {
+				if (--m_weak == 0) this->destroy_block();
+			}
+		};
+
+		template<typename T>
+		class cow_block_no_deleter : public cow_block_base {
+		public:
+			typedef typename dp::remove_extent<T>::type element_type;
+
+		private:
+			element_type* m_ptr;
+
+		protected:
+			void destroy_resource() {
+				dp::default_delete<T>()(m_ptr);
+				m_ptr = NULL;
+			}
+
+		public:
+			explicit cow_block_no_deleter(element_type* in) : m_ptr(in) {
+				dp::static_assert_98<dp::detail::slab_alignment_of<cow_block_no_deleter>::value <= dp::slab_pool::alignment>();
+			}
+
+			void* get() {
+				return m_ptr;
+			}
+			cow_block_base* clone() {
+				element_type* copy = dp::detail::cow_clone_resource<T>::clone(m_ptr);
+				try {
+					return new cow_block_no_deleter(copy);
+				}
+				catch (...) {
+					dp::default_delete<T>()(copy);
+					throw;
+				}
+			}
+		};
+
+		template<typename T, typename DelT>
+		class cow_block_with_deleter : public cow_block_base {
+		public:
+			typedef typename dp::remove_extent<T>::type element_type;
+
+		protected:
+			element_type* m_ptr;
+			DelT m_deleter;
+
+			void destroy_resource() {
+				m_deleter(m_ptr);
+				m_ptr = NULL;
+			}
+
+		public:
+			cow_block_with_deleter(element_type* in, const DelT& inDel) : m_ptr(in), m_deleter(inDel) {
+				dp::static_assert_98<dp::detail::slab_alignment_of<cow_block_with_deleter>::value <= dp::slab_pool::alignment>();
+			}
+
+			void* get() {
+				return m_ptr;
+			}
+			cow_block_base* clone() {
+				element_type* copy = dp::detail::cow_clone_resource<T>::clone(m_ptr);
+				try {
+					return new cow_block_with_deleter(copy, m_deleter);
+				}
+				catch (...) {
+					m_deleter(copy);
+					throw;
+				}
+			}
+		};
+
+		//A block which was allocated through Alloc, rebound to the block type, and which frees itself and allocates its clones the same way
+		template<typename T, typename DelT, typename Alloc>
+		class cow_block_with_allocator : public cow_block_with_deleter<T, DelT> {
+		public:
+			typedef typename cow_block_with_deleter<T, DelT>::element_type element_type;
+#ifdef DP_CPP11_OR_HIGHER
+			typedef typename std::allocator_traits<Alloc>::template rebind_alloc<cow_block_with_allocator> block_allocator;
+#else
+			typedef typename Alloc::template rebind<cow_block_with_allocator>::other block_allocator;
+#endif
+
+		private:
+			Alloc m_allocator;
+
+		protected:
+			void destroy_block() {
+				block_allocator alloc(m_allocator);
+				this->~cow_block_with_allocator();
+				alloc.deallocate(this, 1);
+			}
+
+		public:
+			cow_block_with_allocator(element_type* in, const DelT& inDel, const Alloc& inAlloc) : cow_block_with_deleter<T, DelT>(in, inDel), m_allocator(inAlloc) {}
+
+			//Allocates a block for inPtr through inAlloc. If that fails, inPtr is released through inDel.
+			static cow_block_with_allocator* create(element_type* inPtr, const DelT& inDel, const Alloc& inAlloc) {
+				block_allocator alloc(inAlloc);
+				cow_block_with_allocator* block = NULL;
+				try {
+					block = alloc.allocate(1);
+					::new (static_cast<void*>(block)) cow_block_with_allocator(inPtr, inDel, inAlloc);
+				}
+				catch (...) {
+					if (block) alloc.deallocate(block, 1);
+					DelT deleter(inDel);
+					deleter(inPtr);
+					throw;
+				}
+				return block;
+			}
+
+			cow_block_base* clone() {
+				return create(dp::detail::cow_clone_resource<T>::clone(this->m_ptr), this->m_deleter, m_allocator);
+			}
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef DP_CPP98_COW_SNAPSHOT_MAPPING
+#define DP_CPP98_COW_SNAPSHOT_MAPPING
+
+#include <cstddef>
+#include <stdexcept>
+
+/*
+*	The platform half of cow_snapshot: a read-only mapping of a whole file, through mmap on POSIX and MapViewOfFile on Windows.
+*	On Windows this needs <windows.h>. It is included with NOMINMAX and WIN32_LEAN_AND_MEAN defined, unless the includer has
+*	already defined them, and both are undefined again afterwards so that they do not leak into the rest of the program.
+*/
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#define DP_COW_SNAPSHOT_DEFINED_NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define DP_COW_SNAPSHOT_DEFINED_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#ifdef DP_COW_SNAPSHOT_DEFINED_NOMINMAX
+#undef NOMINMAX
+#undef DP_COW_SNAPSHOT_DEFINED_NOMINMAX
+#endif
+#ifdef DP_COW_SNAPSHOT_DEFINED_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef DP_COW_SNAPSHOT_DEFINED_LEAN_AND_MEAN
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dp {
+
+	namespace detail {
+
+		class read_only_file_mapping {
+			const char* m_data;
+			std::size_t m_length;
+#ifdef _WIN32
+			HANDLE m_file;
+			HANDLE m_mapping;
+#endif
+
+			void close() {
+#ifdef _WIN32
+				if (m_data) UnmapViewOfFile(m_data);
+				if (m_mapping) CloseHandle(m_mapping);
+				if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+				if (m_data) munmap(const_cast<char*>(m_data), m_length);
+#endif
+				m_data = NULL;
+			}
+
+			//Non-copyable
+			read_only_file_mapping(const read_only_file_mapping&);
+			read_only_file_mapping& operator=(const read_only_file_mapping&);
+
+		public:
+			//Maps the whole of the file at inPath. An empty file gives an empty mapping with a null data pointer.
+			explicit read_only_file_mapping(const char* inPath) : m_data(NULL), m_length(0)
+#ifdef _WIN32
+				, m_file(INVALID_HANDLE_VALUE), m_mapping(NULL)
+#endif
+			{
+#ifdef _WIN32
+				m_file = CreateFileA(inPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+				LARGE_INTEGER fileSize;
+				if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &fileSize)) {
+					this->close();
+					throw std::runtime_error("Could not open snapshot file");
+				}
+				m_length = static_cast<std::size_t>(fileSize.QuadPart);
+				if (m_length != 0) {
+					m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+					if (m_mapping) m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+					if (!m_data) {
+						this->close();
+						throw std::runtime_error("Could not map snapshot file");
+					}
+				}
+#else
+				const int descriptor = open(inPath, O_RDONLY);
+				struct stat status;
+				if (descriptor < 0 || fstat(descriptor, &status) != 0) {
+					if (descriptor >= 0) ::close(descriptor);
+					throw std::runtime_error("Could not open snapshot file");
+				}
+				m_length = static_cast<std::size_t>(status.st_size);
+				if (m_length != 0) {
+					void* mapped = mmap(NULL, m_length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+					if (mapped != MAP_FAILED) m_data = static_cast<const char*>(mapped);
+				}
+				//The mapping stays valid after the descriptor is closed
+				::close(descriptor);
+				if (m_length != 0 && !m_data) throw std::runtime_error("Could not map snapshot file");
+#endif
+			}
+
+			~read_only_file_mapping() {
+				this->close();
+			}
+
+			const char* data() const {
+				return m_data;
+			}
+			std::size_t size() const {
+				return m_length;
+			}
+		};
+
+	}
+
+}
+
+#endif
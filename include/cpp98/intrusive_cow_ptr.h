@@ -0,0 +1,274 @@
+#ifndef DP_CPP98_INTRUSIVE_COW_PTR
+#define DP_CPP98_INTRUSIVE_COW_PTR
+
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+
+namespace dp {
+
+	template<typename Derived>
+	class intrusive_cow_base;
+
+	namespace detail {
+
+		struct intrusive_cow_op {
+			enum type {
+				clone,
+				destroy
+			};
+		};
+
+		//Copies and deletes an object through its dynamic type U, so that a handle to one of its bases never slices it
+		template<typename Root, typename U>
+		struct intrusive_cow_manager {
+			static Root* manage(intrusive_cow_op::type inOp, const Root* inPtr);
+		};
+
+		//Records the dynamic type of an object when a handle first adopts it. Types with their own counting have nothing to record.
+		template<typename Root, typename U>
+		void intrusive_cow_record_type(dp::intrusive_cow_base<Root>* inBase, U*) {
+			if (!inBase->m_cow_manager) inBase->m_cow_manager = &intrusive_cow_manager<Root, U>::manage;
+		}
+		template<typename U>
+		void intrusive_cow_record_type(const volatile void*, U*) {}
+
+		template<typename Root, typename U>
+		void intrusive_cow_destroy(const dp::intrusive_cow_base<Root>* inBase, U*) {
+			inBase->m_cow_manager(intrusive_cow_op::destroy, static_cast<const Root*>(inBase));
+		}
+		template<typename U>
+		void intrusive_cow_destroy(const volatile void*, U* inPtr) {
+			delete inPtr;
+		}
+	}
+
+	/*
+	*	A base class for types which carry their own copy-on-write reference count.
+	*	The count belongs to the object's identity rather than its value, so it is never copied or assigned along with it.
+	*	Alongside the count the object holds a manager function for its dynamic type, set when an intrusive_cow_ptr adopts it, so a
+	*	handle to a base of a class hierarchy copies and deletes the whole object. Neither the base nor the destructor need be virtual.
+	*
+	*	Types which cannot inherit from this may instead provide their own intrusive_cow_add_ref, intrusive_cow_release,
+	*	intrusive_cow_use_count and intrusive_cow_clone overloads to be found by ADL. Those are deleted through their static type.
+	*
+	*	The count is a plain integer. Handles to the same object must not be copied or released concurrently without external synchronisation.
+	*/
+	template<typename Derived>
+	class intrusive_cow_base {
+		typedef Derived*(*manager_type)(detail::intrusive_cow_op::type, const Derived*);
+
+		mutable std::size_t m_cow_count;
+		manager_type m_cow_manager;
+
+		template<typename Root, typename U>
+		friend void detail::intrusive_cow_record_type(dp::intrusive_cow_base<Root>*, U*);
+		template<typename Root, typename U>
+		friend void detail::intrusive_cow_destroy(const dp::intrusive_cow_base<Root>*, U*);
+
+	protected:
+		intrusive_cow_base() : m_cow_count(0), m_cow_manager(NULL) {}
+		intrusive_cow_base(const intrusive_cow_base&) : m_cow_count(0), m_cow_manager(NULL) {}
+		intrusive_cow_base& operator=(const intrusive_cow_base&) {
+			return *this;
+		}
+		~intrusive_cow_base() {}
+
+	public:
+		friend void intrusive_cow_add_ref(const Derived* in) {
+			++static_cast<const intrusive_cow_base*>(in)->m_cow_count;
+		}
+		//Returns true if that was the last reference and the object should be deleted
+		friend bool intrusive_cow_release(const Derived* in) {
+			return --static_cast<const intrusive_cow_base*>(in)->m_cow_count == 0;
+		}
+		friend std::size_t intrusive_cow_use_count(const Derived* in) {
+			return static_cast<const intrusive_cow_base*>(in)->m_cow_count;
+		}
+		friend Derived* intrusive_cow_clone(const Derived* in) {
+			return static_cast<const intrusive_cow_base*>(in)->m_cow_manager(detail::intrusive_cow_op::clone, in);
+		}
+	};
+
+	namespace detail {
+		template<typename Root, typename U>
+		Root* intrusive_cow_manager<Root, U>::manage(intrusive_cow_op::type inOp, const Root* inPtr) {
+			const U* dynamic_ptr = static_cast<const U*>(inPtr);
+			switch (inOp) {
+			case intrusive_cow_op::clone: {
+				U* newObj = new U(*dynamic_ptr);
+				dp::detail::intrusive_cow_record_type(newObj, newObj);
+				return newObj;
+			}
+			case intrusive_cow_op::destroy:
+				delete dynamic_ptr;
+				return NULL;
+			}
+			return NULL;
+		}
+	}
+
+
+	/*
+	*	A copy-on-write pointer to an object which holds its own reference count.
+	*	Compared to cow_ptr this is a single pointer with no separate control block: checking uniqueness is one load, and
+	*	detaching allocates only the new object.
+	*/
+	template<typename T>
+	class intrusive_cow_ptr {
+
+		T* m_ptr;
+
+		static void dec_ref(T* in) {
+			if (in && intrusive_cow_release(in)) dp::detail::intrusive_cow_destroy(in, in);
+		}
+
+		void make_copy() {
+			//If we're not the only pointer using the resource
+			if (m_ptr && !this->unique()) {
+				T* newObj = static_cast<T*>(intrusive_cow_clone(static_cast<const T*>(m_ptr)));
+				intrusive_cow_add_ref(newObj);
+				dec_ref(m_ptr);
+				m_ptr = newObj;
+			}
+		}
+
+	public:
+
+		typedef T element_type;
+
+		intrusive_cow_ptr() : m_ptr(NULL) {}
+
+		//The object is copied and deleted as a U from here on, so pass the pointer before converting it to a base
+		template<typename U>
+		explicit intrusive_cow_ptr(U* in) : m_ptr(in) {
+			if (m_ptr) {
+				dp::detail::intrusive_cow_record_type(in, in);
+				intrusive_cow_add_ref(m_ptr);
+			}
+		}
+
+		intrusive_cow_ptr(const intrusive_cow_ptr& inPtr) : m_ptr(inPtr.m_ptr) {
+			if (m_ptr) intrusive_cow_add_ref(m_ptr);
+		}
+
+		~intrusive_cow_ptr() {
+			this->reset();
+		}
+
+		intrusive_cow_ptr& operator=(const intrusive_cow_ptr& inPtr) {
+			intrusive_cow_ptr copy(inPtr);
+			this->swap(copy);
+			return *this;
+		}
+
+		void swap(intrusive_cow_ptr& inPtr) {
+			using std::swap;
+			swap(m_ptr, inPtr.m_ptr);
+		}
+
+		void reset() {
+			dec_ref(m_ptr);
+			m_ptr = NULL;
+		}
+
+		template<typename U>
+		void reset(U* in) {
+			intrusive_cow_ptr copy(in);
+			this->swap(copy);
+		}
+
+		const T* get() const {
+			return m_ptr;
+		}
+		T* get() {
+			make_copy();
+			return m_ptr;
+		}
+
+		const T& operator*() const {
+			return *get();
+		}
+		T& operator*() {
+			return *get();
+		}
+
+		const T* operator->() const {
+			return get();
+		}
+		T* operator->() {
+			return get();
+		}
+
+		std::size_t use_count() const {
+			return m_ptr ? intrusive_cow_use_count(static_cast<const T*>(m_ptr)) : 0;
+		}
+
+		bool unique() const {
+			return use_count() == 1;
+		}
+
+		operator bool() const {
+			return m_ptr != NULL;
+		}
+	};
+
+	template<typename T>
+	void swap(dp::intrusive_cow_ptr<T>& lhs, dp::intrusive_cow_ptr<T>& rhs) {
+		lhs.swap(rhs);
+	}
+
+	template<typename T>
+	dp::intrusive_cow_ptr<T> make_intrusive_cow() {
+		return dp::intrusive_cow_ptr<T>(new T);
+	}
+	template<typename T, typename U>
+	dp::intrusive_cow_ptr<T> make_intrusive_cow(const U& in) {
+		return dp::intrusive_cow_ptr<T>(new T(in));
+	}
+	template<typename T, typename U, typename V>
+	dp::intrusive_cow_ptr<T> make_intrusive_cow(const U& inU, const V& inV) {
+		return dp::intrusive_cow_ptr<T>(new T(inU, inV));
+	}
+	template<typename T, typename U, typename V, typename W>
+	dp::intrusive_cow_ptr<T> make_intrusive_cow(const U& inU, const V& inV, const W& inW) {
+		return dp::intrusive_cow_ptr<T>(new T(inU, inV, inW));
+	}
+	template<typename T, typename U, typename V, typename W, typename X>
+	dp::intrusive_cow_ptr<T> make_intrusive_cow(const U& inU, const V& inV, const W& inW, const X& inX) {
+		return dp::intrusive_cow_ptr<T>(new T(inU, inV, inW, inX));
+	}
+
+	template<typename T, typename U>
+	bool operator==(const dp::intrusive_cow_ptr<T>& lhs, const dp::intrusive_cow_ptr<U>& rhs) {
+		return lhs.get() == rhs.get();
+	}
+	template<typename T, typename U>
+	bool operator!=(const dp::intrusive_cow_ptr<T>& lhs, const dp::intrusive_cow_ptr<U>& rhs) {
+		return !(lhs == rhs);
+	}
+	template<typename T, typename U>
+	bool operator<(const dp::intrusive_cow_ptr<T>& lhs, const dp::intrusive_cow_ptr<U>& rhs) {
+		return lhs.get() < rhs.get();
+	}
+	template<typename T, typename U>
+	bool operator>(const dp::intrusive_cow_ptr<T>& lhs, const dp::intrusive_cow_ptr<U>& rhs) {
+		return rhs < lhs;
+	}
+	template<typename T, typename U>
+	bool operator>=(const dp::intrusive_cow_ptr<T>& lhs, const dp::intrusive_cow_ptr<U>& rhs) {
+		return !(lhs < rhs);
+	}
+	template<typename T, typename U>
+	bool operator<=(const dp::intrusive_cow_ptr<T>& lhs, const dp::intrusive_cow_ptr<U>& rhs) {
+		return !(rhs < lhs);
+	}
+
+	template<typename CharT, typename Traits, typename T>
+	std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const dp::intrusive_cow_ptr<T>& rhs) {
+		os << rhs.get();
+		return os;
+	}
+}
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef DP_CPP98_LAZY_COW_ARRAY
+#define DP_CPP98_LAZY_COW_ARRAY
+
+#include "cpp98/cow_ptr.h"
+#include "cpp98/type_traits.h"
+
+#include "bits/version_defs.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+/*
+*	A copy-on-write array which is filled with a single value, and which only allocates when it is first modified.
+*	make_cow<T[]>(N, u) allocates and fills all N elements up front. A lazy_cow_array instead holds only the fill value and the length
+*	until the first non-const access. Const reads of an unmaterialized array return the fill value without allocating.
+*	On materialization the elements are copy-constructed from the fill value directly into uninitialized storage, which for trivial
+*	types the standard library reduces to a single fill loop, rather than being default-constructed and then assigned one at a time.
+*
+*	This is a separate type rather than a mode of make_cow<T[]>, as a cow_ptr<T[]> has no room to hold a fill value. It works for any
+*	copyable T, including bool.
+*
+*	As with cow_ptr, non-const access detaches from any other copies, so reads should go through a const lazy_cow_array.
+*/
+
+namespace dp {
+
+	template<typename T>
+	class lazy_cow_array {
+
+		//The elements, in raw storage rather than a std::vector, as std::vector<bool> packs its bits and cannot hand out a bool& or bool*
+		class storage_type {
+			T* m_elements;
+			std::size_t m_size;
+
+			static T* allocate(std::size_t inSize) {
+#ifdef DP_CPP11_OR_HIGHER
+				static_assert(alignof(T) <= alignof(std::max_align_t), "lazy_cow_array storage comes from operator new, which does not support over-aligned types");
+#endif
+				if (inSize == 0) return NULL;
+				if (inSize > static_cast<std::size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+				return static_cast<T*>(::operator new(inSize * sizeof(T)));
+			}
+
+			//Not assignable, a detach copy-constructs a new buffer instead
+			storage_type& operator=(const storage_type&);
+
+		public:
+			storage_type(std::size_t inSize, const T& inFill) : m_elements(allocate(inSize)), m_size(inSize) {
+				try {
+					std::uninitialized_fill_n(m_elements, inSize, inFill);
+				}
+				catch (...) {
+					::operator delete(m_elements);
+					throw;
+				}
+			}
+			storage_type(const storage_type& other) : m_elements(allocate(other.m_size)), m_size(other.m_size) {
+				try {
+					std::uninitialized_copy(other.m_elements, other.m_elements + other.m_size, m_elements);
+				}
+				catch (...) {
+					::operator delete(m_elements);
+					throw;
+				}
+			}
+			~storage_type() {
+				for (std::size_t i = 0; i < m_size; ++i) m_elements[i].~T();
+				::operator delete(m_elements);
+			}
+
+			T* data() {
+				return m_elements;
+			}
+			const T* data() const {
+				return m_elements;
+			}
+		};
+
+		T m_fill;
+		std::size_t m_size;
+		dp::cow_ptr<storage_type> m_data;
+
+		void materialize() {
+			if (!m_data) m_data = dp::cow_ptr<storage_type>(new storage_type(m_size, m_fill));
+		}
+
+		const storage_type& read() const {
+			return *m_data;
+		}
+
+	public:
+		typedef T					value_type;
+		typedef std::size_t			size_type;
+		typedef T&					reference;
+		typedef const T&			const_reference;
+
+		lazy_cow_array() : m_fill(), m_size(0), m_data() {}
+		lazy_cow_array(std::size_t inSize, const T& inFill) : m_fill(inFill), m_size(inSize), m_data() {}
+
+		std::size_t size() const {
+			return m_size;
+		}
+		bool empty() const {
+			return m_size == 0;
+		}
+
+		//Whether the elements have been allocated yet
+		bool materialized() const {
+			return static_cast<bool>(m_data);
+		}
+
+		const T& fill_value() const {
+			return m_fill;
+		}
+
+		const T& operator[](std::size_t index) const {
+			return m_data ? this->read().data()[index] : m_fill;
+		}
+		T& operator[](std::size_t index) {
+			this->materialize();
+			return m_data->data()[index];
+		}
+
+		const T& at(std::size_t index) const {
+			if (index >= m_size) throw std::out_of_range("Index out of range in lazy_cow_array::at");
+			return (*this)[index];
+		}
+		T& at(std::size_t index) {
+			if (index >= m_size) throw std::out_of_range("Index out of range in lazy_cow_array::at");
+			return (*this)[index];
+		}
+
+		//Materializes the array, as the caller may write through the returned pointer
+		T* data() {
+			this->materialize();
+			return m_data->data();
+		}
+
+		//Refills every element with inFill. This releases any storage, so the array is lazy again.
+		void fill(const T& inFill) {
+			m_fill = inFill;
+			m_data.reset();
+		}
+
+		void swap(lazy_cow_array& other) {
+			using std::swap;
+			swap(m_fill, other.m_fill);
+			swap(m_size, other.m_size);
+			m_data.swap(other.m_data);
+		}
+	};
+
+	template<typename T>
+	void swap(dp::lazy_cow_array<T>& lhs, dp::lazy_cow_array<T>& rhs) {
+		lhs.swap(rhs);
+	}
+
+	template<typename T>
+	typename dp::enable_if<dp::is_unbounded_array<T>::value, dp::lazy_cow_array<typename dp::remove_extent<T>::type> >::type make_lazy_cow(std::size_t N, const typename dp::remove_extent<T>::type& u) {
+		return dp::lazy_cow_array<typename dp::remove_extent<T>::type>(N, u);
+	}
+
+	template<typename T>
+	typename dp::enable_if<dp::is_bounded_array<T>::value, dp::lazy_cow_array<typename dp::remove_extent<T>::type> >::type make_lazy_cow(const typename dp::remove_extent<T>::type& u) {
+		return dp::lazy_cow_array<typename dp::remove_extent<T>::type>(dp::extent<T>::value, u);
+	}
+
+}
+
+#endif
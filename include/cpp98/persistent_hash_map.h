@@ -0,0 +1,283 @@
+#ifndef DP_CPP98_PERSISTENT_HASH_MAP
+#define DP_CPP98_PERSISTENT_HASH_MAP
+
+#include "cpp98/cow_ptr.h"
+
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+*	A persistent hash map, implemented as a hash array mapped trie whose nodes are shared through cow_ptr.
+*	Each node consumes five bits of the hash. Rather than a sparse array of 32 slots, a node stores a bitmap of which slots hold an
+*	entry and which hold a subtree, and packs both densely; the position of a slot is the popcount of the bits below it.
+*	Copying a map is O(1). Insert, erase and update copy only the shared nodes on the path to the key, so every other version stays valid.
+*	As with persistent_vector, nodes which a map already owns are modified in place, so bulk loading into one version copies nothing.
+*/
+
+namespace dp {
+
+	namespace detail {
+		inline unsigned int popcount32(unsigned long in) {
+#if defined(__GNUC__)
+			return static_cast<unsigned int>(__builtin_popcountl(in & 0xFFFFFFFFUL));
+#else
+			in &= 0xFFFFFFFFUL;
+			in = in - ((in >> 1) & 0x55555555UL);
+			in = (in & 0x33333333UL) + ((in >> 2) & 0x33333333UL);
+			in = (in + (in >> 4)) & 0x0F0F0F0FUL;
+			return static_cast<unsigned int>(((in * 0x01010101UL) & 0xFFFFFFFFUL) >> 24);
+#endif
+		}
+	}
+
+
+	template<typename Key, typename T, typename Hash, typename KeyEqual = std::equal_to<Key> >
+	class persistent_hash_map {
+	public:
+		typedef Key						key_type;
+		typedef T						mapped_type;
+		typedef std::pair<Key, T>		value_type;
+		typedef Hash					hasher;
+		typedef KeyEqual				key_equal;
+
+	private:
+		static const std::size_t bits = 5;
+		static const std::size_t hash_bits = sizeof(std::size_t) * CHAR_BIT;
+
+		//Once the hash is exhausted, a node is a plain list of colliding entries in values
+		struct node {
+			unsigned long datamap;
+			unsigned long nodemap;
+			std::vector<value_type> values;
+			std::vector<dp::cow_ptr<node> > children;
+
+			node() : datamap(0), nodemap(0), values(), children() {}
+		};
+		typedef dp::cow_ptr<node> node_ptr;
+
+		node_ptr m_root;
+		std::size_t m_size;
+		Hash m_hash;
+		KeyEqual m_equal;
+
+		//Reading must always go through a const cow_ptr, otherwise we detach nodes we never meant to change
+		static const node& read(const node_ptr& in) {
+			return *in;
+		}
+		static node& write(node_ptr& in) {
+			return *in;
+		}
+
+		static unsigned long bit_for(std::size_t hash, std::size_t shift) {
+			return 1UL << ((hash >> shift) & 31);
+		}
+		static std::size_t index_of(unsigned long map, unsigned long bit) {
+			return dp::detail::popcount32(map & (bit - 1));
+		}
+
+		node_ptr make_pair_node(std::size_t shift, const value_type& first, std::size_t firstHash, const value_type& second, std::size_t secondHash) const {
+			node_ptr result(new node);
+			node& current = write(result);
+			if (shift >= hash_bits) {
+				current.values.push_back(first);
+				current.values.push_back(second);
+				return result;
+			}
+
+			const unsigned long firstBit = bit_for(firstHash, shift);
+			const unsigned long secondBit = bit_for(secondHash, shift);
+			if (firstBit == secondBit) {
+				current.children.push_back(make_pair_node(shift + bits, first, firstHash, second, secondHash));
+				current.nodemap = firstBit;
+			}
+			else {
+				current.datamap = firstBit | secondBit;
+				current.values.push_back(firstBit < secondBit ? first : second);
+				current.values.push_back(firstBit < secondBit ? second : first);
+			}
+			return result;
+		}
+
+		//Returns whether a new entry was added
+		bool insert_at(node_ptr& inPtr, std::size_t hash, std::size_t shift, const Key& inKey, const T& inValue) {
+			node& current = write(inPtr);
+			if (shift >= hash_bits) {
+				for (std::size_t i = 0; i < current.values.size(); ++i) {
+					if (m_equal(current.values[i].first, inKey)) {
+						current.values[i].second = inValue;
+						return false;
+					}
+				}
+				current.values.push_back(value_type(inKey, inValue));
+				return true;
+			}
+
+			const unsigned long bit = bit_for(hash, shift);
+			if (current.datamap & bit) {
+				const std::size_t index = index_of(current.datamap, bit);
+				if (m_equal(current.values[index].first, inKey)) {
+					current.values[index].second = inValue;
+					return false;
+				}
+				//Two different keys share this slot, so push them both down a level
+				node_ptr child = make_pair_node(shift + bits, current.values[index], m_hash(current.values[index].first), value_type(inKey, inValue), hash);
+				current.values.erase(current.values.begin() + index);
+				current.datamap ^= bit;
+				current.children.insert(current.children.begin() + index_of(current.nodemap, bit), child);
+				current.nodemap |= bit;
+				return true;
+			}
+			if (current.nodemap & bit) {
+				return insert_at(current.children[index_of(current.nodemap, bit)], hash, shift + bits, inKey, inValue);
+			}
+			current.values.insert(current.values.begin() + index_of(current.datamap, bit), value_type(inKey, inValue));
+			current.datamap |= bit;
+			return true;
+		}
+
+		//The key must be present, so that we never detach a path only to find nothing to erase
+		void erase_at(node_ptr& inPtr, std::size_t hash, std::size_t shift, const Key& inKey) {
+			node& current = write(inPtr);
+			if (shift >= hash_bits) {
+				for (std::size_t i = 0; i < current.values.size(); ++i) {
+					if (m_equal(current.values[i].first, inKey)) {
+						current.values.erase(current.values.begin() + i);
+						return;
+					}
+				}
+				return;
+			}
+
+			const unsigned long bit = bit_for(hash, shift);
+			if (current.datamap & bit) {
+				current.values.erase(current.values.begin() + index_of(current.datamap, bit));
+				current.datamap ^= bit;
+				return;
+			}
+
+			const std::size_t childIndex = index_of(current.nodemap, bit);
+			erase_at(current.children[childIndex], hash, shift + bits, inKey);
+
+			//A subtree left holding a single entry is pulled back up into this node, to keep the trie canonical
+			const node& child = read(current.children[childIndex]);
+			if (child.children.empty() && child.values.size() == 1) {
+				value_type last = child.values[0];
+				current.children.erase(current.children.begin() + childIndex);
+				current.nodemap ^= bit;
+				current.values.insert(current.values.begin() + index_of(current.datamap, bit), last);
+				current.datamap |= bit;
+			}
+		}
+
+		template<typename F>
+		static void visit(const node& current, F& func) {
+			for (std::size_t i = 0; i < current.values.size(); ++i) func(current.values[i]);
+			for (std::size_t i = 0; i < current.children.size(); ++i) visit(read(current.children[i]), func);
+		}
+
+	public:
+
+		explicit persistent_hash_map(const Hash& inHash = Hash(), const KeyEqual& inEqual = KeyEqual()) : m_root(), m_size(0), m_hash(inHash), m_equal(inEqual) {}
+
+		std::size_t size() const {
+			return m_size;
+		}
+		bool empty() const {
+			return m_size == 0;
+		}
+
+		//Returns a pointer to the value mapped to inKey, or NULL if there is none
+		const T* find(const Key& inKey) const {
+			if (!m_root) return NULL;
+			const std::size_t hash = m_hash(inKey);
+			const node* current = &read(m_root);
+			for (std::size_t shift = 0;; shift += bits) {
+				if (shift >= hash_bits) {
+					for (std::size_t i = 0; i < current->values.size(); ++i) {
+						if (m_equal(current->values[i].first, inKey)) return &current->values[i].second;
+					}
+					return NULL;
+				}
+
+				const unsigned long bit = bit_for(hash, shift);
+				if (current->datamap & bit) {
+					const value_type& entry = current->values[index_of(current->datamap, bit)];
+					return m_equal(entry.first, inKey) ? &entry.second : NULL;
+				}
+				if (!(current->nodemap & bit)) return NULL;
+				current = &read(current->children[index_of(current->nodemap, bit)]);
+			}
+		}
+
+		std::size_t count(const Key& inKey) const {
+			return this->find(inKey) ? 1 : 0;
+		}
+
+		const T& at(const Key& inKey) const {
+			const T* result = this->find(inKey);
+			if (!result) throw std::out_of_range("Key not found in persistent_hash_map::at");
+			return *result;
+		}
+
+		//Returns true if the key was newly inserted, false if an existing value was replaced
+		bool insert_or_assign(const Key& inKey, const T& inValue) {
+			if (!m_root) m_root = node_ptr(new node);
+			const bool inserted = insert_at(m_root, m_hash(inKey), 0, inKey, inValue);
+			if (inserted) ++m_size;
+			return inserted;
+		}
+
+		//Leaves any existing value alone. Returns whether the key was inserted.
+		bool insert(const Key& inKey, const T& inValue) {
+			if (this->find(inKey)) return false;
+			return this->insert_or_assign(inKey, inValue);
+		}
+		bool insert(const value_type& inValue) {
+			return this->insert(inValue.first, inValue.second);
+		}
+
+		template<typename InputIt>
+		void insert(InputIt first, InputIt last) {
+			for (; first != last; ++first) this->insert(first->first, first->second);
+		}
+
+		std::size_t erase(const Key& inKey) {
+			if (!this->find(inKey)) return 0;
+			erase_at(m_root, m_hash(inKey), 0, inKey);
+			if (--m_size == 0) m_root.reset();
+			return 1;
+		}
+
+		//Calls func with every entry, in an unspecified order
+		template<typename F>
+		F for_each(F func) const {
+			if (m_root) visit(read(m_root), func);
+			return func;
+		}
+
+		void clear() {
+			m_root.reset();
+			m_size = 0;
+		}
+
+		void swap(persistent_hash_map& other) {
+			using std::swap;
+			m_root.swap(other.m_root);
+			swap(m_size, other.m_size);
+			swap(m_hash, other.m_hash);
+			swap(m_equal, other.m_equal);
+		}
+	};
+
+	template<typename Key, typename T, typename Hash, typename KeyEqual>
+	void swap(dp::persistent_hash_map<Key, T, Hash, KeyEqual>& lhs, dp::persistent_hash_map<Key, T, Hash, KeyEqual>& rhs) {
+		lhs.swap(rhs);
+	}
+
+}
+
+#endif
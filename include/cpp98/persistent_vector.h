@@ -0,0 +1,264 @@
+#ifndef DP_CPP98_PERSISTENT_VECTOR
+#define DP_CPP98_PERSISTENT_VECTOR
+
+#include "cpp98/cow_ptr.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+/*
+*	A persistent vector. A 32-way trie whose nodes are held by cow_ptr, so copying a vector is O(1) and the copies share every node.
+*	Modifying a vector goes through cow_ptr's non-const access on the path to the element, so only the O(log n) nodes on that path
+*	which are still shared get copied. Every other version of the vector is left untouched and remains valid.
+*
+*	Nodes which a vector already owns outright are modified in place. A batch of edits to the same version therefore copies each
+*	node at most once, just like a transient in other persistent vector implementations, without needing a separate type.
+*/
+
+namespace dp {
+
+	template<typename T>
+	class persistent_vector {
+
+		static const std::size_t bits = 5;
+		static const std::size_t branching = std::size_t(1) << bits;
+		static const std::size_t mask = branching - 1;
+
+		//Leaves only use values, branches only use children
+		struct node {
+			std::vector<dp::cow_ptr<node> > children;
+			std::vector<T> values;
+		};
+		typedef dp::cow_ptr<node> node_ptr;
+
+		node_ptr m_root;
+		std::size_t m_size;
+		std::size_t m_shift;
+
+		//Pre-C++11 nested classes don't automatically get access to our privates
+	public:
+		class const_iterator;
+	private:
+		friend class const_iterator;
+
+		//Reading must always go through a const cow_ptr, otherwise we detach nodes we never meant to change
+		static const node& read(const node_ptr& in) {
+			return *in;
+		}
+		static node& write(node_ptr& in) {
+			return *in;
+		}
+
+		std::size_t capacity() const {
+			return std::size_t(1) << (m_shift + bits);
+		}
+
+		const node& leaf_for(std::size_t index) const {
+			const node* current = &read(m_root);
+			for (std::size_t shift = m_shift; shift > 0; shift -= bits) {
+				current = &read(current->children[(index >> shift) & mask]);
+			}
+			return *current;
+		}
+
+		//Returns whether the node at inPtr is now empty
+		static bool pop_from(node_ptr& inPtr, std::size_t shift, std::size_t index) {
+			node& current = write(inPtr);
+			if (shift == 0) {
+				current.values.pop_back();
+				return current.values.empty();
+			}
+			if (pop_from(current.children[(index >> shift) & mask], shift - bits, index)) current.children.pop_back();
+			return current.children.empty();
+		}
+
+		template<bool B>
+		struct is_integer_tag {};
+
+		template<typename Integer>
+		void construct(Integer inCount, Integer inValue, is_integer_tag<true>) {
+			for (Integer i = 0; i < inCount; ++i) this->push_back(static_cast<T>(inValue));
+		}
+		template<typename InputIt>
+		void construct(InputIt first, InputIt last, is_integer_tag<false>) {
+			for (; first != last; ++first) this->push_back(*first);
+		}
+
+	public:
+
+		typedef T					value_type;
+		typedef std::size_t			size_type;
+		typedef std::ptrdiff_t		difference_type;
+		typedef const T&			const_reference;
+
+		class const_iterator {
+			const persistent_vector* m_vec;
+			std::size_t m_index;
+			const node* m_leaf;
+
+			friend class persistent_vector;
+
+			const_iterator(const persistent_vector* inVec, std::size_t inIndex) : m_vec(inVec), m_index(inIndex), m_leaf(NULL) {
+				if (m_index < m_vec->size()) m_leaf = &m_vec->leaf_for(m_index);
+			}
+
+		public:
+			typedef std::forward_iterator_tag	iterator_category;
+			typedef T							value_type;
+			typedef std::ptrdiff_t				difference_type;
+			typedef const T*					pointer;
+			typedef const T&					reference;
+
+			const_iterator() : m_vec(NULL), m_index(0), m_leaf(NULL) {}
+
+			reference operator*() const {
+				return m_leaf->values[m_index & mask];
+			}
+			pointer operator->() const {
+				return &**this;
+			}
+
+			//Only walk the trie again when we step off the end of the current leaf
+			const_iterator& operator++() {
+				++m_index;
+				if ((m_index & mask) == 0) m_leaf = m_index < m_vec->size() ? &m_vec->leaf_for(m_index) : NULL;
+				return *this;
+			}
+			const_iterator operator++(int) {
+				const_iterator temp(*this);
+				++*this;
+				return temp;
+			}
+
+			friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) {
+				return lhs.m_index == rhs.m_index && lhs.m_vec == rhs.m_vec;
+			}
+			friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) {
+				return !(lhs == rhs);
+			}
+		};
+		typedef const_iterator iterator;
+
+		persistent_vector() : m_root(), m_size(0), m_shift(0) {}
+
+		persistent_vector(std::size_t inCount, const T& inValue) : m_root(), m_size(0), m_shift(0) {
+			for (std::size_t i = 0; i < inCount; ++i) this->push_back(inValue);
+		}
+
+		template<typename InputIt>
+		persistent_vector(InputIt first, InputIt last) : m_root(), m_size(0), m_shift(0) {
+			//Two integers are a count and a value, as with std::vector
+			this->construct(first, last, is_integer_tag<std::numeric_limits<InputIt>::is_integer>());
+		}
+
+		std::size_t size() const {
+			return m_size;
+		}
+		bool empty() const {
+			return m_size == 0;
+		}
+
+		const T& operator[](std::size_t index) const {
+			return leaf_for(index).values[index & mask];
+		}
+		const T& at(std::size_t index) const {
+			if (index >= m_size) throw std::out_of_range("Index out of range in persistent_vector::at");
+			return (*this)[index];
+		}
+		const T& front() const {
+			return (*this)[0];
+		}
+		const T& back() const {
+			return (*this)[m_size - 1];
+		}
+
+		const_iterator begin() const {
+			return const_iterator(this, 0);
+		}
+		const_iterator end() const {
+			return const_iterator(this, m_size);
+		}
+
+		void set(std::size_t index, const T& inValue) {
+			if (index >= m_size) throw std::out_of_range("Index out of range in persistent_vector::set");
+			node_ptr* current = &m_root;
+			for (std::size_t shift = m_shift; shift > 0; shift -= bits) {
+				current = &write(*current).children[(index >> shift) & mask];
+			}
+			write(*current).values[index & mask] = inValue;
+		}
+
+		void push_back(const T& inValue) {
+			if (!m_root) {
+				m_root = node_ptr(new node);
+			}
+			else if (m_size == this->capacity()) {
+				node_ptr newRoot(new node);
+				write(newRoot).children.push_back(m_root);
+				m_root = newRoot;
+				m_shift += bits;
+			}
+
+			node_ptr* current = &m_root;
+			for (std::size_t shift = m_shift; shift > 0; shift -= bits) {
+				node& branch = write(*current);
+				const std::size_t index = (m_size >> shift) & mask;
+				if (index == branch.children.size()) branch.children.push_back(node_ptr(new node));
+				current = &branch.children[index];
+			}
+			write(*current).values.push_back(inValue);
+			++m_size;
+		}
+
+		void pop_back() {
+			if (m_size == 0) throw std::out_of_range("pop_back called on empty persistent_vector");
+			if (m_size == 1) {
+				this->clear();
+				return;
+			}
+			pop_from(m_root, m_shift, m_size - 1);
+			--m_size;
+
+			//Drop any levels we no longer need
+			while (m_shift > 0 && read(m_root).children.size() == 1) {
+				node_ptr onlyChild = read(m_root).children[0];
+				m_root = onlyChild;
+				m_shift -= bits;
+			}
+		}
+
+		void clear() {
+			m_root.reset();
+			m_size = 0;
+			m_shift = 0;
+		}
+
+		void swap(persistent_vector& other) {
+			using std::swap;
+			m_root.swap(other.m_root);
+			swap(m_size, other.m_size);
+			swap(m_shift, other.m_shift);
+		}
+	};
+
+	template<typename T>
+	void swap(dp::persistent_vector<T>& lhs, dp::persistent_vector<T>& rhs) {
+		lhs.swap(rhs);
+	}
+
+	template<typename T>
+	bool operator==(const dp::persistent_vector<T>& lhs, const dp::persistent_vector<T>& rhs) {
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+	template<typename T>
+	bool operator!=(const dp::persistent_vector<T>& lhs, const dp::persistent_vector<T>& rhs) {
+		return !(lhs == rhs);
+	}
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef DP_CPP98_POLY_TYPE_REGISTRY
+#define DP_CPP98_POLY_TYPE_REGISTRY
+
+#include "cpp98/poly_value_ptr.h"
+
+#include <climits>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+/*
+*	Binary serialization for poly_value_ptr, through a registry of the derived types which may be held.
+*	Each registered type is given a small integer tag, in order of registration, and the registry maps the poly_value_ptr's own type
+*	identity to that tag. There are no virtual calls, dynamic_casts or type names involved. An encoded value is its tag as a varint,
+*	followed by whatever the type's codec writes; tag 0 means an empty pointer.
+*	Decoding looks up the tag in a table and has the codec construct the derived type directly, which is then handed to the destination.
+*
+*	The codec for a type is a specialization of poly_codec, which must provide
+*		static void encode(const Derived&, std::vector<unsigned char>&);
+*		static Derived* decode(const unsigned char*& cursor, const unsigned char* end);
+*	where decode advances the cursor past what it read and returns a newly allocated object.
+*	Tags depend on registration order, so both sides must register the same types in the same order.
+*	Types are registered by poly_value_ptr's type identity, which may differ for the same type on either side of a shared library
+*	boundary. A type registered in one library may then be unknown to tag_of for pointers created in another.
+*/
+
+namespace dp {
+
+	template<typename T>
+	struct poly_codec;
+
+	inline void write_varint(std::size_t in, std::vector<unsigned char>& out) {
+		while (in >= 0x80) {
+			out.push_back(static_cast<unsigned char>(in | 0x80));
+			in >>= 7;
+		}
+		out.push_back(static_cast<unsigned char>(in));
+	}
+
+	inline std::size_t read_varint(const unsigned char*& cursor, const unsigned char* end) {
+		std::size_t result = 0;
+		for (std::size_t shift = 0; cursor != end && shift < sizeof(std::size_t) * CHAR_BIT; shift += 7) {
+			const unsigned char byte = *cursor++;
+			result |= static_cast<std::size_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) return result;
+		}
+		throw std::runtime_error("Truncated or overlong varint in read_varint");
+	}
+
+
+	template<typename Base>
+	class poly_type_registry {
+	public:
+		typedef dp::poly_value_ptr<Base>				pointer_type;
+		typedef typename pointer_type::type_id			type_id;
+
+	private:
+		struct entry {
+			void (*encode)(const Base&, std::vector<unsigned char>&);
+			void (*decode)(const unsigned char*&, const unsigned char*, pointer_type&);
+		};
+
+		template<typename Derived>
+		static void encode_as(const Base& in, std::vector<unsigned char>& out) {
+			dp::poly_codec<Derived>::encode(static_cast<const Derived&>(in), out);
+		}
+
+		template<typename Derived>
+		static void decode_as(const unsigned char*& cursor, const unsigned char* end, pointer_type& out) {
+			pointer_type decoded(dp::poly_t<Derived>(), dp::poly_codec<Derived>::decode(cursor, end));
+			out.swap(decoded);
+		}
+
+		//Indexed by tag - 1
+		std::vector<entry> m_entries;
+		std::map<type_id, std::size_t> m_tags;
+
+	public:
+		poly_type_registry() : m_entries(), m_tags() {}
+
+		//Registers Derived, if it is not registered already, and returns its tag
+		template<typename Derived>
+		std::size_t register_type() {
+			const type_id id = pointer_type::template type_id_of<Derived>();
+			typename std::map<type_id, std::size_t>::const_iterator it = m_tags.find(id);
+			if (it != m_tags.end()) return it->second;
+
+			entry newEntry = { &encode_as<Derived>, &decode_as<Derived> };
+			m_entries.push_back(newEntry);
+			m_tags[id] = m_entries.size();
+			return m_entries.size();
+		}
+
+		//The tag of in's dynamic type, or 0 if in is empty. Throws if the type was never registered.
+		std::size_t tag_of(const pointer_type& in) const {
+			const type_id id = in.dynamic_type();
+			if (!id) return 0;
+			typename std::map<type_id, std::size_t>::const_iterator it = m_tags.find(id);
+			if (it == m_tags.end()) throw std::invalid_argument("Type not registered in poly_type_registry");
+			return it->second;
+		}
+
+		std::size_t size() const {
+			return m_entries.size();
+		}
+
+		void encode(const pointer_type& in, std::vector<unsigned char>& out) const {
+			const std::size_t tag = this->tag_of(in);
+			dp::write_varint(tag, out);
+			if (tag != 0) m_entries[tag - 1].encode(*in, out);
+		}
+
+		//Decodes one value from cursor into out, replacing whatever out held, and advances cursor past it
+		void decode(const unsigned char*& cursor, const unsigned char* end, pointer_type& out) const {
+			const std::size_t tag = dp::read_varint(cursor, end);
+			if (tag == 0) {
+				out.reset();
+				return;
+			}
+			if (tag > m_entries.size()) throw std::runtime_error("Unknown type tag in poly_type_registry::decode");
+			m_entries[tag - 1].decode(cursor, end, out);
+		}
+
+		//Encodes a count followed by every element of the range
+		template<typename ForwardIt>
+		void encode_range(ForwardIt first, ForwardIt last, std::vector<unsigned char>& out) const {
+			std::size_t count = 0;
+			for (ForwardIt it = first; it != last; ++it) ++count;
+			dp::write_varint(count, out);
+			for (; first != last; ++first) this->encode(*first, out);
+		}
+
+		//Decodes a range written by encode_range, appending each element to out. The range is decoded into a temporary first, so if
+		//any element fails to decode, out and cursor are left as they were.
+		template<typename Container>
+		void decode_range(const unsigned char*& cursor, const unsigned char* end, Container& out) const {
+			const unsigned char* position = cursor;
+			const std::size_t count = dp::read_varint(position, end);
+			Container decoded(count);
+			for (typename Container::iterator it = decoded.begin(); it != decoded.end(); ++it) this->decode(position, end, *it);
+
+			const std::size_t first = out.size();
+			out.resize(first + count);
+			typename Container::iterator it = out.begin();
+			std::advance(it, first);
+			for (typename Container::iterator from = decoded.begin(); from != decoded.end(); ++from, ++it) it->swap(*from);
+			cursor = position;
+		}
+	};
+
+}
+
+#endif
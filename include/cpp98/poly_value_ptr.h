@@ -2,17 +2,32 @@
 #define DP_CPP98_POLY_VALUE_PTR
 
 #include <algorithm>
+#include <cstddef>
+#include <stdexcept>
 #include "bits/smart_ptr_bases.h"
 #include "cpp98/static_assert.h"
 #include "bits/version_defs.h"
 #include "cpp98/type_traits.h"
 #include "bits/type_traits_ns.h"
+#ifdef DP_CPP11_OR_HIGHER
+#include <type_traits>
+#endif
+#ifdef DP_CLONE_CONTEXT
+#include "cpp98/clone_context.h"
+#endif
 
 
 /*
 *	A polymorphic value pointer. A smart pointer which confers value semantics for its held object, but which is aware of polymorphism and will correctly copy
 *	the dynamic type of the held object rather than the static type.
 *	This is a separate class as the type erasure required would add unnecessary overhead for the most common uses (val_ptr)* 
+*
+*	The pointer is two pointers wide: the held T* and a table of operations for the held type. Copying and destroying need the
+*	address of the complete object, which for a polymorphic T is found through dynamic_cast<void*>. That needs no RTTI on GCC and
+*	Clang, but MSVC requires /GR. A T which is not polymorphic must be the first subobject of the held type, and the pointer throws
+*	std::invalid_argument rather than hold one which is not.
+*	The identity of a held type is the address of its table. A program which shares pointers across shared library boundaries can
+*	end up with one table per library, so the same type may not compare equal there, as with typeid on some platforms.
 */
 
 namespace dp {
@@ -34,61 +49,139 @@ namespace dp {
 	template<typename T>
 	struct poly_t {};
 
+	namespace detail {
+		//The operations a poly_value_ptr needs on its held object, which work on the address of the complete object so that they
+		//do not depend on the pointer's static type
+		struct poly_value_ops {
+			void* (*clone)(const void*);
+			void (*destroy)(void*);
+		};
 
-	template<typename T, typename dp::enable_if<dp::is_value_type<T>::value, bool>::type = true>
-	class poly_value_ptr {
-
+		template<typename U>
+		struct poly_value_ops_for {
+			static void* clone(const void* in) {
+				const U* source = static_cast<const U*>(in);
+				U* newObj = new U(*source);
+#ifdef DP_CLONE_CONTEXT
+				dp::clone_context::record(source, newObj);
+#endif
+				return newObj;
+			}
+			static void destroy(void* in) {
+				dp::default_delete<U>()(static_cast<U*>(in));
+			}
 
-		//For the type erasure we mimic a fairly typical std::any implementation by storing a pointer to a templated manager function
-		//which both encodes the type and allows us to perform real-type-aware operations
-		struct op {
-			enum type {
-				clone,
-				destroy
-			};
+			//Not const, so that the linker can never fold the tables of two types with identical code into one object
+			static poly_value_ops table;
 		};
-
 		template<typename U>
-		struct manager {
-			static T* manage(typename op::type inOp, const dp::poly_value_ptr<T>* inPtr) {
-				const U* dynamic_ptr = static_cast<const U*>(inPtr->get());
-				switch (inOp) {
-				case op::clone:
-					if (dynamic_ptr) {
-						U* newObj = new U(*dynamic_ptr);
-						return static_cast<T*>(newObj);
-					}
-					return NULL;
-				case op::destroy:
-					dp::default_delete<U>()(const_cast<U*>(dynamic_ptr));
-					return NULL;
-				}
+		dp::detail::poly_value_ops dp::detail::poly_value_ops_for<U>::table = { &poly_value_ops_for<U>::clone, &poly_value_ops_for<U>::destroy };
+
+		template<typename T>
+		struct poly_is_polymorphic {
+#if defined(DP_CPP11_OR_HIGHER)
+			static const bool value = std::is_polymorphic<T>::value;
+#elif defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+			static const bool value = __is_polymorphic(T);
+#else
+			//Without a way to tell, T is treated as non-polymorphic, which is still checked at run time
+			static const bool value = false;
+#endif
+		};
+
+		//The address of the complete object of which in is a subobject
+		template<typename T, bool = dp::detail::poly_is_polymorphic<T>::value>
+		struct poly_complete_object {
+			static const void* of(const T* in) {
+				return dynamic_cast<const void*>(in);
 			}
 		};
+		template<typename T>
+		struct poly_complete_object<T, false> {
+			static const void* of(const T* in) {
+				return in;
+			}
+		};
+	}
 
-		typedef T*(*manager_type)(typename op::type, const dp::poly_value_ptr<T>*);
-		manager_type m_manager;
 
+	template<typename T, typename dp::enable_if<dp::is_value_type<T>::value, bool>::type = true>
+	class poly_value_ptr {
+
+		template<typename U, typename dp::enable_if<dp::is_value_type<U>::value, bool>::type>
+		friend class poly_value_ptr;
+
+		//For the type erasure we mimic a fairly typical std::any implementation, but with a table of operations per held type rather
+		//than a manager function per held type and pointer type. The operations take the address of the complete object, which
+		//we find from the T* when we need it, so a pointer converted to one of the object's bases can still copy and destroy the
+		//whole object.
+		dp::detail::poly_value_ops* m_ops;
 		T* m_data;
 
+		static void* complete_object(const T* in) {
+			return const_cast<void*>(dp::detail::poly_complete_object<T>::of(in));
+		}
+
+		//Only a polymorphic T can be found at any offset in the complete object
+		static bool representable(const void* inObject, const T* inData) {
+			return dp::detail::poly_is_polymorphic<T>::value || static_cast<const void*>(inData) == inObject;
+		}
+
+		//Adopts a copy of the object held by inOps, where inData is the address of that object's T
+		void clone_from(dp::detail::poly_value_ops* inOps, const T* inData) {
+			if (!inOps || !inData) return;
+			const void* object = dp::detail::poly_complete_object<T>::of(inData);
+			const std::ptrdiff_t offset = reinterpret_cast<const char*>(inData) - static_cast<const char*>(object);
+			if (!representable(object, inData)) throw std::invalid_argument("poly_value_ptr of a non-polymorphic type must point to the start of the held object");
+			void* newObject = inOps->clone(object);
+			m_ops = inOps;
+			m_data = reinterpret_cast<T*>(static_cast<char*>(newObject) + offset);
+		}
+
+		//Takes ownership of inObject, whose T is at inData, or deletes it and throws if it cannot be held
+		template<typename U>
+		void adopt(U* inObject, T* inData) {
+			if (!representable(inObject, inData)) {
+				dp::detail::poly_value_ops_for<U>::destroy(inObject);
+				throw std::invalid_argument("poly_value_ptr of a non-polymorphic type must point to the start of the held object");
+			}
+			m_ops = inObject ? &dp::detail::poly_value_ops_for<U>::table : NULL;
+			m_data = inData;
+		}
 
 	public:
-		poly_value_ptr() : m_manager(NULL), m_data(NULL) {}
+		//An identity for the dynamic type of the held object, as used by poly_type_registry. Each held type has exactly one: the
+		//address of its own table of operations, which is never shared with another type.
+		typedef const void* type_id;
+
+		template<typename U>
+		static type_id type_id_of() {
+			return &dp::detail::poly_value_ops_for<U>::table;
+		}
+
+		poly_value_ptr() : m_ops(NULL), m_data(NULL) {}
 
 		//We pass a poly_t first to account for the dynamic type. Otherwise we're in slicing hell.
 		template<typename Held_Type, typename Ptr_Type>
 		poly_value_ptr(dp::poly_t<Held_Type>, Ptr_Type* inPtr, typename dp::enable_if<dp::detail::valid_poly_ptr_type<T, Held_Type>::value && dp::detail::valid_poly_ptr_type<T, Ptr_Type>::value, bool>::type = true) 
-					: m_manager(&manager<Held_Type>::manage), m_data(static_cast<T*>(inPtr)) {}
+					: m_ops(NULL), m_data(NULL) {
+			this->adopt(static_cast<Held_Type*>(inPtr), static_cast<T*>(inPtr));
+		}
 
-		poly_value_ptr(const poly_value_ptr& inPtr) : m_manager(inPtr.m_manager), m_data(m_manager(op::clone, &inPtr)) {}
+		poly_value_ptr(const poly_value_ptr& inPtr) : m_ops(NULL), m_data(NULL) {
+			this->clone_from(inPtr.m_ops, inPtr.m_data);
+		}
 		poly_value_ptr& operator=(const poly_value_ptr& inPtr) {
 			poly_value_ptr copy(inPtr);
 			this->swap(copy);
 			return *this;
 		}
 
+		//Copies the object's dynamic type, whatever U it is seen as in the source
 		template<typename U>
-		poly_value_ptr(const poly_value_ptr<U>& inPtr, typename dp::enable_if<dp::detail::valid_poly_ptr_type<T, U>::value, bool>::type = true) : m_manager(&manager<U>::manage), m_data(m_manager(op::clone, &inPtr)) {}
+		poly_value_ptr(const poly_value_ptr<U>& inPtr, typename dp::enable_if<dp::detail::valid_poly_ptr_type<T, U>::value, bool>::type = true) : m_ops(NULL), m_data(NULL) {
+			this->clone_from(inPtr.m_ops, static_cast<const T*>(inPtr.m_data));
+		}
 		template<typename U>
 		typename dp::enable_if<dp::detail::valid_poly_ptr_type<T, U>::value, poly_value_ptr&>::type operator=(const poly_value_ptr<U>& inPtr) {
 			poly_value_ptr<T> copy(inPtr);
@@ -97,26 +190,27 @@ namespace dp {
 		}
 
 #ifdef __cpp_rvalue_references
-		poly_value_ptr(poly_value_ptr&& inPtr) : m_manager(inPtr.m_manager), m_data(inPtr.m_data) {
-			inPtr.m_data = NULL;
+		poly_value_ptr(poly_value_ptr&& inPtr) : m_ops(inPtr.m_ops), m_data(inPtr.m_data) {
+			inPtr.release();
 		}
 		poly_value_ptr& operator=(poly_value_ptr&& inPtr) {
-			this->reset();
-			m_manager = inPtr.m_manager;
-			m_data = inPtr.m_data;
-			inPtr.m_data = NULL;
+			poly_value_ptr moved(static_cast<poly_value_ptr&&>(inPtr));
+			this->swap(moved);
 			return *this;
 		}
 		template<typename U>
-		poly_value_ptr(poly_value_ptr<U>&& inPtr, typename dp::enable_if<dp::detail::valid_poly_ptr_type<T, U>::value, bool>::type = true) : m_manager(inPtr.m_manager), m_data(inPtr.m_data) {
-			inPtr.m_data = NULL;
+		poly_value_ptr(poly_value_ptr<U>&& inPtr, typename dp::enable_if<dp::detail::valid_poly_ptr_type<T, U>::value, bool>::type = true) : m_ops(NULL), m_data(NULL) {
+			if (!representable(dp::detail::poly_complete_object<U>::of(inPtr.m_data), inPtr.m_data)) {
+				throw std::invalid_argument("poly_value_ptr of a non-polymorphic type must point to the start of the held object");
+			}
+			m_ops = inPtr.m_ops;
+			m_data = inPtr.m_data;
+			inPtr.release();
 		}
 		template<typename U>
 		typename dp::enable_if<dp::detail::valid_poly_ptr_type<T, U>::value, poly_value_ptr&>::type operator=(poly_value_ptr<U>&& inPtr) {
-			this->reset();
-			m_manager = inPtr.m_manager;
-			m_data = inPtr.m_data;
-			inPtr.m_data = NULL;
+			poly_value_ptr moved(static_cast<poly_value_ptr<U>&&>(inPtr));
+			this->swap(moved);
 			return *this;
 		}
 #endif
@@ -134,35 +228,32 @@ namespace dp {
 		void swap(poly_value_ptr& other) {
 			using std::swap;
 			swap(m_data, other.m_data);
-			swap(m_manager, other.m_manager);
+			swap(m_ops, other.m_ops);
 		}
 
 		T* release() {
 			T* temp = m_data;
+			m_ops = NULL;
 			m_data = NULL;
-			m_manager = NULL;
 			return temp;
 		}
 
 		void reset() {
-			m_manager(op::destroy, this);
-			m_manager = NULL;
+			if (m_ops && m_data) m_ops->destroy(complete_object(m_data));
+			m_ops = NULL;
 			m_data = NULL;
 		}
 
+		//Takes ownership of in, whose dynamic type is taken to be exactly T
 		void reset(T* in) {
-			if (m_data != in) {
-				m_manager(op::destroy, this);
-				m_data = in;
-			}
+			this->template reset<T>(in);
 		}
 
 		template<typename U>
 		void reset(U* in) {
 			if (m_data != in) {
-				m_manager(op::destroy, this);
-				m_manager = &manager<U>::manage;
-				m_data = in;
+				this->reset();
+				this->adopt(in, in);
 			}
 		}
 
@@ -170,6 +261,11 @@ namespace dp {
 			return m_data;
 		}
 
+		//The identity of the held object's dynamic type, or NULL if there is no held object
+		type_id dynamic_type() const {
+			return m_data ? m_ops : NULL;
+		}
+
 		const T& operator*() const {
 			STATIC_ASSERT(!dp::is_array<T>::value);
 			return *m_data;
@@ -210,7 +306,7 @@ namespace dp {
 	//We also provide a quick and easy static and dynamic cast overload
 	template<typename U, typename T>
 	U* static_ptr_cast(const dp::poly_value_ptr<T>& in) {
-		STATIC_ASSERT((dp::detail::valid_poly_ptr_type<T, U>::value || dp::is_same<U, void>));
+		STATIC_ASSERT((dp::detail::valid_poly_ptr_type<T, U>::value || dp::is_same<U, void>::value));
 		return static_cast<U*>(const_cast<T*>(in.get()));
 	}
 	template<typename U, typename T>
@@ -0,0 +1,333 @@
+#ifndef DP_CPP98_ROPE
+#define DP_CPP98_ROPE
+
+#include "cpp98/cow_ptr.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+*	A persistent rope for editing large text. The text is held in leaves of at most max_leaf characters, under a height-balanced (AVL)
+*	tree of concatenation nodes. Every node is shared between versions through cow_ptr and is never modified after it is built, so
+*	copying a rope is O(1) and every old version remains valid.
+*	Insert, erase, append and substr are built from split and join, each of which is O(log n) and builds only the nodes along one path.
+*	Joining rebalances as it goes, so the tree never needs a separate rebalancing pass.
+*/
+
+namespace dp {
+
+	template<typename CharT, typename Traits = std::char_traits<CharT> >
+	class basic_rope {
+	public:
+		typedef std::basic_string<CharT, Traits>	string_type;
+		typedef CharT								value_type;
+		typedef std::size_t							size_type;
+
+		static const std::size_t max_leaf = 512;
+
+	private:
+		//Leaves only use text, branches only use left and right
+		struct node {
+			dp::cow_ptr<node> left;
+			dp::cow_ptr<node> right;
+			string_type text;
+			std::size_t length;
+			std::size_t height;
+		};
+		typedef dp::cow_ptr<node> node_ptr;
+		typedef std::pair<node_ptr, node_ptr> node_pair;
+
+		node_ptr m_root;
+
+		explicit basic_rope(const node_ptr& inRoot) : m_root(inRoot) {}
+
+		//Nodes are immutable once built, so they are only ever read through a const cow_ptr
+		static const node& read(const node_ptr& in) {
+			return *in;
+		}
+		static std::size_t length_of(const node_ptr& in) {
+			return in ? read(in).length : 0;
+		}
+		static std::size_t height_of(const node_ptr& in) {
+			return in ? read(in).height : 0;
+		}
+		static bool is_leaf(const node_ptr& in) {
+			return height_of(in) == 0;
+		}
+
+		static node_ptr make_leaf(const CharT* inData, std::size_t inLength) {
+			if (inLength == 0) return node_ptr();
+			node* newNode = new node;
+			newNode->text.assign(inData, inLength);
+			newNode->length = inLength;
+			newNode->height = 0;
+			return node_ptr(newNode);
+		}
+
+		static node_ptr make_branch(const node_ptr& inLeft, const node_ptr& inRight) {
+			node* newNode = new node;
+			newNode->left = inLeft;
+			newNode->right = inRight;
+			newNode->length = length_of(inLeft) + length_of(inRight);
+			newNode->height = 1 + std::max(height_of(inLeft), height_of(inRight));
+			return node_ptr(newNode);
+		}
+
+		//Builds a node from two subtrees whose heights differ by at most two, rotating to restore balance
+		static node_ptr make_balanced(const node_ptr& inLeft, const node_ptr& inRight) {
+			const std::size_t leftHeight = height_of(inLeft);
+			const std::size_t rightHeight = height_of(inRight);
+			if (leftHeight > rightHeight + 1) {
+				const node& left = read(inLeft);
+				if (height_of(left.left) >= height_of(left.right)) return make_branch(left.left, make_branch(left.right, inRight));
+				const node& leftRight = read(left.right);
+				return make_branch(make_branch(left.left, leftRight.left), make_branch(leftRight.right, inRight));
+			}
+			if (rightHeight > leftHeight + 1) {
+				const node& right = read(inRight);
+				if (height_of(right.right) >= height_of(right.left)) return make_branch(make_branch(inLeft, right.left), right.right);
+				const node& rightLeft = read(right.left);
+				return make_branch(make_branch(inLeft, rightLeft.left), make_branch(rightLeft.right, right.right));
+			}
+			return make_branch(inLeft, inRight);
+		}
+
+		static node_ptr join(const node_ptr& inLeft, const node_ptr& inRight) {
+			if (!inLeft) return inRight;
+			if (!inRight) return inLeft;
+
+			//Keep small edits from fragmenting the text into tiny leaves
+			if (is_leaf(inLeft) && is_leaf(inRight) && length_of(inLeft) + length_of(inRight) <= max_leaf) {
+				string_type merged = read(inLeft).text + read(inRight).text;
+				return make_leaf(merged.data(), merged.size());
+			}
+
+			const std::size_t leftHeight = height_of(inLeft);
+			const std::size_t rightHeight = height_of(inRight);
+			if (leftHeight > rightHeight + 1) {
+				const node& left = read(inLeft);
+				return make_balanced(left.left, join(left.right, inRight));
+			}
+			if (rightHeight > leftHeight + 1) {
+				const node& right = read(inRight);
+				return make_balanced(join(inLeft, right.left), right.right);
+			}
+			return make_branch(inLeft, inRight);
+		}
+
+		//Splits into the first inPos characters and the rest
+		static node_pair split(const node_ptr& inNode, std::size_t inPos) {
+			if (!inNode || inPos == 0) return node_pair(node_ptr(), inNode);
+			if (inPos >= length_of(inNode)) return node_pair(inNode, node_ptr());
+
+			const node& current = read(inNode);
+			if (is_leaf(inNode)) {
+				return node_pair(make_leaf(current.text.data(), inPos), make_leaf(current.text.data() + inPos, current.length - inPos));
+			}
+
+			const std::size_t leftLength = length_of(current.left);
+			if (inPos < leftLength) {
+				node_pair parts = split(current.left, inPos);
+				return node_pair(parts.first, join(parts.second, current.right));
+			}
+			if (inPos == leftLength) return node_pair(current.left, current.right);
+			node_pair parts = split(current.right, inPos - leftLength);
+			return node_pair(join(current.left, parts.first), parts.second);
+		}
+
+		static node_ptr build(const CharT* inData, std::size_t inLength) {
+			if (inLength <= max_leaf) return make_leaf(inData, inLength);
+			const std::size_t half = inLength / 2;
+			return make_branch(build(inData, half), build(inData + half, inLength - half));
+		}
+
+		void check_position(std::size_t inPos, const char* inWhat) const {
+			if (inPos > this->size()) throw std::out_of_range(inWhat);
+		}
+
+	public:
+
+		//A view of one leaf of the rope, valid for as long as the rope version it came from
+		struct chunk {
+			const CharT* data;
+			std::size_t size;
+		};
+
+		class chunk_iterator {
+			std::vector<const node*> m_stack;
+
+			friend class basic_rope;
+
+			explicit chunk_iterator(const node_ptr& inRoot) : m_stack() {
+				if (inRoot) {
+					m_stack.push_back(&read(inRoot));
+					descend();
+				}
+			}
+
+			//Walk down to the next leaf, leaving the right-hand siblings on the stack for later
+			void descend() {
+				while (!m_stack.empty() && m_stack.back()->height != 0) {
+					const node* branch = m_stack.back();
+					m_stack.pop_back();
+					if (branch->right) m_stack.push_back(&read(branch->right));
+					if (branch->left) m_stack.push_back(&read(branch->left));
+				}
+			}
+
+		public:
+			typedef std::forward_iterator_tag	iterator_category;
+			typedef chunk						value_type;
+			typedef std::ptrdiff_t				difference_type;
+			typedef const chunk*				pointer;
+			typedef chunk						reference;
+
+			chunk_iterator() : m_stack() {}
+
+			chunk operator*() const {
+				chunk current = { m_stack.back()->text.data(), m_stack.back()->length };
+				return current;
+			}
+
+			chunk_iterator& operator++() {
+				m_stack.pop_back();
+				descend();
+				return *this;
+			}
+			chunk_iterator operator++(int) {
+				chunk_iterator temp(*this);
+				++*this;
+				return temp;
+			}
+
+			friend bool operator==(const chunk_iterator& lhs, const chunk_iterator& rhs) {
+				if (lhs.m_stack.empty() || rhs.m_stack.empty()) return lhs.m_stack.empty() && rhs.m_stack.empty();
+				return lhs.m_stack.back() == rhs.m_stack.back() && lhs.m_stack.size() == rhs.m_stack.size();
+			}
+			friend bool operator!=(const chunk_iterator& lhs, const chunk_iterator& rhs) {
+				return !(lhs == rhs);
+			}
+		};
+
+		basic_rope() : m_root() {}
+		basic_rope(const string_type& inText) : m_root(build(inText.data(), inText.size())) {}
+		basic_rope(const CharT* inText) : m_root(build(inText, Traits::length(inText))) {}
+		basic_rope(const CharT* inText, std::size_t inLength) : m_root(build(inText, inLength)) {}
+
+		std::size_t size() const {
+			return length_of(m_root);
+		}
+		std::size_t length() const {
+			return this->size();
+		}
+		bool empty() const {
+			return !m_root;
+		}
+
+		CharT operator[](std::size_t inPos) const {
+			const node* current = &read(m_root);
+			while (current->height != 0) {
+				const std::size_t leftLength = length_of(current->left);
+				if (inPos < leftLength) {
+					current = &read(current->left);
+				}
+				else {
+					inPos -= leftLength;
+					current = &read(current->right);
+				}
+			}
+			return current->text[inPos];
+		}
+		CharT at(std::size_t inPos) const {
+			if (inPos >= this->size()) throw std::out_of_range("Index out of range in rope::at");
+			return (*this)[inPos];
+		}
+
+		chunk_iterator chunks_begin() const {
+			return chunk_iterator(m_root);
+		}
+		chunk_iterator chunks_end() const {
+			return chunk_iterator();
+		}
+
+		void insert(std::size_t inPos, const basic_rope& inRope) {
+			check_position(inPos, "Index out of range in rope::insert");
+			node_pair parts = split(m_root, inPos);
+			m_root = join(join(parts.first, inRope.m_root), parts.second);
+		}
+		void insert(std::size_t inPos, const string_type& inText) {
+			this->insert(inPos, basic_rope(inText));
+		}
+		void insert(std::size_t inPos, const CharT* inText) {
+			this->insert(inPos, basic_rope(inText));
+		}
+
+		void append(const basic_rope& inRope) {
+			m_root = join(m_root, inRope.m_root);
+		}
+		void append(const string_type& inText) {
+			this->append(basic_rope(inText));
+		}
+		void append(const CharT* inText) {
+			this->append(basic_rope(inText));
+		}
+
+		void erase(std::size_t inPos, std::size_t inCount = string_type::npos) {
+			check_position(inPos, "Index out of range in rope::erase");
+			inCount = std::min(inCount, this->size() - inPos);
+			node_pair front = split(m_root, inPos);
+			node_pair back = split(front.second, inCount);
+			m_root = join(front.first, back.second);
+		}
+
+		//Shares structure with this rope rather than copying the text
+		basic_rope substr(std::size_t inPos, std::size_t inCount = string_type::npos) const {
+			check_position(inPos, "Index out of range in rope::substr");
+			inCount = std::min(inCount, this->size() - inPos);
+			return basic_rope(split(split(m_root, inPos).second, inCount).first);
+		}
+
+		string_type str() const {
+			string_type result;
+			result.reserve(this->size());
+			for (chunk_iterator it = this->chunks_begin(); it != this->chunks_end(); ++it) {
+				result.append((*it).data, (*it).size);
+			}
+			return result;
+		}
+
+		void clear() {
+			m_root.reset();
+		}
+
+		void swap(basic_rope& other) {
+			m_root.swap(other.m_root);
+		}
+	};
+
+	typedef basic_rope<char>	rope;
+	typedef basic_rope<wchar_t>	wrope;
+
+	template<typename CharT, typename Traits>
+	void swap(dp::basic_rope<CharT, Traits>& lhs, dp::basic_rope<CharT, Traits>& rhs) {
+		lhs.swap(rhs);
+	}
+
+	template<typename CharT, typename Traits>
+	std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const dp::basic_rope<CharT, Traits>& rhs) {
+		typedef typename dp::basic_rope<CharT, Traits>::chunk_iterator iterator;
+		for (iterator it = rhs.chunks_begin(); it != rhs.chunks_end(); ++it) {
+			os.write((*it).data, static_cast<std::streamsize>((*it).size));
+		}
+		return os;
+	}
+
+}
+
+#endif
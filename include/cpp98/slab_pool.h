@@ -0,0 +1,289 @@
+#ifndef DP_CPP98_SLAB_POOL
+#define DP_CPP98_SLAB_POOL
+
+#include "bits/static_assert_no_macro.h"
+#include "bits/version_defs.h"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#ifdef DP_CPP11_OR_HIGHER
+#include <mutex>
+#endif
+
+/*
+*	A size-class slab pool for small objects, with a cache of free blocks on each thread.
+*	Requests of up to max_size bytes are rounded up to a multiple of granularity and served from a free list for that size. Each thread
+*	keeps its own free lists and only takes the shared lock to move a batch of blocks to or from the central lists, so a thread which
+*	allocates and frees at a steady rate rarely synchronises at all. Larger requests go straight to operator new.
+*	Slabs are never returned to the system, so the pool holds on to the peak number of blocks of each size. Blocks have the alignment
+*	of operator new, and types which need more are rejected at compile time.
+*	A block freed on a thread whose cache has already been destroyed, e.g. by another thread_local's destructor, goes straight back
+*	to the central lists.
+*
+*	THREAD SAFETY: from C++11 the pool can be used from any number of threads. Before C++11 there is neither thread_local nor a
+*	standard mutex, so the pool has no locking at all, and every allocation and deallocation must happen on one thread.
+*
+*	Objects can use the pool through slab_allocator, e.g. for the nodes of a container, or by deriving from slab_allocated. A cow_ptr
+*	payload deriving from slab_allocated comes from the pool both in make_cow and when a detach copies it. From C++11 every cow_ptr
+*	control block comes from the pool as well. Before C++11 they only do when a slab_allocator is passed to allocate_cow, or to the
+*	cow_ptr constructor which takes an allocator, which then ties those cow_ptrs to a single thread too.
+*/
+
+namespace dp {
+
+	namespace detail {
+		//The alignment of T. Before C++11 there is no alignof, so it is measured from the padding T needs after a char.
+		template<typename T>
+		struct slab_alignment_of {
+#ifdef DP_CPP11_OR_HIGHER
+			static const std::size_t value = alignof(T);
+#else
+			struct probe {
+				char first;
+				T second;
+			};
+			static const std::size_t value = sizeof(probe) - sizeof(T);
+#endif
+		};
+
+		//Stands in for max_align_t: operator new returns memory suitably aligned for any of these
+		union slab_max_align {
+			long double asLongDouble;
+			double asDouble;
+			long asLong;
+			void* asPointer;
+			void (*asFunction)();
+		};
+	}
+
+	class slab_pool {
+	public:
+		static const std::size_t granularity = 16;
+		static const std::size_t max_size = 256;
+		static const std::size_t class_count = max_size / granularity;
+		static const std::size_t slab_bytes = 64 * 1024;
+		static const std::size_t cache_limit = 64;
+		//Every block is aligned to this. Slabs come from operator new and block sizes are multiples of granularity.
+		static const std::size_t alignment = dp::detail::slab_alignment_of<dp::detail::slab_max_align>::value;
+
+	private:
+		struct free_block {
+			free_block* next;
+		};
+
+		struct free_list {
+			free_block* head;
+			std::size_t count;
+
+			free_list() : head(NULL), count(0) {}
+
+			void push(free_block* in) {
+				in->next = head;
+				head = in;
+				++count;
+			}
+			free_block* pop() {
+				free_block* result = head;
+				head = head->next;
+				--count;
+				return result;
+			}
+		};
+
+		struct central {
+			free_list lists[class_count];
+			//Only kept so the slabs stay reachable
+			std::vector<void*> slabs;
+#ifdef DP_CPP11_OR_HIGHER
+			std::mutex lock;
+#endif
+		};
+
+		//Never destroyed, so that blocks can still be freed by the destructors of other statics and thread_locals
+		static central& shared() {
+			static central* instance = new central();
+			return *instance;
+		}
+
+		static std::size_t class_of(std::size_t inSize) {
+			return inSize == 0 ? 0 : (inSize - 1) / granularity;
+		}
+		static std::size_t block_size(std::size_t inClass) {
+			return (inClass + 1) * granularity;
+		}
+
+		//Moves up to inCount blocks from the central list into inTo, carving a new slab if the central list is empty
+		static void fetch(std::size_t inClass, free_list& inTo, std::size_t inCount) {
+			central& pool = shared();
+#ifdef DP_CPP11_OR_HIGHER
+			std::lock_guard<std::mutex> guard(pool.lock);
+#endif
+			free_list& from = pool.lists[inClass];
+			if (!from.head) {
+				const std::size_t size = block_size(inClass);
+				char* slab = static_cast<char*>(::operator new(slab_bytes));
+				pool.slabs.push_back(slab);
+				for (std::size_t offset = 0; offset + size <= slab_bytes; offset += size) {
+					from.push(reinterpret_cast<free_block*>(slab + offset));
+				}
+			}
+			for (std::size_t i = 0; i < inCount && from.head; ++i) inTo.push(from.pop());
+		}
+
+		static void give_back(std::size_t inClass, free_list& inFrom, std::size_t inCount) {
+			central& pool = shared();
+#ifdef DP_CPP11_OR_HIGHER
+			std::lock_guard<std::mutex> guard(pool.lock);
+#endif
+			for (std::size_t i = 0; i < inCount && inFrom.head; ++i) pool.lists[inClass].push(inFrom.pop());
+		}
+
+		//A trivially destructible flag, so it can still be read after the cache itself has been destroyed
+		static bool& cache_destroyed() {
+#ifdef DP_CPP11_OR_HIGHER
+			static thread_local bool destroyed = false;
+#else
+			static bool destroyed = false;
+#endif
+			return destroyed;
+		}
+
+		struct thread_cache {
+			free_list lists[class_count];
+
+			~thread_cache() {
+				for (std::size_t i = 0; i < class_count; ++i) give_back(i, lists[i], lists[i].count);
+				cache_destroyed() = true;
+			}
+		};
+
+		//This thread's cache, or NULL once it has been destroyed
+		static thread_cache* local() {
+			if (cache_destroyed()) return NULL;
+#ifdef DP_CPP11_OR_HIGHER
+			static thread_local thread_cache cache;
+#else
+			static thread_cache cache;
+#endif
+			return &cache;
+		}
+
+	public:
+		static void* allocate(std::size_t inSize) {
+			if (inSize > max_size) return ::operator new(inSize);
+			const std::size_t sizeClass = class_of(inSize);
+			thread_cache* cache = local();
+			if (!cache) {
+				free_list single;
+				fetch(sizeClass, single, 1);
+				return single.pop();
+			}
+			free_list& list = cache->lists[sizeClass];
+			if (!list.head) fetch(sizeClass, list, cache_limit / 2);
+			return list.pop();
+		}
+
+		//inSize must be the size which was passed to allocate
+		static void deallocate(void* in, std::size_t inSize) {
+			if (!in) return;
+			if (inSize > max_size) {
+				::operator delete(in);
+				return;
+			}
+			const std::size_t sizeClass = class_of(inSize);
+			thread_cache* cache = local();
+			if (!cache) {
+				free_list single;
+				single.push(static_cast<free_block*>(in));
+				give_back(sizeClass, single, 1);
+				return;
+			}
+			free_list& list = cache->lists[sizeClass];
+			list.push(static_cast<free_block*>(in));
+			if (list.count > cache_limit) give_back(sizeClass, list, cache_limit / 2);
+		}
+	};
+
+
+	template<typename T>
+	class slab_allocator {
+	public:
+		typedef T					value_type;
+		typedef T*					pointer;
+		typedef const T*			const_pointer;
+		typedef T&					reference;
+		typedef const T&			const_reference;
+		typedef std::size_t			size_type;
+		typedef std::ptrdiff_t		difference_type;
+
+		template<typename U>
+		struct rebind {
+			typedef slab_allocator<U> other;
+		};
+
+		slab_allocator() {}
+		template<typename U>
+		slab_allocator(const slab_allocator<U>&) {}
+
+		pointer allocate(size_type inCount, const void* = NULL) {
+			//Over-aligned types cannot be served from the slabs
+			dp::static_assert_98<dp::detail::slab_alignment_of<T>::value <= dp::slab_pool::alignment>();
+			if (inCount > this->max_size()) throw std::bad_alloc();
+			return static_cast<pointer>(dp::slab_pool::allocate(inCount * sizeof(T)));
+		}
+		void deallocate(pointer inPtr, size_type inCount) {
+			dp::slab_pool::deallocate(inPtr, inCount * sizeof(T));
+		}
+
+		void construct(pointer inPtr, const T& inValue) {
+			::new (static_cast<void*>(inPtr)) T(inValue);
+		}
+		void destroy(pointer inPtr) {
+			inPtr->~T();
+		}
+
+		pointer address(reference in) const {
+			return &in;
+		}
+		const_pointer address(const_reference in) const {
+			return &in;
+		}
+
+		size_type max_size() const {
+			return static_cast<size_type>(-1) / sizeof(T);
+		}
+	};
+
+	//Every slab_allocator draws on the same pool, so any one can free what another allocated
+	template<typename T, typename U>
+	bool operator==(const slab_allocator<T>&, const slab_allocator<U>&) {
+		return true;
+	}
+	template<typename T, typename U>
+	bool operator!=(const slab_allocator<T>&, const slab_allocator<U>&) {
+		return false;
+	}
+
+
+	//Deriving from slab_allocated<Derived> gives Derived class-specific operator new and delete which use the pool
+	template<typename Derived>
+	class slab_allocated {
+	public:
+		static void* operator new(std::size_t inSize) {
+			dp::static_assert_98<dp::detail::slab_alignment_of<Derived>::value <= dp::slab_pool::alignment>();
+			return dp::slab_pool::allocate(inSize);
+		}
+		static void operator delete(void* in, std::size_t inSize) {
+			dp::slab_pool::deallocate(in, inSize);
+		}
+
+	protected:
+		slab_allocated() {}
+		~slab_allocated() {}
+	};
+
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef DP_CPP98_SNAPSHOT_CACHE
+#define DP_CPP98_SNAPSHOT_CACHE
+
+#include "cpp98/weak_cow_ptr.h"
+
+#include <cstddef>
+#include <map>
+
+/*
+*	A bounded cache of results computed from cow_ptr snapshots.
+*	Entries are keyed on the snapshot's control block through a weak_cow_ptr, so the cache never keeps a snapshot alive, and the key
+*	cannot be reused while its entry exists. Because the key is a weak_cow_ptr, even the snapshot's only owner copies the object
+*	before modifying it, so a cached result always describes its key. Results are stale only if the object was changed through a
+*	reference or pointer which was taken from a non-const access before the snapshot was first cached.
+*	Entries whose snapshot has died are dropped whenever the cache needs room, or explicitly through purge(). If every entry is still
+*	live when the cache is full, an arbitrary entry is evicted.
+*/
+
+namespace dp {
+
+	template<typename T, typename R>
+	class snapshot_cache {
+
+		struct owner_less {
+			bool operator()(const dp::weak_cow_ptr<T>& lhs, const dp::weak_cow_ptr<T>& rhs) const {
+				return lhs.owner_before(rhs);
+			}
+		};
+
+		typedef std::map<dp::weak_cow_ptr<T>, R, owner_less> map_type;
+
+		map_type m_entries;
+		std::size_t m_capacity;
+
+		void make_room() {
+			if (m_entries.size() < m_capacity) return;
+			this->purge();
+			if (m_entries.size() >= m_capacity && !m_entries.empty()) m_entries.erase(m_entries.begin());
+		}
+
+	public:
+		typedef T	snapshot_type;
+		typedef R	result_type;
+
+		explicit snapshot_cache(std::size_t inCapacity) : m_entries(), m_capacity(inCapacity) {}
+
+		//The result cached for inSnapshot, or NULL if there is none
+		const R* find(const dp::cow_ptr<T>& inSnapshot) const {
+			typename map_type::const_iterator it = m_entries.find(dp::weak_cow_ptr<T>(inSnapshot));
+			return it == m_entries.end() ? NULL : &it->second;
+		}
+
+		//Returns the cached result for inSnapshot, calling func with the snapshot's object to compute it on a miss. inSnapshot must not be null.
+		template<typename F>
+		const R& get_or_compute(const dp::cow_ptr<T>& inSnapshot, F func) {
+			dp::weak_cow_ptr<T> key(inSnapshot);
+			typename map_type::iterator it = m_entries.find(key);
+			if (it != m_entries.end()) return it->second;
+
+			R result = func(*inSnapshot);
+			this->make_room();
+			return m_entries.insert(typename map_type::value_type(key, result)).first->second;
+		}
+
+		//Drops every entry whose snapshot has been destroyed, and returns how many were dropped
+		std::size_t purge() {
+			std::size_t count = 0;
+			typename map_type::iterator it = m_entries.begin();
+			while (it != m_entries.end()) {
+				if (it->first.expired()) {
+					m_entries.erase(it++);
+					++count;
+				}
+				else {
+					++it;
+				}
+			}
+			return count;
+		}
+
+		std::size_t size() const {
+			return m_entries.size();
+		}
+		std::size_t capacity() const {
+			return m_capacity;
+		}
+		bool empty() const {
+			return m_entries.empty();
+		}
+
+		void clear() {
+			m_entries.clear();
+		}
+	};
+
+}
+
+#endif
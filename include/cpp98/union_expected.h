@@ -0,0 +1,577 @@
+#ifndef DP_CPP98_UNION_EXPECTED
+#define DP_CPP98_UNION_EXPECTED
+
+#ifdef DP_CPP17_EXPECTED
+#error "Both C++98 and C++17 dp::expected detected. Only use one or the other"
+#endif
+#ifdef DP_CPP98_EXPECTED
+#error "Both the C++98 library's dp::expected and the union-based dp::expected detected. Only use one or the other"
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include "bits/version_defs.h"
+
+#ifdef DP_CPP11_OR_HIGHER
+#include <type_traits>
+#endif
+#ifdef DP_CPP17_OR_HIGHER
+#include <utility>
+#endif
+
+/*
+*	An analogue of std::expected, written in C++98
+*	The value or error lives in a union inside the expected itself, sized and aligned for the larger of the two, so there is no heap
+*	use and no variant. The interface follows the C++17 version as far as C++98 allows, so code can move between the two. There are
+*	no monadic operations, as without decltype or auto there is no way to name their result types.
+*
+*	This is a drop-in alternative to the C++98 library's own cpp98/expected.h, so only one of the two can be used in a program.
+*
+*	There is no move semantics, so swap is the way to move a payload. Swapping two expecteds in the same state swaps their payloads
+*	with their own swap, which is cheap for containers; assign_by_swap does the same for a loose value. emplace and the in_place
+*	constructors build the value where it is stored, from up to three arguments.
+*
+*	When an expected<T, E> changes from holding a value to holding an error, the value is destroyed before the error is copied into
+*	its place, so E's copy constructor must not throw. From C++11 this is checked at compile time wherever an expected may change
+*	state; in C++98 an exception from that copy calls std::terminate rather than leave the expected holding nothing. Likewise emplace,
+*	which is noexcept in the C++17 version, calls std::terminate if T's constructor throws.
+*
+*	Defining DP_EXPECTED_NO_EXCEPTIONS before including this header makes value() call std::abort() rather than throwing
+*	bad_expected_access, for builds which have exceptions disabled or cannot afford them.
+*/
+namespace dp {
+
+	namespace detail {
+		template<std::size_t A, std::size_t B>
+		struct expected_max_size {
+			static const std::size_t value = A > B ? A : B;
+		};
+
+		//There is no alignof, so we align for every fundamental type instead
+		union expected_max_align {
+			long double	m_long_double;
+			double		m_double;
+			long		m_long;
+			void*		m_pointer;
+			void		(*m_function)();
+		};
+
+		//Calls std::terminate if it is destroyed before release(), which is during unwinding from a constructor which must not throw
+		class expected_terminate_guard {
+			bool m_armed;
+
+			expected_terminate_guard(const expected_terminate_guard&);
+			expected_terminate_guard& operator=(const expected_terminate_guard&);
+
+		public:
+			expected_terminate_guard() : m_armed(true) {}
+			~expected_terminate_guard() {
+				if (m_armed) std::terminate();
+			}
+			void release() {
+				m_armed = false;
+			}
+		};
+
+		//Copies inErr into storage which held a value that has already been destroyed, so there is nothing to fall back to
+		template<typename E>
+		void expected_construct_error(void* inStorage, const E& inErr) {
+#ifdef DP_CPP11_OR_HIGHER
+			static_assert(std::is_nothrow_copy_constructible<E>::value, "dp::expected<T, E> can only change from a value to an error if E's copy constructor does not throw");
+#endif
+			dp::detail::expected_terminate_guard guard;
+			new (inStorage) E(inErr);
+			guard.release();
+		}
+	}
+
+
+	template<typename T>
+	class bad_expected_access;
+
+	template<>
+	class bad_expected_access<void> : public std::exception {
+	public:
+		const char* what() const throw() {
+			return "Bad expected access";
+		}
+	};
+
+	template<typename Err>
+	class bad_expected_access : public dp::bad_expected_access<void> {
+		Err m_error;
+
+	public:
+		explicit bad_expected_access(const Err& e) : m_error(e) {}
+		~bad_expected_access() throw() {}
+
+		Err& error() {
+			return m_error;
+		}
+		const Err& error() const {
+			return m_error;
+		}
+	};
+
+
+	template<typename Err>
+	class unexpected {
+		Err m_error;
+
+	public:
+		explicit unexpected(const Err& in) : m_error(in) {}
+
+		Err& error() {
+			return m_error;
+		}
+		const Err& error() const {
+			return m_error;
+		}
+
+		void swap(dp::unexpected<Err>& other) {
+			using std::swap;
+			swap(m_error, other.m_error);
+		}
+	};
+
+	template<typename Err>
+	void swap(dp::unexpected<Err>& lhs, dp::unexpected<Err>& rhs) {
+		lhs.swap(rhs);
+	}
+
+	template<typename Err, typename Other>
+	bool operator==(const dp::unexpected<Err>& lhs, const dp::unexpected<Other>& rhs) {
+		return lhs.error() == rhs.error();
+	}
+	template<typename Err, typename Other>
+	bool operator!=(const dp::unexpected<Err>& lhs, const dp::unexpected<Other>& rhs) {
+		return !(lhs == rhs);
+	}
+
+	//Without CTAD this is the easy way to make an unexpected
+	template<typename Err>
+	dp::unexpected<Err> unex(const Err& in) {
+		return dp::unexpected<Err>(in);
+	}
+
+
+	struct unexpect_t {
+		unexpect_t() {}
+	};
+
+	static const unexpect_t unexpect = unexpect_t();
+
+	//The same tag as the C++17 version uses where the standard has one
+#ifdef DP_CPP17_OR_HIGHER
+	using std::in_place_t;
+	using std::in_place;
+#else
+	struct in_place_t {
+		in_place_t() {}
+	};
+
+	static const in_place_t in_place = in_place_t();
+#endif
+
+
+
+	template<typename T, typename E>
+	class expected {
+
+		union storage_type {
+			char m_bytes[dp::detail::expected_max_size<sizeof(T), sizeof(E)>::value];
+			dp::detail::expected_max_align m_align;
+		};
+
+		storage_type m_storage;
+		bool m_has_value;
+
+		T* value_address() {
+			return reinterpret_cast<T*>(m_storage.m_bytes);
+		}
+		const T* value_address() const {
+			return reinterpret_cast<const T*>(m_storage.m_bytes);
+		}
+		E* error_address() {
+			return reinterpret_cast<E*>(m_storage.m_bytes);
+		}
+		const E* error_address() const {
+			return reinterpret_cast<const E*>(m_storage.m_bytes);
+		}
+
+		void destroy() {
+			if (m_has_value) value_address()->~T();
+			else error_address()->~E();
+		}
+
+		//Replaces a held error with a copy of inVal. If the copy throws, the error is put back.
+		void reinit_value(const T& inVal) {
+#ifdef DP_EXPECTED_NO_EXCEPTIONS
+			error_address()->~E();
+			new (m_storage.m_bytes) T(inVal);
+#else
+			E saved(*error_address());
+			error_address()->~E();
+			try {
+				new (m_storage.m_bytes) T(inVal);
+			}
+			catch (...) {
+				dp::detail::expected_construct_error(m_storage.m_bytes, saved);
+				throw;
+			}
+#endif
+			m_has_value = true;
+		}
+
+		void reinit_error(const E& inErr) {
+			value_address()->~T();
+			dp::detail::expected_construct_error(m_storage.m_bytes, inErr);
+			m_has_value = false;
+		}
+
+		//Destroys what is held, ready for emplace to construct a value in its place
+		void* clear_for_emplace() {
+			this->destroy();
+			return m_storage.m_bytes;
+		}
+
+		void fail() const {
+#ifdef DP_EXPECTED_NO_EXCEPTIONS
+			std::abort();
+#else
+			throw dp::bad_expected_access<E>(*error_address());
+#endif
+		}
+
+	public:
+
+		typedef T					value_type;
+		typedef E					error_type;
+		typedef dp::unexpected<E>	unexpected_type;
+
+		template<typename U>
+		struct rebind {
+			typedef dp::expected<U, error_type> type;
+		};
+
+		expected() : m_has_value(true) {
+			new (m_storage.m_bytes) T();
+		}
+
+		expected(const expected& other) : m_has_value(other.m_has_value) {
+			if (m_has_value) new (m_storage.m_bytes) T(*other.value_address());
+			else new (m_storage.m_bytes) E(*other.error_address());
+		}
+
+		expected(const T& in) : m_has_value(true) {
+			new (m_storage.m_bytes) T(in);
+		}
+
+		explicit expected(dp::in_place_t) : m_has_value(true) {
+			new (m_storage.m_bytes) T();
+		}
+		template<typename A1>
+		expected(dp::in_place_t, const A1& inArg1) : m_has_value(true) {
+			new (m_storage.m_bytes) T(inArg1);
+		}
+		template<typename A1, typename A2>
+		expected(dp::in_place_t, const A1& inArg1, const A2& inArg2) : m_has_value(true) {
+			new (m_storage.m_bytes) T(inArg1, inArg2);
+		}
+		template<typename A1, typename A2, typename A3>
+		expected(dp::in_place_t, const A1& inArg1, const A2& inArg2, const A3& inArg3) : m_has_value(true) {
+			new (m_storage.m_bytes) T(inArg1, inArg2, inArg3);
+		}
+
+		template<typename G>
+		expected(const dp::unexpected<G>& unex) : m_has_value(false) {
+			new (m_storage.m_bytes) E(unex.error());
+		}
+
+		template<typename G>
+		expected(dp::unexpect_t, const G& inErr) : m_has_value(false) {
+			new (m_storage.m_bytes) E(inErr);
+		}
+
+		~expected() {
+			this->destroy();
+		}
+
+
+		expected& operator=(const expected& other) {
+			if (this == &other) return *this;
+			if (m_has_value && other.m_has_value) *value_address() = *other.value_address();
+			else if (!m_has_value && !other.m_has_value) *error_address() = *other.error_address();
+			else if (other.m_has_value) this->reinit_value(*other.value_address());
+			else this->reinit_error(*other.error_address());
+			return *this;
+		}
+
+		expected& operator=(const T& inVal) {
+			if (m_has_value) *value_address() = inVal;
+			else this->reinit_value(inVal);
+			return *this;
+		}
+
+		template<typename G>
+		expected& operator=(const dp::unexpected<G>& inUnex) {
+			if (!m_has_value) *error_address() = inUnex.error();
+			else this->reinit_error(E(inUnex.error()));
+			return *this;
+		}
+
+		//Destroys whatever is held and constructs a value in its place
+		T& emplace() {
+			void* storage = this->clear_for_emplace();
+			dp::detail::expected_terminate_guard guard;
+			new (storage) T();
+			guard.release();
+			m_has_value = true;
+			return *value_address();
+		}
+		template<typename A1>
+		T& emplace(const A1& inArg1) {
+			void* storage = this->clear_for_emplace();
+			dp::detail::expected_terminate_guard guard;
+			new (storage) T(inArg1);
+			guard.release();
+			m_has_value = true;
+			return *value_address();
+		}
+		template<typename A1, typename A2>
+		T& emplace(const A1& inArg1, const A2& inArg2) {
+			void* storage = this->clear_for_emplace();
+			dp::detail::expected_terminate_guard guard;
+			new (storage) T(inArg1, inArg2);
+			guard.release();
+			m_has_value = true;
+			return *value_address();
+		}
+		template<typename A1, typename A2, typename A3>
+		T& emplace(const A1& inArg1, const A2& inArg2, const A3& inArg3) {
+			void* storage = this->clear_for_emplace();
+			dp::detail::expected_terminate_guard guard;
+			new (storage) T(inArg1, inArg2, inArg3);
+			guard.release();
+			m_has_value = true;
+			return *value_address();
+		}
+
+		//Swaps inVal into *this as its value, leaving inVal with the old value or a default-constructed T
+		void assign_by_swap(T& inVal) {
+			if (!m_has_value) this->reinit_value(T());
+			using std::swap;
+			swap(*value_address(), inVal);
+		}
+
+
+		const T* operator->() const {
+			return value_address();
+		}
+		T* operator->() {
+			return value_address();
+		}
+
+		const T& operator*() const {
+			return *value_address();
+		}
+		T& operator*() {
+			return *value_address();
+		}
+
+		T& value() {
+			if (!m_has_value) this->fail();
+			return *value_address();
+		}
+		const T& value() const {
+			if (!m_has_value) this->fail();
+			return *value_address();
+		}
+
+		const E& error() const {
+			return *error_address();
+		}
+		E& error() {
+			return *error_address();
+		}
+
+
+		bool has_value() const {
+			return m_has_value;
+		}
+		operator bool() const {
+			return m_has_value;
+		}
+
+		template<typename U>
+		T value_or(const U& in) const {
+			return m_has_value ? *value_address() : static_cast<T>(in);
+		}
+
+
+		void swap(expected& other) {
+			using std::swap;
+			if (m_has_value && other.m_has_value) swap(*value_address(), *other.value_address());
+			else if (!m_has_value && !other.m_has_value) swap(*error_address(), *other.error_address());
+			else if (m_has_value) {
+				E otherError(*other.error_address());
+				other.reinit_value(*value_address());
+				this->reinit_error(otherError);
+			}
+			else other.swap(*this);
+		}
+	};
+
+
+	template<typename E>
+	class expected<void, E> {
+
+		union storage_type {
+			char m_bytes[sizeof(E)];
+			dp::detail::expected_max_align m_align;
+		};
+
+		storage_type m_storage;
+		bool m_has_value;
+
+		E* error_address() {
+			return reinterpret_cast<E*>(m_storage.m_bytes);
+		}
+		const E* error_address() const {
+			return reinterpret_cast<const E*>(m_storage.m_bytes);
+		}
+
+		void destroy() {
+			if (!m_has_value) error_address()->~E();
+		}
+
+	public:
+
+		typedef void				value_type;
+		typedef E					error_type;
+		typedef dp::unexpected<E>	unexpected_type;
+
+		template<typename U>
+		struct rebind {
+			typedef dp::expected<U, error_type> type;
+		};
+
+		expected() : m_has_value(true) {}
+
+		explicit expected(dp::in_place_t) : m_has_value(true) {}
+
+		expected(const expected& other) : m_has_value(other.m_has_value) {
+			if (!m_has_value) new (m_storage.m_bytes) E(*other.error_address());
+		}
+
+		template<typename G>
+		expected(const dp::unexpected<G>& unex) : m_has_value(false) {
+			new (m_storage.m_bytes) E(unex.error());
+		}
+
+		template<typename G>
+		expected(dp::unexpect_t, const G& inErr) : m_has_value(false) {
+			new (m_storage.m_bytes) E(inErr);
+		}
+
+		~expected() {
+			this->destroy();
+		}
+
+
+		expected& operator=(const expected& other) {
+			if (this == &other) return *this;
+			if (!m_has_value && !other.m_has_value) *error_address() = *other.error_address();
+			else if (!other.m_has_value) {
+				new (m_storage.m_bytes) E(*other.error_address());
+				m_has_value = false;
+			}
+			else {
+				this->destroy();
+				m_has_value = true;
+			}
+			return *this;
+		}
+
+		template<typename G>
+		expected& operator=(const dp::unexpected<G>& inUnex) {
+			if (!m_has_value) *error_address() = inUnex.error();
+			else {
+				new (m_storage.m_bytes) E(inUnex.error());
+				m_has_value = false;
+			}
+			return *this;
+		}
+
+		void operator*() const {}
+
+		void value() const {
+			if (m_has_value) return;
+#ifdef DP_EXPECTED_NO_EXCEPTIONS
+			std::abort();
+#else
+			throw dp::bad_expected_access<E>(*error_address());
+#endif
+		}
+
+		const E& error() const {
+			return *error_address();
+		}
+		E& error() {
+			return *error_address();
+		}
+
+
+		bool has_value() const {
+			return m_has_value;
+		}
+		operator bool() const {
+			return m_has_value;
+		}
+
+		//Sets *this to hold a value, destroying any error
+		void emplace() {
+			this->destroy();
+			m_has_value = true;
+		}
+
+
+		void swap(expected& other) {
+			using std::swap;
+			if (m_has_value && other.m_has_value) return;
+			if (!m_has_value && !other.m_has_value) swap(*error_address(), *other.error_address());
+			else if (m_has_value) {
+				new (m_storage.m_bytes) E(*other.error_address());
+				m_has_value = false;
+				other.emplace();
+			}
+			else other.swap(*this);
+		}
+	};
+
+
+	template<typename T1, typename E1, typename T2, typename E2>
+	bool operator==(const dp::expected<T1, E1>& lhs, const dp::expected<T2, E2>& rhs) {
+		return (lhs.has_value() && rhs.has_value() && *lhs == *rhs);
+	}
+	template<typename E1, typename E2>
+	bool operator==(const dp::expected<void, E1>& lhs, const dp::expected<void, E2>& rhs) {
+		return lhs.has_value() && rhs.has_value();
+	}
+	template<typename T1, typename E1, typename T2, typename E2>
+	bool operator!=(const dp::expected<T1, E1>& lhs, const dp::expected<T2, E2>& rhs) {
+		return !(lhs == rhs);
+	}
+
+
+	template<typename T, typename E>
+	void swap(dp::expected<T, E>& lhs, dp::expected<T, E>& rhs) {
+		lhs.swap(rhs);
+	}
+
+}
+
+#endif
@@ -5,6 +5,9 @@
 #include "bits/smart_ptr_bases.h"
 #include "cpp98/static_assert.h"
 #include "bits/type_traits_ns.h"
+#ifdef DP_CLONE_CONTEXT
+#include "cpp98/clone_context.h"
+#endif
 
 
 /*
@@ -31,7 +34,11 @@ namespace dp {
 		explicit value_ptr() : m_data(NULL) {}
 		explicit value_ptr(T* in) : m_data(in) {}
 
-		value_ptr(const value_ptr<T>& in) : m_data(in.m_data ? new T(*in.m_data) : NULL) {}
+		value_ptr(const value_ptr<T>& in) : m_data(in.m_data ? new T(*in.m_data) : NULL) {
+#ifdef DP_CLONE_CONTEXT
+			dp::clone_context::record(in.m_data, m_data);
+#endif
+		}
 		value_ptr& operator=(const value_ptr<T>& in) {
 			value_ptr copy(in);
 			this->swap(copy);
@@ -48,6 +55,7 @@ namespace dp {
 			this->reset();
 			m_data = in.m_data;
 			in.m_data = NULL;
+			return *this;
 		}
 #endif
 		~value_ptr() {
@@ -95,11 +103,11 @@ namespace dp {
 
 		const T* operator->() const {
 			STATIC_ASSERT(!dp::is_array<T>::value);
-			return *m_data;
+			return m_data;
 		}
 		T* operator->() {
 			STATIC_ASSERT(!dp::is_array<T>::value);
-			return *m_data;
+			return m_data;
 		}
 
 		const T& operator[](std::size_t index) const {
@@ -147,19 +155,19 @@ namespace dp {
 	}
 
 	template<typename T>
-	bool operator==(const value_ptr<T>& lhs, dp::null_ptr_t rhs) {
+	bool operator==(const value_ptr<T>& lhs, dp::null_ptr_t) {
 		return lhs.get() == NULL;
 	}
 	template<typename T>
-	bool operator==(dp::null_ptr_t lhs, const value_ptr<T>& rhs) {
+	bool operator==(dp::null_ptr_t, const value_ptr<T>& rhs) {
 		return rhs.get() == NULL;
 	}
 	template<typename T>
-	bool operator!=(const value_ptr<T>& lhs, dp::null_ptr_t rhs) {
+	bool operator!=(const value_ptr<T>& lhs, dp::null_ptr_t) {
 		return lhs.get();
 	}
 	template<typename T>
-	bool operator!=(dp::null_ptr_t lhs, const dp::value_ptr<T>& rhs) {
+	bool operator!=(dp::null_ptr_t, const dp::value_ptr<T>& rhs) {
 		return rhs.get();
 	}
 
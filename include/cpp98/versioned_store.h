@@ -0,0 +1,170 @@
+#ifndef DP_CPP98_VERSIONED_STORE
+#define DP_CPP98_VERSIONED_STORE
+
+#include "cpp98/cow_ptr.h"
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <stdexcept>
+
+/*
+*	A store of numbered cow_ptr snapshots with bounded history.
+*	Each commit appends a snapshot as a new version. Any retained version can be read in O(1) by its number, and the oldest versions
+*	are dropped once the store holds more than its maximum number of versions or more than its maximum number of bytes.
+*	Rolling back re-commits an older snapshot as the newest version. It copies a pointer rather than the object, and leaves the
+*	intervening versions readable until they age out of the history. Like any commit it updates the count of versions which hold the
+*	object, which is a map lookup, so commit and rollback_to are O(log n) in the number of distinct objects retained.
+*
+*	Memory is measured per distinct top-level object, found by address. A snapshot held by several versions is counted once, and the
+*	store reports how much of the logical size of its history that sharing saves. Sharing below that level is not seen: two versions
+*	which are different objects are counted in full even if they share most of their contents, e.g. the nodes of a persistent_vector.
+*	Object sizes come from SizeFn, which defaults to sizeof(T); types which own heap storage should supply their own.
+*
+*	A versioned_store has no synchronisation of its own and must only be used from one thread at a time. A cow_ptr copied out of it
+*	is an ordinary snapshot, which can be read on another thread while the store goes on committing.
+*/
+
+namespace dp {
+
+	template<typename T>
+	struct default_object_size {
+		std::size_t operator()(const T&) const {
+			return sizeof(T);
+		}
+	};
+
+	struct sharing_stats {
+		std::size_t versions;
+		//The total size of every retained version, as if none shared storage
+		std::size_t logical_bytes;
+		//The size of the distinct objects which are actually retained
+		std::size_t unique_bytes;
+		//The bytes saved by sharing, i.e. logical_bytes - unique_bytes
+		std::size_t shared_bytes;
+	};
+
+
+	template<typename T, typename SizeFn = dp::default_object_size<T> >
+	class versioned_store {
+	public:
+		typedef std::size_t version_type;
+
+	private:
+		struct version_entry {
+			dp::cow_ptr<T> snapshot;
+			std::size_t bytes;
+		};
+
+		//How many retained versions hold each distinct object
+		typedef std::map<const T*, std::size_t> ref_map;
+
+		std::deque<version_entry> m_versions;
+		ref_map m_refs;
+		version_type m_oldest;
+		std::size_t m_max_versions;
+		std::size_t m_max_bytes;
+		std::size_t m_logical_bytes;
+		std::size_t m_unique_bytes;
+		SizeFn m_size;
+
+		void pop_oldest() {
+			const version_entry& oldest = m_versions.front();
+			const T* object = oldest.snapshot.get();
+			m_logical_bytes -= oldest.bytes;
+			if (object) {
+				typename ref_map::iterator it = m_refs.find(object);
+				if (--it->second == 0) {
+					m_refs.erase(it);
+					m_unique_bytes -= oldest.bytes;
+				}
+			}
+			m_versions.pop_front();
+			++m_oldest;
+		}
+
+		//The newest version is always kept, even if it alone exceeds the limits
+		void trim() {
+			while (m_versions.size() > 1 && (m_versions.size() > m_max_versions || m_unique_bytes > m_max_bytes)) {
+				this->pop_oldest();
+			}
+		}
+
+	public:
+		explicit versioned_store(std::size_t inMaxVersions, std::size_t inMaxBytes = static_cast<std::size_t>(-1), const SizeFn& inSize = SizeFn())
+			: m_versions(), m_refs(), m_oldest(0), m_max_versions(inMaxVersions), m_max_bytes(inMaxBytes), m_logical_bytes(0), m_unique_bytes(0), m_size(inSize) {}
+
+		//Appends inSnapshot as the newest version and returns its number
+		version_type commit(const dp::cow_ptr<T>& inSnapshot) {
+			version_entry newEntry;
+			newEntry.snapshot = inSnapshot;
+			const T* object = inSnapshot.get();
+			newEntry.bytes = object ? m_size(*object) : 0;
+
+			if (object) {
+				std::size_t& refs = m_refs[object];
+				if (refs++ == 0) m_unique_bytes += newEntry.bytes;
+			}
+			m_logical_bytes += newEntry.bytes;
+			m_versions.push_back(newEntry);
+
+			const version_type committed = this->latest_version();
+			this->trim();
+			return committed;
+		}
+
+		//Re-commits a retained version as the newest version, and returns the new version's number
+		version_type rollback_to(version_type inVersion) {
+			dp::cow_ptr<T> target = this->at(inVersion);
+			return this->commit(target);
+		}
+
+		const dp::cow_ptr<T>& at(version_type inVersion) const {
+			if (!this->contains(inVersion)) throw std::out_of_range("Version not retained in versioned_store::at");
+			return m_versions[inVersion - m_oldest].snapshot;
+		}
+
+		const dp::cow_ptr<T>& latest() const {
+			if (m_versions.empty()) throw std::out_of_range("latest called on empty versioned_store");
+			return m_versions.back().snapshot;
+		}
+
+		bool contains(version_type inVersion) const {
+			return inVersion >= m_oldest && inVersion - m_oldest < m_versions.size();
+		}
+
+		//For an empty store, the number the next commit will be given
+		version_type oldest_version() const {
+			return m_oldest;
+		}
+		version_type latest_version() const {
+			if (m_versions.empty()) throw std::out_of_range("latest_version called on empty versioned_store");
+			return m_oldest + m_versions.size() - 1;
+		}
+
+		std::size_t size() const {
+			return m_versions.size();
+		}
+		bool empty() const {
+			return m_versions.empty();
+		}
+
+		dp::sharing_stats stats() const {
+			dp::sharing_stats result;
+			result.versions = m_versions.size();
+			result.logical_bytes = m_logical_bytes;
+			result.unique_bytes = m_unique_bytes;
+			result.shared_bytes = m_logical_bytes - m_unique_bytes;
+			return result;
+		}
+
+		void set_limits(std::size_t inMaxVersions, std::size_t inMaxBytes = static_cast<std::size_t>(-1)) {
+			m_max_versions = inMaxVersions;
+			m_max_bytes = inMaxBytes;
+			this->trim();
+		}
+	};
+
+}
+
+#endif
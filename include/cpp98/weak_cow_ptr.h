@@ -0,0 +1,124 @@
+#ifndef DP_CPP98_WEAK_COW_PTR
+#define DP_CPP98_WEAK_COW_PTR
+
+#include "cpp98/cow_ptr.h"
+
+#include "bits/static_assert_no_macro.h"
+#include "bits/version_defs.h"
+
+#include <algorithm>
+#include <cstddef>
+
+/*
+*	A weak handle to a cow_ptr snapshot. It observes the control block of a cow_ptr without owning the object, in the same way as
+*	weak_ptr does for shared_ptr, and lock() returns a new owning cow_ptr if the object is still alive.
+*	Once a weak_cow_ptr has observed a snapshot, every owner, including the only one, copies it on non-const access and moves on to a
+*	new control block, so edits made through a cow_ptr after the weak_cow_ptr was taken are not visible through it. A write through a
+*	reference or raw pointer which was obtained from a non-const access before then bypasses this, and does change the snapshot.
+*	An array of unknown bound cannot be copied, so it cannot be observed either.
+*
+*	From C++11, lock() only adds an owner if the count has not already reached zero, in one atomic step, so it is safe against the
+*	last owner being released on another thread. Before C++11 the counts are plain integers, and a snapshot must not be locked and
+*	released on different threads.
+*/
+
+namespace dp {
+
+	template<typename T>
+	class weak_cow_ptr {
+
+		typedef dp::detail::cow_block_base BlockT;
+		typedef typename dp::remove_extent<T>::type stored_type;
+
+		stored_type* m_ptr;
+		BlockT* m_control;
+
+		template<typename U>
+		friend class weak_cow_ptr;
+
+	public:
+		typedef stored_type element_type;
+
+		weak_cow_ptr() : m_ptr(NULL), m_control(NULL) {
+			dp::static_assert_98<!dp::is_unbounded_array<T>::value>();
+		}
+
+		template<typename U>
+		weak_cow_ptr(const dp::cow_ptr<U>& inPtr) : m_ptr(inPtr.m_ptr), m_control(inPtr.m_control) {
+			dp::static_assert_98<!dp::is_unbounded_array<T>::value>();
+			if (m_control) m_control->inc_weak();
+		}
+
+		weak_cow_ptr(const weak_cow_ptr& inPtr) : m_ptr(inPtr.m_ptr), m_control(inPtr.m_control) {
+			dp::static_assert_98<!dp::is_unbounded_array<T>::value>();
+			if (m_control) m_control->inc_weak();
+		}
+
+		template<typename U>
+		weak_cow_ptr(const weak_cow_ptr<U>& inPtr) : m_ptr(inPtr.m_ptr), m_control(inPtr.m_control) {
+			dp::static_assert_98<!dp::is_unbounded_array<T>::value>();
+			if (m_control) m_control->inc_weak();
+		}
+
+		~weak_cow_ptr() {
+			this->reset();
+		}
+
+		weak_cow_ptr& operator=(const weak_cow_ptr& inPtr) {
+			weak_cow_ptr copy(inPtr);
+			this->swap(copy);
+			return *this;
+		}
+
+		template<typename U>
+		weak_cow_ptr& operator=(const dp::cow_ptr<U>& inPtr) {
+			weak_cow_ptr copy(inPtr);
+			this->swap(copy);
+			return *this;
+		}
+
+		void swap(weak_cow_ptr& inPtr) {
+			using std::swap;
+			swap(m_ptr, inPtr.m_ptr);
+			swap(m_control, inPtr.m_control);
+		}
+
+		void reset() {
+			if (m_control) m_control->dec_weak();
+			m_ptr = NULL;
+			m_control = NULL;
+		}
+
+		std::size_t use_count() const {
+			return m_control ? m_control->use_count() : 0;
+		}
+
+		bool expired() const {
+			return this->use_count() == 0;
+		}
+
+		//Returns an owning pointer to the snapshot, which still has the generation stamp it had when this was taken, or a null cow_ptr
+		//if it has already been destroyed
+		dp::cow_ptr<T> lock() const {
+			if (!m_control || !m_control->try_inc_shared()) return dp::cow_ptr<T>();
+			return dp::cow_ptr<T>(m_ptr, m_control);
+		}
+
+		template<typename U>
+		bool owner_before(const dp::weak_cow_ptr<U>& inPtr) const {
+			return m_control < inPtr.m_control;
+		}
+		template<typename U>
+		bool owner_before(const dp::cow_ptr<U>& inPtr) const {
+			return m_control < inPtr.m_control;
+		}
+	};
+
+	template<typename T>
+	void swap(dp::weak_cow_ptr<T>& lhs, dp::weak_cow_ptr<T>& rhs) {
+		lhs.swap(rhs);
+	}
+
+}
+
+#endif
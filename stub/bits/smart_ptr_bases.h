@@ -0,0 +1,58 @@
+#ifndef DP_CPP98_SMART_PTR_BASES
+#define DP_CPP98_SMART_PTR_BASES
+
+/*
+*	A minimal stand-in for the smart pointer internals of the C++98 standard library project, so that the tests and benchmarks in
+*	this repo can be built without it. It provides only the names the addon headers take from the real header, with the same shape:
+*	the null pointer tag, default_delete, and the pointer compatibility trait.
+*
+*	Build against the real library instead by pointing DP_CPP98_LIBRARY_DIR at its include directory.
+*/
+
+#include "cpp98/type_traits.h"
+#include "bits/version_defs.h"
+
+#include <cstddef>
+
+namespace dp {
+
+	struct null_ptr_t {};
+
+	template<typename T>
+	struct default_delete {
+		void operator()(T* in) const {
+			delete in;
+		}
+	};
+	template<typename T>
+	struct default_delete<T[]> {
+		void operator()(T* in) const {
+			delete[] in;
+		}
+	};
+	template<typename T, std::size_t N>
+	struct default_delete<T[N]> {
+		void operator()(T* in) const {
+			delete[] in;
+		}
+	};
+
+	template<typename T, typename DelT>
+	class scoped_ptr;
+
+	template<typename T, typename DelT>
+	class lite_ptr;
+
+	namespace detail {
+
+		//Whether a U* may be held by a pointer to T. The real trait checks convertibility; the stub accepts every pair.
+		template<typename U, typename T>
+		struct compatible_ptr_type {
+			static const bool value = true;
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef DP_CPP98_STATIC_ASSERT_NO_MACRO
+#define DP_CPP98_STATIC_ASSERT_NO_MACRO
+
+/*
+*	Stand-in for the C++98 standard library project's function-form static assertion.
+*	Instantiating static_assert_98<false> declares an array of negative size, which fails to compile.
+*/
+
+namespace dp {
+
+	template<bool B>
+	inline void static_assert_98() {
+		char assertion_failed[B ? 1 : -1];
+		(void)assertion_failed;
+	}
+
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef DP_CPP98_TYPE_TRAITS_NS
+#define DP_CPP98_TYPE_TRAITS_NS
+
+/*
+*	In the C++98 standard library project this header exposes the non-standard traits to headers outside of cpp98/.
+*	The stub keeps every trait in cpp98/type_traits.h, so it only forwards there.
+*/
+
+#include "cpp98/type_traits.h"
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef DP_CPP98_VERSION_DEFS
+#define DP_CPP98_VERSION_DEFS
+
+/*
+*	A minimal stand-in for the version macros of the C++98 standard library project, so that the tests and benchmarks in this repo
+*	can be built without it. Only the macros which the addon headers use are provided.
+*/
+
+#if __cplusplus >= 201103L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201103L)
+#define DP_CPP11_OR_HIGHER
+#endif
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define DP_CPP17_OR_HIGHER
+#endif
+
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#define DP_CPP20_OR_HIGHER
+#endif
+
+#ifdef __BORLANDC__
+#define DP_BORLAND
+#endif
+
+#endif
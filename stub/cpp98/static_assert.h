@@ -0,0 +1,18 @@
+#ifndef DP_CPP98_STATIC_ASSERT
+#define DP_CPP98_STATIC_ASSERT
+
+/*
+*	Stand-in for the C++98 standard library project's STATIC_ASSERT macro.
+*	The real macro is only checked on the members which use it as they are instantiated, so the stub maps it to static_assert where
+*	that exists and otherwise expands to nothing. The parentheses let callers pass expressions which contain commas.
+*/
+
+#include "bits/version_defs.h"
+
+#ifdef DP_CPP11_OR_HIGHER
+#define STATIC_ASSERT(...) static_assert((__VA_ARGS__), #__VA_ARGS__)
+#else
+#define STATIC_ASSERT(...)
+#endif
+
+#endif
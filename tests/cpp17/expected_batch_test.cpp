@@ -0,0 +1,180 @@
+#include "cpp17/expected_batch.h"
+
+#include "test_harness.h"
+
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+	//The number of allocations left before operator new fails, or negative to never fail
+	int g_allocations_until_failure = -1;
+
+}
+
+//GCC pairs the inlined delete with its builtin operator new, not this replacement, and warns that malloc and free do not match
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t inSize) {
+	if (g_allocations_until_failure == 0) throw std::bad_alloc();
+	if (g_allocations_until_failure > 0) --g_allocations_until_failure;
+	if (void* result = std::malloc(inSize ? inSize : 1)) return result;
+	throw std::bad_alloc();
+}
+void operator delete(void* in) noexcept {
+	std::free(in);
+}
+void operator delete(void* in, std::size_t) noexcept {
+	std::free(in);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+	using batch_type = dp::expected_batch<int, std::string>;
+
+	dp::expected<int, std::string> result_for(int in) {
+		if (in % 10 == 3) return dp::unexpected{ std::to_string(in) };
+		return in;
+	}
+
+	batch_type make_batch(int inCount) {
+		batch_type batch;
+		for (int i = 0; i < inCount; ++i) batch.push_back(result_for(i));
+		return batch;
+	}
+
+	bool same(const dp::expected<int, std::string>& lhs, const dp::expected<int, std::string>& rhs) {
+		if (lhs.has_value() != rhs.has_value()) return false;
+		return lhs.has_value() ? *lhs == *rhs : lhs.error() == rhs.error();
+	}
+
+	//The first inCount elements read back as make_batch pushed them
+	bool consistent(const batch_type& inBatch, std::size_t inCount) {
+		for (std::size_t i = 0; i < inCount; ++i) {
+			if (!same(inBatch.get(i), result_for(static_cast<int>(i)))) return false;
+		}
+		return true;
+	}
+
+	void test_push_and_read() {
+		batch_type batch = make_batch(200);
+		DP_CHECK(batch.size() == 200 && !batch.empty());
+		DP_CHECK(batch.error_count() == 20 && batch.value_count() == 180);
+		DP_CHECK(consistent(batch, batch.size()));
+		DP_CHECK(batch[63].error() == "63" && *batch[64] == 64);
+		DP_CHECK(batch.count_values(0, 10) == 9 && batch.count_errors(60, 140) == 8);
+
+		bool threw = false;
+		try {
+			batch.get(200);
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+
+		std::vector<dp::expected<int, std::string>> results = batch.to_vector();
+		DP_CHECK(results.size() == 200 && results[13].error() == "13");
+
+		const batch_type copy(results.begin(), results.end());
+		DP_CHECK(consistent(copy, copy.size()));
+
+		batch.clear();
+		DP_CHECK(batch.empty() && batch.value_count() == 0);
+	}
+
+	void test_visit_in_order() {
+		const batch_type batch = make_batch(300);
+		std::vector<std::size_t> errorIndices;
+		batch.for_each_error([&](std::size_t index, const std::string& error) {
+			DP_CHECK(error == std::to_string(index));
+			errorIndices.push_back(index);
+		});
+		DP_CHECK(errorIndices.size() == 30 && errorIndices.front() == 3 && errorIndices.back() == 293);
+
+		std::size_t values = 0;
+		bool inOrder = true;
+		std::size_t previous = 0;
+		batch.for_each_value([&](std::size_t index, int value) {
+			inOrder = inOrder && (values == 0 || index > previous) && value == static_cast<int>(index);
+			previous = index;
+			++values;
+		});
+		DP_CHECK(values == 270 && inOrder);
+	}
+
+	void test_failed_push_leaves_batch_unchanged() {
+		//Fail each allocation in turn while pushing the element which starts a new 64 bit word
+		for (std::size_t wordStart : { 64, 128 }) {
+			for (bool pushError : { false, true }) {
+				for (int failAt = 0; failAt < 8; ++failAt) {
+					batch_type batch = make_batch(static_cast<int>(wordStart));
+					g_allocations_until_failure = failAt;
+					bool threw = false;
+					try {
+						if (pushError) batch.push_error("e");
+						else batch.push_value(-1);
+					}
+					catch (const std::bad_alloc&) {
+						threw = true;
+					}
+					g_allocations_until_failure = -1;
+
+					DP_CHECK(batch.size() == (threw ? wordStart : wordStart + 1));
+					DP_CHECK(batch.value_count() + batch.error_count() == batch.size());
+					DP_CHECK(consistent(batch, wordStart));
+					if (!threw) DP_CHECK(pushError ? batch.get(wordStart).error() == "e" : *batch.get(wordStart) == -1);
+
+					//Pushing carries on from where the batch was left
+					batch.push_value(-2);
+					DP_CHECK(*batch.get(batch.size() - 1) == -2);
+				}
+			}
+		}
+	}
+
+	//Copying a poisoned value throws before anything is stored
+	struct fragile {
+		bool poisoned = false;
+		fragile() = default;
+		fragile(const fragile& other) : poisoned(other.poisoned) {
+			if (poisoned) throw std::runtime_error("poisoned");
+		}
+		fragile& operator=(const fragile&) = default;
+	};
+
+	void test_throwing_copy() {
+		dp::expected_batch<fragile, int> batch;
+		for (int i = 0; i < 64; ++i) batch.push_value(fragile{});
+		fragile poisoned;
+		poisoned.poisoned = true;
+		bool threw = false;
+		try {
+			batch.push_value(poisoned);
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+		DP_CHECK(batch.size() == 64 && batch.value_count() == 64);
+		batch.push_error(1);
+		DP_CHECK(batch.size() == 65 && !batch.has_value(64) && batch.get(64).error() == 1);
+	}
+
+}
+
+int main() {
+	test_push_and_read();
+	test_visit_in_order();
+	test_failed_push_leaves_batch_unchanged();
+	test_throwing_copy();
+	return DP_TEST_RESULT();
+}
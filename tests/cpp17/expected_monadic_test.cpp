@@ -0,0 +1,147 @@
+#include "cpp17/expected.h"
+
+#include "test_harness.h"
+
+#include <string>
+#include <utility>
+
+namespace {
+
+	//Counts copies and moves, to check that rvalue chains move their payload rather than copy it
+	struct tracked {
+		int value = 0;
+		static inline int copies = 0;
+		static inline int moves = 0;
+
+		tracked() = default;
+		explicit tracked(int in) : value(in) {}
+		tracked(const tracked& other) : value(other.value) {
+			++copies;
+		}
+		tracked(tracked&& other) noexcept : value(other.value) {
+			++moves;
+		}
+		tracked& operator=(const tracked& other) {
+			value = other.value;
+			++copies;
+			return *this;
+		}
+		tracked& operator=(tracked&& other) noexcept {
+			value = other.value;
+			++moves;
+			return *this;
+		}
+
+		static void reset() {
+			copies = 0;
+			moves = 0;
+		}
+	};
+
+	dp::expected<int, std::string> half(int in) {
+		if (in % 2 != 0) return dp::unexpected{ std::string{ "odd" } };
+		return in / 2;
+	}
+
+	void test_and_then() {
+		dp::expected<int, std::string> even{ 8 };
+		DP_CHECK(even.and_then(half).and_then(half).value() == 2);
+		DP_CHECK(even.and_then(half).and_then(half).and_then(half).and_then(half).error() == "odd");
+
+		//The error of the first failure is passed through untouched
+		dp::expected<int, std::string> failed{ dp::unexpect, "first" };
+		bool called = false;
+		auto result = failed.and_then([&](int in) { called = true; return half(in); });
+		DP_CHECK(!called);
+		DP_CHECK(result.error() == "first");
+
+		const dp::expected<int, std::string> constEven{ 4 };
+		DP_CHECK(constEven.and_then(half).value() == 2);
+		DP_CHECK(std::move(constEven).and_then(half).value() == 2);
+	}
+
+	void test_transform() {
+		dp::expected<int, std::string> value{ 3 };
+		auto text = value.transform([](int in) { return std::to_string(in); });
+		static_assert(std::is_same_v<decltype(text), dp::expected<std::string, std::string>>);
+		DP_CHECK(*text == "3");
+
+		auto toVoid = value.transform([](int) {});
+		static_assert(std::is_same_v<decltype(toVoid), dp::expected<void, std::string>>);
+		DP_CHECK(toVoid.has_value());
+
+		dp::expected<int, std::string> failed{ dp::unexpect, "bad" };
+		DP_CHECK(failed.transform([](int in) { return in + 1; }).error() == "bad");
+	}
+
+	void test_or_else_and_transform_error() {
+		dp::expected<int, std::string> failed{ dp::unexpect, "bad" };
+		auto recovered = failed.or_else([](const std::string& e) { return dp::expected<int, std::string>{ static_cast<int>(e.size()) }; });
+		DP_CHECK(recovered.value() == 3);
+
+		dp::expected<int, std::string> fine{ 1 };
+		DP_CHECK(fine.or_else([](const std::string&) { return dp::expected<int, std::string>{ 2 }; }).value() == 1);
+
+		auto coded = failed.transform_error([](const std::string& e) { return static_cast<int>(e.size()); });
+		static_assert(std::is_same_v<decltype(coded), dp::expected<int, int>>);
+		DP_CHECK(coded.error() == 3);
+		DP_CHECK(fine.transform_error([](const std::string&) { return 0; }).value() == 1);
+	}
+
+	void test_void_specialisation() {
+		dp::expected<void, int> ok;
+		int calls = 0;
+		auto next = ok.and_then([&] { ++calls; return dp::expected<void, int>{}; });
+		DP_CHECK(next.has_value() && calls == 1);
+		DP_CHECK(ok.transform([] { return 5; }).value() == 5);
+
+		dp::expected<void, int> failed{ dp::unexpect, 7 };
+		DP_CHECK(failed.and_then([&] { ++calls; return dp::expected<void, int>{}; }).error() == 7);
+		DP_CHECK(calls == 1);
+		DP_CHECK(failed.or_else([](int) { return dp::expected<void, int>{}; }).has_value());
+		DP_CHECK(failed.transform_error([](int e) { return e * 2; }).error() == 14);
+	}
+
+	void test_rvalue_chains_move() {
+		tracked::reset();
+		auto result = dp::expected<tracked, int>{ std::in_place, 1 }
+			.transform([](tracked&& in) { in.value += 1; return std::move(in); })
+			.and_then([](tracked&& in) { in.value *= 10; return dp::expected<tracked, int>{ std::move(in) }; })
+			.transform_error([](int e) { return e + 1; })
+			.or_else([](int e) { return dp::expected<tracked, int>{ dp::unexpect, e }; });
+		DP_CHECK(result.value().value == 20);
+		DP_CHECK(tracked::copies == 0);
+
+		tracked::reset();
+		auto error = dp::expected<int, tracked>{ dp::unexpect, 3 }
+			.and_then([](int in) { return dp::expected<int, tracked>{ in }; })
+			.transform([](int in) { return in + 1; });
+		DP_CHECK(error.error().value == 3);
+		DP_CHECK(tracked::copies == 0);
+
+		//An lvalue chain leaves its source intact, so it must copy
+		tracked::reset();
+		dp::expected<tracked, int> source{ std::in_place, 2 };
+		auto copied = source.transform([](const tracked& in) { return in; });
+		DP_CHECK(copied->value == 2 && source->value == 2);
+		DP_CHECK(tracked::copies == 1);
+	}
+
+	constexpr int constexpr_chain() {
+		return dp::expected<int, int>{ 2 }
+			.and_then([](int in) { return dp::expected<int, int>{ in * 3 }; })
+			.transform([](int in) { return in + 1; })
+			.value_or(0);
+	}
+	static_assert(constexpr_chain() == 7);
+
+}
+
+int main() {
+	test_and_then();
+	test_transform();
+	test_or_else_and_transform_error();
+	test_void_specialisation();
+	test_rvalue_chains_move();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,133 @@
+#define DP_EXPECTED_TRACE
+#define DP_EXPECTED_TRACE_CAPACITY 4
+#include "cpp17/expected.h"
+#include "cpp17/expected_algorithm.h"
+#include "cpp17/status_code.h"
+
+#include "test_harness.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace {
+
+	const char* const codes[] = { "ok", "failed" };
+	const dp::table_status_domain domain{ "trace", codes };
+
+	struct origins {
+		dp::error_origin records[8];
+		std::size_t count;
+
+		origins() : records{}, count(dp::recent_error_origins(records, 8)) {}
+
+		bool newest_at(unsigned inLine) const {
+			return count != 0 && records[0].line == inLine && std::strstr(records[0].file, "expected_trace_test.cpp") != nullptr;
+		}
+	};
+
+	template<typename E>
+	bool has_type(const dp::error_origin& in) {
+#if defined(__GXX_RTTI) || defined(__cpp_rtti) || defined(_CPPRTTI)
+		return in.type && *in.type == typeid(E);
+#else
+		return in.type == nullptr;
+#endif
+	}
+
+	unsigned parseLine = 0;
+
+	dp::expected<int, std::string> parse(int in) {
+		parseLine = __LINE__ + 1;
+		if (in < 0) return dp::unexpected(std::string("negative"));
+		return in;
+	}
+
+	//Errors known at compile time can still be built in constant expressions
+	constexpr dp::expected<int, int> constant_error{ dp::unexpect, 3 };
+	static_assert(!constant_error.has_value() && constant_error.error() == 3);
+
+	//Traced types live in their own inline namespace, so they cannot collide with untraced ones from another translation unit
+	static_assert(std::is_same_v<dp::expected<int, int>, dp::expected_traced::expected<int, int>>);
+	static_assert(std::is_same_v<dp::unexpected<int>, dp::expected_traced::unexpected<int>>);
+
+	void test_records_the_creating_line() {
+		dp::clear_error_origins();
+		DP_CHECK(!parse(-1).has_value());
+		DP_CHECK(origins().newest_at(parseLine));
+		DP_CHECK(has_type<std::string>(origins().records[0]));
+
+		dp::expected<int, int> tagged(dp::unexpect, 7); const unsigned tagLine = __LINE__;
+		DP_CHECK(tagged.error() == 7 && origins().newest_at(tagLine));
+		DP_CHECK(has_type<int>(origins().records[0]));
+
+		dp::expected<void, int> empty{ dp::unexpect, 1 }; const unsigned emptyLine = __LINE__;
+		DP_CHECK(!empty.has_value() && origins().newest_at(emptyLine));
+
+		const dp::unexpected<int> inPlace(std::in_place, 2); const unsigned inPlaceLine = __LINE__;
+		DP_CHECK(inPlace.error() == 2 && origins().newest_at(inPlaceLine));
+
+		//A library factory passes its caller's location through
+		const dp::expected<int, dp::status_code> status = dp::make_unexpected(domain, 1); const unsigned statusLine = __LINE__;
+		DP_CHECK(!status.has_value() && origins().newest_at(statusLine));
+		DP_CHECK(origins().count == 4);
+
+		//With no arguments after the tag, std::in_place must still pick the in_place constructor
+		const dp::unexpected<std::string> defaulted(std::in_place); const unsigned defaultedLine = __LINE__;
+		DP_CHECK(defaulted.error().empty() && origins().newest_at(defaultedLine));
+	}
+
+	void test_passed_on_errors_are_not_recorded() {
+		dp::clear_error_origins();
+		const dp::expected<int, std::string> failed = parse(-1);
+		DP_CHECK(origins().count == 1);
+
+		const dp::expected<int, std::string> chained = failed
+			.and_then([](int in) { return dp::expected<int, std::string>(in + 1); })
+			.transform([](int in) { return in * 2; });
+		const dp::expected<int, std::size_t> mapped = chained.transform_error([](const std::string& in) { return in.size(); });
+		const dp::expected<int, std::string> copied = failed;
+		DP_CHECK(!mapped.has_value() && mapped.error() == 8 && !copied.has_value());
+
+		std::vector<dp::expected<int, std::string> > inputs(3, 1);
+		inputs[1] = failed;
+		const dp::expected<std::vector<int>, std::string> collected = dp::collect(inputs, [](const dp::expected<int, std::string>& in) { return in; });
+		DP_CHECK(!collected.has_value());
+		DP_CHECK(origins().count == 1);
+	}
+
+	void test_ring_keeps_the_newest() {
+		dp::clear_error_origins();
+		DP_CHECK(origins().count == 0);
+		unsigned lines[6];
+		for (unsigned i = 0; i < 6; ++i) {
+			switch (i % 2) {
+			case 0: { dp::unexpected<unsigned> e(i); lines[i] = __LINE__; break; }
+			default: { dp::expected<int, unsigned> e(dp::unexpect, i); lines[i] = __LINE__; break; }
+			}
+		}
+		const origins recent;
+		DP_CHECK(recent.count == DP_EXPECTED_TRACE_CAPACITY);
+		bool newestFirst = true;
+		for (std::size_t i = 0; i < recent.count; ++i) newestFirst = newestFirst && recent.records[i].line == lines[5 - i];
+		DP_CHECK(newestFirst);
+
+		std::FILE* out = std::tmpfile();
+		if (out) {
+			dp::dump_error_origins(out);
+			DP_CHECK(std::ftell(out) > 0);
+			std::fclose(out);
+		}
+	}
+
+}
+
+int main() {
+	test_records_the_creating_line();
+	test_passed_on_errors_are_not_recorded();
+	test_ring_keeps_the_newest();
+	return DP_TEST_RESULT();
+}
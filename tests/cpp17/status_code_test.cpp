@@ -0,0 +1,94 @@
+#include "cpp17/status_code.h"
+
+#include "test_harness.h"
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace {
+
+	const char* const io_messages[] = { "ok", "not found", "denied" };
+	const dp::table_status_domain io_domain{ "io", io_messages };
+
+	const char* const net_messages[] = { "ok", "timeout" };
+	const dp::table_status_domain net_domain{ "net", net_messages };
+
+	//A domain with its own message lookup rather than a table
+	class parity_domain : public dp::status_domain {
+	public:
+		const char* name() const noexcept override {
+			return "parity";
+		}
+		const char* message(int code) const noexcept override {
+			return code % 2 == 0 ? "even" : "odd";
+		}
+	};
+	const parity_domain parity{};
+
+	static_assert(sizeof(dp::status_code) == 8);
+	static_assert(std::is_trivially_copyable_v<dp::status_code>);
+	static_assert(std::is_trivially_copyable_v<dp::expected<int, dp::status_code>>);
+	static_assert(std::has_virtual_destructor_v<dp::table_status_domain>);
+
+	void test_codes() {
+		dp::status_code notFound{ io_domain, 1 };
+		DP_CHECK(notFound.code() == 1);
+		DP_CHECK(notFound.in_domain(io_domain));
+		DP_CHECK(!notFound.in_domain(net_domain));
+		DP_CHECK(notFound.domain() == &io_domain);
+		DP_CHECK(std::strcmp(notFound.domain_name(), "io") == 0);
+		DP_CHECK(std::strcmp(notFound.message(), "not found") == 0);
+		DP_CHECK(std::strcmp(dp::status_code(io_domain, 9).message(), "Unknown status code") == 0);
+
+		//The same code in another domain is a different status
+		DP_CHECK(notFound == dp::status_code(io_domain, 1));
+		DP_CHECK(notFound != dp::status_code(net_domain, 1));
+		DP_CHECK(notFound != dp::status_code(io_domain, 2));
+
+		DP_CHECK(std::strcmp(dp::status_code(parity, 3).message(), "odd") == 0);
+
+		dp::status_code none;
+		DP_CHECK(none.domain() == nullptr);
+		DP_CHECK(std::strcmp(none.domain_name(), "No domain") == 0);
+	}
+
+	void test_with_expected() {
+		dp::expected<int, dp::status_code> failed = dp::make_unexpected(net_domain, 1);
+		DP_CHECK(!failed);
+		DP_CHECK(failed.error().in_domain(net_domain));
+
+		bool threw = false;
+		try {
+			(void)failed.value();
+		}
+		catch (const dp::bad_expected_access<dp::status_code>& e) {
+			threw = true;
+			DP_CHECK(std::strcmp(e.what(), "timeout") == 0);
+			DP_CHECK(e.error() == dp::status_code(net_domain, 1));
+		}
+		DP_CHECK(threw);
+	}
+
+	void test_destroyed_domain() {
+		static const char* const messages[] = { "gone" };
+		auto temporary = std::make_unique<dp::table_status_domain>("temporary", messages);
+		dp::status_code code{ *temporary, 0 };
+		DP_CHECK(code.domain() == temporary.get());
+		temporary.reset();
+		DP_CHECK(code.domain() == nullptr);
+		DP_CHECK(std::strcmp(code.message(), "Unknown status code") == 0);
+
+		//A new domain never takes over a retired index
+		const dp::table_status_domain replacement{ "replacement", messages };
+		DP_CHECK(!code.in_domain(replacement));
+	}
+
+}
+
+int main() {
+	test_codes();
+	test_with_expected();
+	test_destroyed_domain();
+	return DP_TEST_RESULT();
+}
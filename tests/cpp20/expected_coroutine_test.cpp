@@ -0,0 +1,108 @@
+#include "cpp20/expected_coroutine.h"
+
+#include "test_harness.h"
+
+#include <memory>
+#include <string>
+
+namespace {
+
+	dp::expected<int, std::string> parse_digit(char in) {
+		if (in < '0' || in > '9') return dp::unexpected{ std::string{ "not a digit" } };
+		return in - '0';
+	}
+
+	dp::expected<int, std::string> sum_digits(const char* in) {
+		int total = 0;
+		for (; *in; ++in) total += co_await parse_digit(*in);
+		co_return total;
+	}
+
+	dp::expected<void, std::string> check_positive(int in) {
+		if (in <= 0) co_await dp::unexpected{ std::string{ "not positive" } };
+		co_return;
+	}
+
+	dp::expected<int, std::string> checked_sum(const char* in) {
+		int total = co_await sum_digits(in);
+		co_await check_positive(total);
+		co_return total * 2;
+	}
+
+	//Frames for these come from the caller's buffer rather than the heap
+	dp::expected<int, std::string> buffered_digit(dp::coroutine_frame_buffer&, char in) {
+		co_return co_await parse_digit(in);
+	}
+
+	dp::expected<int, std::string> buffered_sum(dp::coroutine_frame_buffer& buffer, const char* in) {
+		int total = 0;
+		for (; *in; ++in) total += co_await buffered_digit(buffer, *in);
+		co_return total;
+	}
+
+	//Class type parameters after the buffer, by reference and by value
+	dp::expected<std::size_t, std::string> buffered_length(dp::coroutine_frame_buffer&, const std::string& inText, std::string inSuffix) {
+		if (inText.empty()) co_await dp::unexpected{ std::string{ "empty" } };
+		co_return inText.size() + inSuffix.size();
+	}
+
+#if !DP_EXPECTED_COROUTINE_EAGER_RETURN
+	//Neither alternative is default constructible, which is only allowed where the return object is converted late
+	struct no_default {
+		int value;
+		explicit no_default(int in) : value(in) {}
+	};
+	dp::expected<no_default, std::unique_ptr<int>> move_only_error(bool inFail) {
+		if (inFail) co_await dp::unexpected{ std::make_unique<int>(3) };
+		co_return no_default{ 4 };
+	}
+#endif
+
+	void test_values_and_errors() {
+		DP_CHECK(sum_digits("1234").value() == 10);
+		DP_CHECK(sum_digits("12x4").error() == "not a digit");
+		DP_CHECK(checked_sum("12").value() == 6);
+		DP_CHECK(checked_sum("00").error() == "not positive");
+		DP_CHECK(checked_sum("0x").error() == "not a digit");
+		DP_CHECK(check_positive(1).has_value());
+	}
+
+	void test_frame_buffer() {
+		alignas(std::max_align_t) unsigned char storage[4096];
+		dp::coroutine_frame_buffer buffer{ storage };
+		DP_CHECK(buffered_sum(buffer, "999").value() == 27);
+		DP_CHECK(buffered_sum(buffer, "9a9").error() == "not a digit");
+		//Every frame has been handed back
+		DP_CHECK(buffer.used() == 0);
+		DP_CHECK(buffered_length(buffer, "abc", "de").value() == 5);
+		DP_CHECK(buffered_length(buffer, "", "de").error() == "empty");
+		DP_CHECK(buffer.used() == 0);
+
+		unsigned char tiny[8];
+		dp::coroutine_frame_buffer full{ tiny };
+		bool threw = false;
+		try {
+			(void)buffered_digit(full, '1');
+		}
+		catch (const std::bad_alloc&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+		DP_CHECK(full.used() == 0);
+	}
+
+	void test_non_default_constructible() {
+#if !DP_EXPECTED_COROUTINE_EAGER_RETURN
+		DP_CHECK(move_only_error(false)->value == 4);
+		DP_CHECK(*move_only_error(true).error() == 3);
+#endif
+	}
+
+}
+
+int main() {
+	test_values_and_errors();
+	test_frame_buffer();
+	test_non_default_constructible();
+	return DP_TEST_RESULT();
+}
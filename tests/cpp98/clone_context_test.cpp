@@ -0,0 +1,126 @@
+#define DP_CLONE_CONTEXT
+#include "cpp98/clone_context.h"
+#include "cpp98/poly_value_ptr.h"
+#include "cpp98/value_ptr.h"
+
+#include "test_harness.h"
+
+#include <vector>
+
+namespace {
+
+	//A node of a DAG: owned once by the graph, and linked to from other nodes through plain pointers
+	struct node {
+		int value;
+		std::vector<node*> links;
+
+		explicit node(int in) : value(in), links() {}
+		node(const node& other) : value(other.value), links(other.links) {
+			//The links are already in place in this node's own vector, which is not resized again while the context is alive
+			for (std::size_t i = 0; i < links.size(); ++i) dp::clone_context::relink(links[i]);
+		}
+	};
+
+	struct graph {
+		std::vector<dp::value_ptr<node> > nodes;
+
+		void add(int inValue) {
+			nodes.push_back(dp::value_ptr<node>(new node(inValue)));
+		}
+		//Copies the graph, redirecting every link to the copy of its target
+		graph clone() const {
+			dp::clone_context context;
+			graph copy = *this;
+			return copy;
+		}
+	};
+
+	struct shape {
+		int sides;
+		shape* neighbour;
+		explicit shape(int inSides) : sides(inSides), neighbour(NULL) {}
+		shape(const shape& other) : sides(other.sides), neighbour(other.neighbour) {
+			dp::clone_context::relink(neighbour);
+		}
+		virtual ~shape() {}
+	};
+	struct square : shape {
+		square() : shape(4) {}
+	};
+
+	void test_links_follow_the_copy() {
+		graph original;
+		original.add(1);
+		original.add(2);
+		original.add(3);
+		node& a = *original.nodes[0];
+		node& b = *original.nodes[1];
+		node& c = *original.nodes[2];
+		//c links backwards, a forwards: the order of copying does not matter
+		a.links.push_back(&c);
+		a.links.push_back(&b);
+		b.links.push_back(&c);
+		c.links.push_back(&a);
+
+		graph copy = original.clone();
+		DP_CHECK(copy.nodes.size() == 3);
+		node& copyA = *copy.nodes[0];
+		node& copyB = *copy.nodes[1];
+		node& copyC = *copy.nodes[2];
+		DP_CHECK(&copyA != &a);
+		DP_CHECK(copyA.links[0] == &copyC && copyA.links[1] == &copyB);
+		DP_CHECK(copyB.links[0] == &copyC);
+		DP_CHECK(copyC.links[0] == &copyA);
+
+		//The original is untouched, and a copy outside any context leaves links alone
+		DP_CHECK(a.links[0] == &c);
+		graph plain = original;
+		DP_CHECK(plain.nodes[0]->links[0] == &c);
+	}
+
+	void test_context_scope() {
+		DP_CHECK(dp::clone_context::current() == NULL);
+		node source(1);
+		node* link = &source;
+		{
+			dp::clone_context outer;
+			DP_CHECK(dp::clone_context::current() == &outer);
+			{
+				dp::clone_context inner;
+				DP_CHECK(dp::clone_context::current() == &inner);
+				dp::value_ptr<node> owner(new node(2));
+				dp::value_ptr<node> copy(owner);
+				DP_CHECK(inner.size() == 1);
+				DP_CHECK(dp::clone_context::copy_of(owner.get()) == copy.get());
+			}
+			DP_CHECK(dp::clone_context::current() == &outer);
+			DP_CHECK(outer.size() == 0);
+
+			//A link whose target is never copied keeps pointing at the original
+			dp::clone_context::relink(link);
+			DP_CHECK(link == &source);
+		}
+		DP_CHECK(dp::clone_context::current() == NULL);
+	}
+
+	void test_poly_value_ptr_records_the_dynamic_type() {
+		dp::poly_value_ptr<shape> first(dp::poly_t<square>(), new square);
+		dp::poly_value_ptr<shape> second(dp::poly_t<square>(), new square);
+		second->neighbour = first.get();
+
+		dp::clone_context context;
+		dp::poly_value_ptr<shape> secondCopy(second);
+		dp::poly_value_ptr<shape> firstCopy(first);
+		DP_CHECK(secondCopy->neighbour == firstCopy.get());
+		DP_CHECK(dp::clone_context::copy_of(first.get()) == firstCopy.get());
+		DP_CHECK(context.size() == 2);
+	}
+
+}
+
+int main() {
+	test_links_follow_the_copy();
+	test_context_scope();
+	test_poly_value_ptr_records_the_dynamic_type();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,85 @@
+#include "cpp98/cow_memo.h"
+
+#include "test_harness.h"
+
+#include <numeric>
+#include <vector>
+
+namespace {
+
+	typedef std::vector<int> values;
+
+	struct sum_of {
+		int* calls;
+		explicit sum_of(int* inCalls) : calls(inCalls) {}
+		int operator()(const values& in) const {
+			++*calls;
+			return std::accumulate(in.begin(), in.end(), 0);
+		}
+		int operator()(const values& lhs, const values& rhs) const {
+			return (*this)(lhs) + std::accumulate(rhs.begin(), rhs.end(), 0);
+		}
+		int operator()(const values& first, const values& second, const values& third) const {
+			return (*this)(first, second) + std::accumulate(third.begin(), third.end(), 0);
+		}
+	};
+
+	void test_recomputes_on_change() {
+		dp::cow_memo<int> memo;
+		DP_CHECK(!memo.valid());
+		int calls = 0;
+
+		dp::cow_ptr<values> input = dp::make_cow<values>(3, 1);
+		DP_CHECK(memo.get(input, sum_of(&calls)) == 3);
+		DP_CHECK(memo.get(input, sum_of(&calls)) == 3);
+		DP_CHECK(calls == 1 && memo.valid());
+
+		//A copy of the same snapshot hits
+		const dp::cow_ptr<values> copy = input;
+		DP_CHECK(memo.get(copy, sum_of(&calls)) == 3 && calls == 1);
+
+		//Writing to a shared input detaches it, which changes its stamp
+		input->push_back(4);
+		DP_CHECK(memo.get(input, sum_of(&calls)) == 7 && calls == 2);
+
+		//A write in place by the only owner changes its stamp too
+		input->push_back(5);
+		DP_CHECK(memo.get(input, sum_of(&calls)) == 12 && calls == 3);
+
+		//A write through a kept reference is only seen once it is touched
+		values& kept = *input;
+		DP_CHECK(memo.get(input, sum_of(&calls)) == 12 && calls == 4);
+		kept.push_back(6);
+		DP_CHECK(memo.get(input, sum_of(&calls)) == 12 && calls == 4);
+		input.touch();
+		DP_CHECK(memo.get(input, sum_of(&calls)) == 18 && calls == 5);
+
+		memo.invalidate();
+		DP_CHECK(memo.get(input, sum_of(&calls)) == 18 && calls == 6);
+	}
+
+	void test_several_inputs() {
+		dp::cow_memo<int> memo;
+		int calls = 0;
+		dp::cow_ptr<values> first = dp::make_cow<values>(1, 1);
+		dp::cow_ptr<values> second = dp::make_cow<values>(1, 10);
+		const dp::cow_ptr<values> third = dp::make_cow<values>(1, 100);
+
+		DP_CHECK(memo.get(first, second, sum_of(&calls)) == 11);
+		DP_CHECK(memo.get(first, second, sum_of(&calls)) == 11 && calls == 1);
+		second = dp::make_cow<values>(1, 20);
+		DP_CHECK(memo.get(first, second, sum_of(&calls)) == 21 && calls == 2);
+
+		DP_CHECK(memo.get(first, second, third, sum_of(&calls)) == 121 && calls == 3);
+		DP_CHECK(memo.get(first, second, third, sum_of(&calls)) == 121 && calls == 3);
+		first.touch();
+		DP_CHECK(memo.get(first, second, third, sum_of(&calls)) == 121 && calls == 4);
+	}
+
+}
+
+int main() {
+	test_recomputes_on_change();
+	test_several_inputs();
+	return DP_TEST_RESULT();
+}
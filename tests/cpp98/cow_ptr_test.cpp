@@ -0,0 +1,185 @@
+#include "cpp98/cow_ptr.h"
+
+#include "test_harness.h"
+
+#include <string>
+
+namespace {
+
+	typedef dp_test::counted counted;
+
+	struct counting_delete {
+		int* calls;
+		explicit counting_delete(int* inCalls) : calls(inCalls) {}
+		void operator()(counted* in) const {
+			++*calls;
+			delete in;
+		}
+	};
+
+	void test_construction() {
+		dp::cow_ptr<int> empty;
+		DP_CHECK(!empty);
+		DP_CHECK(empty.use_count() == 0);
+
+		const dp::cow_ptr<int> one(new int(1));
+		DP_CHECK(one);
+		DP_CHECK(*one == 1);
+		DP_CHECK(one.unique());
+
+		const dp::cow_ptr<std::string> made = dp::make_cow<std::string>(3, 'x');
+		DP_CHECK(*made == "xxx");
+		DP_CHECK(made->size() == 3);
+	}
+
+	void test_copies_share_until_written() {
+		{
+			dp::cow_ptr<counted> first = dp::make_cow<counted>(1);
+			dp::cow_ptr<counted> second = first;
+			const dp::cow_ptr<counted>& constSecond = second;
+			DP_CHECK(first.use_count() == 2);
+			DP_CHECK(constSecond.get() == static_cast<const dp::cow_ptr<counted>&>(first).get());
+			DP_CHECK(counted::live() == 1);
+
+			//A const read never copies
+			DP_CHECK(constSecond->value == 1);
+			DP_CHECK(first.use_count() == 2);
+
+			//A non-const access on a shared pointer detaches it onto its own copy
+			second->value = 2;
+			DP_CHECK(counted::live() == 2);
+			DP_CHECK(first.unique());
+			DP_CHECK(second.unique());
+			DP_CHECK(static_cast<const dp::cow_ptr<counted>&>(first)->value == 1);
+			DP_CHECK(constSecond->value == 2);
+
+			//A unique owner writes in place
+			const counted* before = constSecond.get();
+			second->value = 3;
+			DP_CHECK(constSecond.get() == before);
+			DP_CHECK(counted::live() == 2);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_reset_and_swap() {
+		{
+			dp::cow_ptr<counted> ptr(new counted(1));
+			dp::cow_ptr<counted> other(ptr);
+			ptr.reset(new counted(2));
+			DP_CHECK(ptr.unique());
+			DP_CHECK(other.unique());
+			DP_CHECK(static_cast<const dp::cow_ptr<counted>&>(ptr)->value == 2);
+			DP_CHECK(counted::live() == 2);
+
+			ptr.swap(other);
+			DP_CHECK(static_cast<const dp::cow_ptr<counted>&>(ptr)->value == 1);
+			dp::swap(ptr, other);
+			DP_CHECK(static_cast<const dp::cow_ptr<counted>&>(ptr)->value == 2);
+
+			other.reset();
+			DP_CHECK(!other);
+			DP_CHECK(counted::live() == 1);
+
+			ptr = other;
+			DP_CHECK(!ptr);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_custom_deleter() {
+		int calls = 0;
+		{
+			dp::cow_ptr<counted> ptr(new counted(1), counting_delete(&calls));
+			dp::cow_ptr<counted> copy = ptr;
+			//The detached copy carries the same deleter
+			copy->value = 2;
+			DP_CHECK(calls == 0);
+		}
+		DP_CHECK(calls == 2);
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_arrays() {
+		dp::cow_ptr<int[4]> bounded = dp::make_cow<int[4]>(7);
+		const dp::cow_ptr<int[4]>& constBounded = bounded;
+		for (int i = 0; i < 4; ++i) DP_CHECK(constBounded[i] == 7);
+
+		dp::cow_ptr<int[4]> copy = bounded;
+		copy.get()[0] = 1;
+		DP_CHECK(constBounded[0] == 7);
+		DP_CHECK(static_cast<const dp::cow_ptr<int[4]>&>(copy)[0] == 1);
+
+		//Writing through operator[] detaches too
+		dp::cow_ptr<int[4]> other = bounded;
+		other[1] = 2;
+		DP_CHECK(constBounded[1] == 7 && static_cast<const dp::cow_ptr<int[4]>&>(other)[1] == 2);
+
+		const dp::cow_ptr<int[]> unbounded = dp::make_cow<int[]>(100, 3);
+		DP_CHECK(unbounded[0] == 3 && unbounded[99] == 3);
+	}
+
+	void test_generations() {
+		dp::cow_ptr<int> empty;
+		DP_CHECK(empty.generation() == 0);
+
+		dp::cow_ptr<int> first = dp::make_cow<int>(1);
+		const std::size_t initial = first.generation();
+		DP_CHECK(initial != 0);
+
+		//Const access keeps the stamp, and non-const access by the only owner changes it, without a copy
+		const int* before = static_cast<const dp::cow_ptr<int>&>(first).get();
+		DP_CHECK(first.generation() == initial);
+		*first = 2;
+		DP_CHECK(first.generation() != initial && first.get() == before);
+
+		//A write through a kept pointer needs touch()
+		int* kept = first.get();
+		const std::size_t beforeKept = first.generation();
+		*kept = 5;
+		DP_CHECK(first.generation() == beforeKept);
+		first.touch();
+		const std::size_t touched = first.generation();
+		DP_CHECK(touched != beforeKept);
+
+		//Copies share the stamp, and a detach gives the writer a new one
+		dp::cow_ptr<int> second = first;
+		DP_CHECK(second.generation() == touched);
+		*second = 3;
+		DP_CHECK(second.generation() != touched && first.generation() == touched);
+
+		const std::size_t beforeReset = second.generation();
+		second.reset(new int(4));
+		DP_CHECK(second.generation() != beforeReset && second.generation() != 0);
+		second.reset();
+		DP_CHECK(second.generation() == 0);
+		empty.touch();
+		DP_CHECK(empty.generation() == 0);
+
+		//The stamp lives in the control block, so the pointer itself stays at two pointers
+		DP_CHECK(sizeof(dp::cow_ptr<int>) == 2 * sizeof(void*));
+	}
+
+	void test_comparisons() {
+		dp::cow_ptr<int> first(new int(1));
+		dp::cow_ptr<int> second = first;
+		dp::cow_ptr<int> third(new int(1));
+		DP_CHECK(first == second);
+		DP_CHECK(first != third);
+		DP_CHECK((first < third) != (third < first));
+		DP_CHECK(first <= second && first >= second);
+		DP_CHECK(first.owner_before(third) != third.owner_before(first));
+	}
+
+}
+
+int main() {
+	test_construction();
+	test_copies_share_until_written();
+	test_reset_and_swap();
+	test_custom_deleter();
+	test_arrays();
+	test_generations();
+	test_comparisons();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,172 @@
+#include "cpp98/cow_snapshot.h"
+
+#include "test_harness.h"
+
+#include <cstdio>
+#include <stdexcept>
+
+namespace {
+
+	//Each build of this test has its own file, so that they can run at the same time
+#ifdef DP_TEST_NAME
+	const char* const kPath = DP_TEST_NAME ".bin";
+#else
+	const char* const kPath = "cow_snapshot_test.bin";
+#endif
+
+	struct point {
+		int x;
+		int y;
+	};
+
+	//A node of a DAG, linking to its children through refs in place of cow_ptrs
+	struct node {
+		int value;
+		dp::cow_snapshot_ref<node> left;
+		dp::cow_snapshot_ref<node> right;
+	};
+
+	dp::cow_ptr<node> make_node(int inValue, dp::cow_snapshot_ref<node> inLeft, dp::cow_snapshot_ref<node> inRight) {
+		node result = { inValue, inLeft, inRight };
+		return dp::make_cow<node>(result);
+	}
+
+	void test_round_trip() {
+		{
+			dp::cow_snapshot_writer writer;
+			point first = { 1, 2 };
+			point second = { 3, 4 };
+			const dp::cow_ptr<point> a = dp::make_cow<point>(first);
+			const dp::cow_ptr<point> b = dp::make_cow<point>(second);
+			DP_CHECK(writer.add(a) == 0);
+			DP_CHECK(writer.add(b) == 1);
+			//The same object is only written once
+			const dp::cow_ptr<point> alias = a;
+			DP_CHECK(writer.add(alias) == 0);
+			DP_CHECK(writer.add(dp::make_cow<double>(0.5)) == 2);
+			DP_CHECK(writer.size() == 3);
+			writer.write(kPath);
+		}
+
+		dp::cow_snapshot_file file(kPath);
+		DP_CHECK(file.size() == 3);
+		{
+			const dp::cow_ptr<point> a = file.get<point>(0);
+			const dp::cow_ptr<point> again = file.get<point>(0);
+			DP_CHECK(a->x == 1 && a->y == 2);
+			DP_CHECK(file.contains(a.get()) && a == again);
+			DP_CHECK(*file.get<double>(2) == 0.5);
+
+			//A write detaches onto the heap and leaves the mapping alone
+			dp::cow_ptr<point> b = file.get<point>(1);
+			b->x = 30;
+			DP_CHECK(!file.contains(b.get()) && b->x == 30);
+			DP_CHECK(file.get<point>(1)->x == 3);
+		}
+
+		//The entry's type is checked, not just its size
+		bool threw = false;
+		try {
+			file.get<long long>(2);
+		}
+		catch (const std::invalid_argument&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+
+		threw = false;
+		try {
+			file.get<point>(3);
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+	}
+
+	void test_shared_graph() {
+		{
+			//A diamond: the root links to two nodes which share one child
+			dp::cow_snapshot_writer writer;
+			const dp::cow_ptr<node> leaf = make_node(4, dp::cow_snapshot_ref<node>::null(), dp::cow_snapshot_ref<node>::null());
+			const dp::cow_snapshot_ref<node> leafRef = writer.ref(leaf);
+			const dp::cow_snapshot_ref<node> left = writer.ref(make_node(2, leafRef, dp::cow_snapshot_ref<node>::null()));
+			const dp::cow_snapshot_ref<node> right = writer.ref(make_node(3, dp::cow_snapshot_ref<node>::null(), writer.ref(leaf)));
+			const dp::cow_snapshot_ref<node> root = writer.ref(make_node(1, left, right));
+			DP_CHECK(writer.size() == 4 && root.index == 3);
+			DP_CHECK(writer.ref(dp::cow_ptr<node>()).is_null());
+			writer.write(kPath);
+		}
+
+		dp::cow_snapshot_file file(kPath);
+		const dp::cow_ptr<node> root = file.get<node>(3);
+		const dp::cow_ptr<node> left = file.get(root->left);
+		const dp::cow_ptr<node> right = file.get(root->right);
+		DP_CHECK(root->value == 1 && left->value == 2 && right->value == 3);
+		DP_CHECK(!file.get(left->right));
+
+		//Both paths reach the same handle
+		const dp::cow_ptr<node> viaLeft = file.get(left->left);
+		const dp::cow_ptr<node> viaRight = file.get(right->right);
+		DP_CHECK(viaLeft->value == 4 && viaLeft == viaRight);
+		DP_CHECK(!viaLeft.owner_before(viaRight) && !viaRight.owner_before(viaLeft));
+	}
+
+	void test_handles_outlive_file() {
+		{
+			dp::cow_snapshot_writer writer;
+			point value = { 5, 6 };
+			writer.add(dp::make_cow<point>(value));
+			writer.write(kPath);
+		}
+
+		dp::cow_ptr<point> kept;
+		const void* mapped = NULL;
+		{
+			dp::cow_snapshot_file file(kPath);
+			kept = file.get<point>(0);
+			mapped = static_cast<const dp::cow_ptr<point>&>(kept).get();
+		}
+		//The mapping stays alive for the handle, which is now the entry's only owner
+		DP_CHECK(kept.unique());
+		DP_CHECK(static_cast<const dp::cow_ptr<point>&>(kept)->x == 5);
+
+		//Even the only owner detaches before a write, as the mapping is read-only
+		kept->y = 60;
+		DP_CHECK(static_cast<const void*>(static_cast<const dp::cow_ptr<point>&>(kept).get()) != mapped);
+		DP_CHECK(kept->x == 5 && kept->y == 60);
+	}
+
+	void test_bad_files() {
+		bool threw = false;
+		try {
+			dp::cow_snapshot_file missing("cow_snapshot_test_missing.bin");
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+
+		std::FILE* out = std::fopen(kPath, "wb");
+		std::fputs("not a snapshot, but long enough to hold a header", out);
+		std::fclose(out);
+		threw = false;
+		try {
+			dp::cow_snapshot_file notSnapshot(kPath);
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+	}
+
+}
+
+int main() {
+	test_round_trip();
+	test_shared_graph();
+	test_handles_outlive_file();
+	test_bad_files();
+	std::remove(kPath);
+	return DP_TEST_RESULT();
+}
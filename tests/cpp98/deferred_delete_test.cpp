@@ -0,0 +1,133 @@
+#include "cpp98/deferred_delete.h"
+#include "cpp98/cow_ptr.h"
+
+#include "test_harness.h"
+
+#ifdef DP_CPP11_OR_HIGHER
+#include <thread>
+#include <vector>
+#endif
+
+namespace {
+
+	typedef dp_test::counted counted;
+
+	//Retires a second object from its destructor, as the last owner of a nested graph would
+	struct parent {
+		dp::cow_ptr<counted> child;
+		parent(dp::reclaim_queue& inQueue) : child(new counted(2), dp::deferred_delete<counted>(inQueue)) {}
+	};
+
+	void test_cow_ptr_release_is_deferred() {
+		dp::reclaim_queue queue(4);
+		{
+			dp::cow_ptr<counted> ptr(new counted(1), dp::deferred_delete<counted>(queue));
+			dp::cow_ptr<counted> copy = ptr;
+			ptr.reset();
+			DP_CHECK(queue.empty());
+		}
+		//The last owner is gone, but the object waits for the flush
+		DP_CHECK(counted::live() == 1);
+		DP_CHECK(queue.size() == 1);
+		DP_CHECK(queue.flush() == 1);
+		DP_CHECK(counted::live() == 0);
+		DP_CHECK(queue.empty());
+	}
+
+	void test_detached_copies_share_the_queue() {
+		dp::reclaim_queue queue(4);
+		{
+			dp::cow_ptr<counted> ptr(new counted(1), dp::deferred_delete<counted>(queue));
+			dp::cow_ptr<counted> copy = ptr;
+			copy->value = 2;
+			DP_CHECK(counted::live() == 2);
+		}
+		DP_CHECK(queue.size() == 2);
+		queue.flush();
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_bounded_capacity() {
+		dp::reclaim_queue queue(2);
+		dp::deferred_delete<counted> deleter(queue);
+		deleter(new counted);
+		deleter(new counted);
+		DP_CHECK(counted::live() == 2);
+		//A full queue destroys straight away rather than growing
+		deleter(new counted);
+		DP_CHECK(counted::live() == 2);
+		DP_CHECK(queue.size() == queue.capacity());
+
+		DP_CHECK(queue.flush(1) == 1);
+		DP_CHECK(counted::live() == 1);
+		DP_CHECK(queue.flush(5) == 1);
+		DP_CHECK(queue.flush(5) == 0);
+		DP_CHECK(counted::live() == 0);
+
+		deleter(NULL);
+		DP_CHECK(queue.empty());
+	}
+
+	void test_arrays_and_nested_retires() {
+		dp::reclaim_queue queue(4);
+		{
+			dp::cow_ptr<parent> ptr(new parent(queue), dp::deferred_delete<parent>(queue));
+		}
+		DP_CHECK(queue.size() == 1);
+		//Destroying the parent retires the child, and flush() keeps going until both are gone
+		DP_CHECK(queue.flush() == 2);
+		DP_CHECK(counted::live() == 0);
+
+		dp::deferred_delete<counted[]> arrayDeleter(queue);
+		arrayDeleter(new counted[3]);
+		DP_CHECK(counted::live() == 3);
+		queue.flush();
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_destructor_flushes() {
+		{
+			dp::reclaim_queue queue(2);
+			dp::deferred_delete<counted> deleter(queue);
+			deleter(new counted);
+			DP_CHECK(counted::live() == 1);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+
+#ifdef DP_CPP11_OR_HIGHER
+	//The last owners are released on other threads, which all retire to one queue while this thread flushes it
+	void test_release_on_other_threads() {
+		const int threadCount = 4;
+		const int perThread = 1000;
+		dp::reclaim_queue queue(threadCount * perThread);
+		std::vector<std::thread> threads;
+		for (int i = 0; i < threadCount; ++i) {
+			threads.emplace_back([&queue] {
+				for (int j = 0; j < perThread; ++j) {
+					dp::cow_ptr<int> ptr(new int(j), dp::deferred_delete<int>(queue));
+				}
+			});
+		}
+		std::size_t flushed = 0;
+		for (int i = 0; i < 100; ++i) flushed += queue.flush(10);
+		for (std::thread& thread : threads) thread.join();
+		flushed += queue.flush();
+		DP_CHECK(flushed == static_cast<std::size_t>(threadCount * perThread));
+		DP_CHECK(queue.empty());
+	}
+#endif
+
+}
+
+int main() {
+	test_cow_ptr_release_is_deferred();
+	test_detached_copies_share_the_queue();
+	test_bounded_capacity();
+	test_arrays_and_nested_retires();
+	test_destructor_flushes();
+#ifdef DP_CPP11_OR_HIGHER
+	test_release_on_other_threads();
+#endif
+	return DP_TEST_RESULT();
+}
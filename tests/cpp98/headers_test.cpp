@@ -0,0 +1,26 @@
+//Every cpp98 header, included together, must build against the core library (or its stub) as C++98 and as later standards
+
+#include "cpp98/clone_context.h"
+#include "cpp98/cow_memo.h"
+#include "cpp98/cow_ptr.h"
+#include "cpp98/cow_snapshot.h"
+#include "cpp98/deferred_delete.h"
+#include "cpp98/intrusive_cow_ptr.h"
+#include "cpp98/lazy_cow_array.h"
+#include "cpp98/persistent_hash_map.h"
+#include "cpp98/persistent_vector.h"
+#include "cpp98/poly_type_registry.h"
+#include "cpp98/poly_value_ptr.h"
+#include "cpp98/rope.h"
+#include "cpp98/slab_pool.h"
+#include "cpp98/snapshot_cache.h"
+#include "cpp98/union_expected.h"
+#include "cpp98/value_ptr.h"
+#include "cpp98/versioned_store.h"
+#include "cpp98/weak_cow_ptr.h"
+
+#include "test_harness.h"
+
+int main() {
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,120 @@
+#include "cpp98/intrusive_cow_ptr.h"
+
+#include "test_harness.h"
+
+#include <string>
+
+namespace {
+
+	struct node : dp::intrusive_cow_base<node> {
+		dp_test::counted payload;
+		explicit node(int in) : payload(in) {}
+	};
+
+	//A hierarchy with neither a virtual destructor nor a virtual clone
+	struct shape : dp::intrusive_cow_base<shape> {
+		int kind;
+		explicit shape(int inKind) : kind(inKind) {}
+	};
+	struct labelled_shape : shape {
+		std::string label;
+		dp_test::counted extra;
+		labelled_shape(const std::string& inLabel) : shape(1), label(inLabel), extra(7) {}
+	};
+
+	//A type which counts for itself rather than inheriting intrusive_cow_base
+	struct own_count {
+		int value;
+		std::size_t count;
+		explicit own_count(int in) : value(in), count(0) {}
+		own_count(const own_count& other) : value(other.value), count(0) {}
+	};
+	void intrusive_cow_add_ref(const own_count* in) {
+		++const_cast<own_count*>(in)->count;
+	}
+	bool intrusive_cow_release(const own_count* in) {
+		return --const_cast<own_count*>(in)->count == 0;
+	}
+	std::size_t intrusive_cow_use_count(const own_count* in) {
+		return in->count;
+	}
+	own_count* intrusive_cow_clone(const own_count* in) {
+		return new own_count(*in);
+	}
+
+	void test_single_pointer() {
+		DP_CHECK(sizeof(dp::intrusive_cow_ptr<node>) == sizeof(node*));
+	}
+
+	void test_copies_share_until_written() {
+		{
+			dp::intrusive_cow_ptr<node> first = dp::make_intrusive_cow<node>(1);
+			dp::intrusive_cow_ptr<node> second = first;
+			DP_CHECK(first.use_count() == 2);
+			DP_CHECK(dp_test::counted::live() == 1);
+
+			const dp::intrusive_cow_ptr<node>& constFirst = first;
+			DP_CHECK(constFirst->payload.value == 1);
+			DP_CHECK(first.use_count() == 2);
+
+			second->payload.value = 2;
+			DP_CHECK(first.unique() && second.unique());
+			DP_CHECK(dp_test::counted::live() == 2);
+			DP_CHECK(constFirst->payload.value == 1);
+
+			//A unique owner writes in place
+			const node* before = static_cast<const dp::intrusive_cow_ptr<node>&>(second).get();
+			second->payload.value = 3;
+			DP_CHECK(static_cast<const dp::intrusive_cow_ptr<node>&>(second).get() == before);
+
+			second = first;
+			DP_CHECK(first.use_count() == 2);
+			DP_CHECK(dp_test::counted::live() == 1);
+		}
+		DP_CHECK(dp_test::counted::live() == 0);
+	}
+
+	void test_detach_keeps_dynamic_type() {
+		{
+			dp::intrusive_cow_ptr<shape> first(new labelled_shape("square"));
+			dp::intrusive_cow_ptr<shape> second = first;
+			second->kind = 1;
+			DP_CHECK(first.unique() && second.unique());
+
+			const labelled_shape* copy = static_cast<const labelled_shape*>(static_cast<const dp::intrusive_cow_ptr<shape>&>(second).get());
+			DP_CHECK(copy->label == "square");
+			DP_CHECK(copy->extra.value == 7);
+			DP_CHECK(dp_test::counted::live() == 2);
+
+			//Copies of the copy are still whole objects
+			dp::intrusive_cow_ptr<shape> third = second;
+			third->kind = 2;
+			DP_CHECK(static_cast<const labelled_shape*>(static_cast<const dp::intrusive_cow_ptr<shape>&>(third).get())->label == "square");
+			DP_CHECK(dp_test::counted::live() == 3);
+		}
+		//Deleted through the dynamic type, although shape has no virtual destructor
+		DP_CHECK(dp_test::counted::live() == 0);
+	}
+
+	void test_own_counting() {
+		dp::intrusive_cow_ptr<own_count> first(new own_count(5));
+		dp::intrusive_cow_ptr<own_count> second = first;
+		DP_CHECK(first.use_count() == 2);
+		second->value = 6;
+		DP_CHECK(first.unique() && second.unique());
+		DP_CHECK(static_cast<const dp::intrusive_cow_ptr<own_count>&>(first)->value == 5);
+
+		second.reset();
+		DP_CHECK(!second);
+		DP_CHECK(second.use_count() == 0);
+	}
+
+}
+
+int main() {
+	test_single_pointer();
+	test_copies_share_until_written();
+	test_detach_keeps_dynamic_type();
+	test_own_counting();
+	return DP_TEST_RESULT();
+}
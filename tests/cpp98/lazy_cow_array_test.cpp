@@ -0,0 +1,111 @@
+#include "cpp98/lazy_cow_array.h"
+
+#include "test_harness.h"
+
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+	typedef dp_test::counted counted;
+
+	void test_const_reads_do_not_materialize() {
+		const dp::lazy_cow_array<int> array = dp::make_lazy_cow<int[]>(1000000, -1);
+		DP_CHECK(array.size() == 1000000 && !array.empty());
+		DP_CHECK(array[0] == -1 && array[999999] == -1 && array.at(5) == -1);
+		DP_CHECK(array.fill_value() == -1);
+		DP_CHECK(!array.materialized());
+
+		bool threw = false;
+		try {
+			array.at(1000000);
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+
+		const dp::lazy_cow_array<int> bounded = dp::make_lazy_cow<int[4]>(3);
+		DP_CHECK(bounded.size() == 4 && bounded[3] == 3);
+	}
+
+	void test_materialize_copy_constructs_in_place() {
+		{
+			counted fill(7);
+			counted::reset_counts();
+			dp::lazy_cow_array<counted> array(100, fill);
+			DP_CHECK(counted::copies() == 1);
+
+			//The first write copy-constructs every element from the fill value, with no default construction or assignment
+			array[10].value = 8;
+			DP_CHECK(array.materialized());
+			DP_CHECK(counted::copies() == 101);
+			DP_CHECK(counted::live() == 102);
+
+			const dp::lazy_cow_array<counted>& constArray = array;
+			DP_CHECK(constArray[10].value == 8 && constArray[11].value == 7);
+
+			array.fill(counted(1));
+			DP_CHECK(!array.materialized());
+			DP_CHECK(constArray[10].value == 1);
+			DP_CHECK(counted::live() == 2);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_copies_detach() {
+		dp::lazy_cow_array<int> first(10, 0);
+		first[0] = 1;
+		dp::lazy_cow_array<int> second = first;
+		second[0] = 2;
+		const dp::lazy_cow_array<int>& constFirst = first;
+		DP_CHECK(constFirst[0] == 1);
+		DP_CHECK(static_cast<const dp::lazy_cow_array<int>&>(second)[0] == 2);
+
+		int* data = second.data();
+		data[9] = 9;
+		DP_CHECK(second.at(9) == 9 && constFirst[9] == 0);
+
+		dp::swap(first, second);
+		DP_CHECK(constFirst[0] == 2);
+
+		dp::lazy_cow_array<int> empty;
+		DP_CHECK(empty.empty() && empty.data() == NULL);
+	}
+
+	void test_bool_elements() {
+		dp::lazy_cow_array<bool> flags = dp::make_lazy_cow<bool[]>(64, false);
+		bool& flag = flags[3];
+		flag = true;
+		bool* data = flags.data();
+		DP_CHECK(data[3]);
+		data[4] = true;
+		const dp::lazy_cow_array<bool>& constFlags = flags;
+		DP_CHECK(constFlags[4] && !constFlags[5]);
+	}
+
+	void test_oversized_length_throws() {
+		//The byte count would wrap around, so this must fail rather than allocate a short buffer
+		dp::lazy_cow_array<double> huge = dp::make_lazy_cow<double[]>(static_cast<std::size_t>(-1) / 4, 1.0);
+		const dp::lazy_cow_array<double>& constHuge = huge;
+		DP_CHECK(!huge.materialized() && constHuge[7] == 1.0);
+		bool threw = false;
+		try {
+			huge[0] = 2.0;
+		}
+		catch (const std::bad_alloc&) {
+			threw = true;
+		}
+		DP_CHECK(threw && !huge.materialized());
+	}
+
+}
+
+int main() {
+	test_const_reads_do_not_materialize();
+	test_materialize_copy_constructs_in_place();
+	test_copies_detach();
+	test_bool_elements();
+	test_oversized_length_throws();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,135 @@
+#include "cpp98/persistent_hash_map.h"
+
+#include "test_harness.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+	typedef dp_test::counted counted;
+
+	struct int_hash {
+		std::size_t operator()(int in) const {
+			std::size_t hash = static_cast<std::size_t>(in) * 2654435761u;
+			return hash ^ (hash >> 15);
+		}
+	};
+
+	//Every key lands on the same path, so entries end up in the list at the bottom of the trie
+	struct colliding_hash {
+		std::size_t operator()(int) const {
+			return 42;
+		}
+	};
+
+	//Sums keys and values, to check for_each visits everything once
+	struct summer {
+		long keys;
+		long values;
+		summer() : keys(0), values(0) {}
+		void operator()(const std::pair<int, int>& in) {
+			keys += in.first;
+			values += in.second;
+		}
+	};
+
+	void test_insert_find_erase() {
+		dp::persistent_hash_map<int, int, int_hash> map;
+		DP_CHECK(map.empty());
+		DP_CHECK(map.find(1) == NULL);
+
+		for (int i = 0; i < 5000; ++i) DP_CHECK(map.insert(i, i * 2));
+		DP_CHECK(map.size() == 5000);
+		DP_CHECK(!map.insert(10, -1));
+		DP_CHECK(map.at(10) == 20);
+		DP_CHECK(!map.insert_or_assign(10, -1));
+		DP_CHECK(map.at(10) == -1);
+		DP_CHECK(map.count(4999) == 1 && map.count(5000) == 0);
+
+		bool allFound = true;
+		for (int i = 0; i < 5000; ++i) allFound = allFound && map.find(i) != NULL;
+		DP_CHECK(allFound);
+
+		for (int i = 0; i < 5000; i += 2) DP_CHECK(map.erase(i) == 1);
+		DP_CHECK(map.erase(0) == 0);
+		DP_CHECK(map.size() == 2500);
+		bool rightOnesLeft = true;
+		for (int i = 0; i < 5000; ++i) rightOnesLeft = rightOnesLeft && (map.find(i) != NULL) == (i % 2 == 1);
+		DP_CHECK(rightOnesLeft);
+
+		summer sums = map.for_each(summer());
+		DP_CHECK(sums.keys == 2500L * 2500L);
+
+		bool threw = false;
+		try {
+			map.at(0);
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+
+		for (int i = 1; i < 5000; i += 2) map.erase(i);
+		DP_CHECK(map.empty());
+		DP_CHECK(map.find(1) == NULL);
+	}
+
+	void test_full_collisions() {
+		dp::persistent_hash_map<int, int, colliding_hash> map;
+		for (int i = 0; i < 10; ++i) map.insert(i, i);
+		DP_CHECK(map.size() == 10);
+		DP_CHECK(*map.find(7) == 7);
+		map.insert_or_assign(7, 70);
+		DP_CHECK(*map.find(7) == 70);
+		for (int i = 0; i < 9; ++i) map.erase(i);
+		//The last entry has been pulled back up the trie, and is still found
+		DP_CHECK(map.size() == 1);
+		DP_CHECK(*map.find(9) == 9);
+		DP_CHECK(map.find(3) == NULL);
+	}
+
+	void test_old_versions_stay_valid() {
+		dp::persistent_hash_map<int, std::string, int_hash> first;
+		for (int i = 0; i < 200; ++i) first.insert(i, "first");
+
+		dp::persistent_hash_map<int, std::string, int_hash> second = first;
+		second.insert_or_assign(5, "second");
+		second.erase(6);
+		second.insert(1000, "new");
+
+		DP_CHECK(first.at(5) == "first" && first.count(6) == 1 && first.count(1000) == 0);
+		DP_CHECK(second.at(5) == "second" && second.count(6) == 0 && second.at(1000) == "new");
+		DP_CHECK(first.size() == 200 && second.size() == 200);
+
+		second.clear();
+		DP_CHECK(first.size() == 200 && first.at(199) == "first");
+		dp::swap(first, second);
+		DP_CHECK(first.empty() && second.size() == 200);
+	}
+
+	void test_updates_copy_only_the_path() {
+		{
+			dp::persistent_hash_map<int, counted, int_hash> first;
+			for (int i = 0; i < 4096; ++i) first.insert(i, counted(i));
+
+			counted::reset_counts();
+			dp::persistent_hash_map<int, counted, int_hash> second = first;
+			DP_CHECK(counted::copies() == 0);
+			second.insert_or_assign(100, counted(-1));
+			//Only the entries packed into the nodes on one path are copied, a small fraction of the map
+			DP_CHECK(counted::copies() < 200);
+			DP_CHECK(first.at(100).value == 100 && second.at(100).value == -1);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+
+}
+
+int main() {
+	test_insert_find_erase();
+	test_full_collisions();
+	test_old_versions_stay_valid();
+	test_updates_copy_only_the_path();
+	return DP_TEST_RESULT();
+}
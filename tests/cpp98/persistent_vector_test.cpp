@@ -0,0 +1,131 @@
+#include "cpp98/persistent_vector.h"
+
+#include "test_harness.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+	typedef dp_test::counted counted;
+
+	void test_push_back_and_read() {
+		dp::persistent_vector<int> vec;
+		DP_CHECK(vec.empty());
+		//Enough elements to need three levels of the trie
+		for (int i = 0; i < 2000; ++i) vec.push_back(i);
+		DP_CHECK(vec.size() == 2000);
+		DP_CHECK(vec.front() == 0 && vec.back() == 1999);
+
+		bool allMatch = true;
+		for (int i = 0; i < 2000; ++i) allMatch = allMatch && vec[i] == i;
+		DP_CHECK(allMatch);
+
+		int expected = 0;
+		for (dp::persistent_vector<int>::const_iterator it = vec.begin(); it != vec.end(); ++it) allMatch = allMatch && *it == expected++;
+		DP_CHECK(allMatch && expected == 2000);
+
+		bool threw = false;
+		try {
+			vec.at(2000);
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+	}
+
+	void test_construction() {
+		dp::persistent_vector<int> filled(40, 7);
+		DP_CHECK(filled.size() == 40 && filled[39] == 7);
+
+		//Two integers are a count and a value
+		dp::persistent_vector<int> fromIntegers(3, 5);
+		DP_CHECK(fromIntegers.size() == 3 && fromIntegers[0] == 5);
+
+		std::vector<int> source;
+		for (int i = 0; i < 100; ++i) source.push_back(i * 2);
+		dp::persistent_vector<int> fromRange(source.begin(), source.end());
+		DP_CHECK(fromRange.size() == 100 && fromRange[99] == 198);
+		DP_CHECK(std::equal(source.begin(), source.end(), fromRange.begin()));
+	}
+
+	void test_old_versions_stay_valid() {
+		dp::persistent_vector<int> first;
+		for (int i = 0; i < 100; ++i) first.push_back(i);
+
+		dp::persistent_vector<int> second = first;
+		second.set(50, -1);
+		second.push_back(100);
+		DP_CHECK(first[50] == 50 && first.size() == 100);
+		DP_CHECK(second[50] == -1 && second.size() == 101);
+
+		dp::persistent_vector<int> third = second;
+		third.pop_back();
+		third.pop_back();
+		DP_CHECK(third.size() == 99);
+		DP_CHECK(second.size() == 101 && second.back() == 100);
+		DP_CHECK(first != second);
+
+		dp::persistent_vector<int> fourth = first;
+		DP_CHECK(fourth == first);
+	}
+
+	void test_updates_copy_only_the_path() {
+		{
+			dp::persistent_vector<counted> first;
+			for (int i = 0; i < 32 * 32 * 2; ++i) first.push_back(counted(i));
+			counted::reset_counts();
+
+			//A set on a shared version copies one leaf of 32 elements, not the whole vector
+			dp::persistent_vector<counted> second = first;
+			DP_CHECK(counted::copies() == 0);
+			second.set(1000, counted(-1));
+			DP_CHECK(counted::copies() <= 33);
+			DP_CHECK(first[1000].value == 1000);
+
+			//Further edits to nodes the version already owns happen in place
+			counted::reset_counts();
+			for (int i = 992; i < 1024; ++i) second.set(i, counted(-i));
+			DP_CHECK(counted::copies() == 32);
+			DP_CHECK(first[1000].value == 1000 && second[1000].value == -1000);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_pop_back_shrinks() {
+		dp::persistent_vector<int> vec;
+		for (int i = 0; i < 33; ++i) vec.push_back(i);
+		dp::persistent_vector<int> copy = vec;
+		vec.pop_back();
+		DP_CHECK(vec.size() == 32 && vec.back() == 31);
+		for (int i = 0; i < 32; ++i) vec.pop_back();
+		DP_CHECK(vec.empty());
+		vec.push_back(9);
+		DP_CHECK(vec.size() == 1 && vec[0] == 9);
+		DP_CHECK(copy.size() == 33 && copy.back() == 32);
+
+		bool threw = false;
+		try {
+			dp::persistent_vector<int>().pop_back();
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+
+		dp::swap(vec, copy);
+		DP_CHECK(vec.size() == 33 && copy.size() == 1);
+	}
+
+}
+
+int main() {
+	test_push_back_and_read();
+	test_construction();
+	test_old_versions_stay_valid();
+	test_updates_copy_only_the_path();
+	test_pop_back_shrinks();
+	return DP_TEST_RESULT();
+}
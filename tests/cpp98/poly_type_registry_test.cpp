@@ -0,0 +1,230 @@
+#include "cpp98/poly_type_registry.h"
+
+#include "test_harness.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+	struct shape {
+		virtual ~shape() {}
+		virtual int sides() const = 0;
+	};
+	struct circle : shape {
+		std::size_t radius;
+		explicit circle(std::size_t inRadius) : radius(inRadius) {}
+		int sides() const {
+			return 0;
+		}
+	};
+	struct rectangle : shape {
+		std::size_t width;
+		std::size_t height;
+		rectangle(std::size_t inWidth, std::size_t inHeight) : width(inWidth), height(inHeight) {}
+		int sides() const {
+			return 4;
+		}
+	};
+	//Same layout and behaviour as each other, so must still be told apart
+	struct point_a : shape {
+		int sides() const {
+			return 1;
+		}
+	};
+	struct point_b : shape {
+		int sides() const {
+			return 1;
+		}
+	};
+	struct unregistered : shape {
+		int sides() const {
+			return 3;
+		}
+	};
+
+}
+
+namespace dp {
+
+	template<>
+	struct poly_codec<circle> {
+		static void encode(const circle& in, std::vector<unsigned char>& out) {
+			dp::write_varint(in.radius, out);
+		}
+		static circle* decode(const unsigned char*& cursor, const unsigned char* end) {
+			return new circle(dp::read_varint(cursor, end));
+		}
+	};
+
+	template<>
+	struct poly_codec<rectangle> {
+		static void encode(const rectangle& in, std::vector<unsigned char>& out) {
+			dp::write_varint(in.width, out);
+			dp::write_varint(in.height, out);
+		}
+		static rectangle* decode(const unsigned char*& cursor, const unsigned char* end) {
+			const std::size_t width = dp::read_varint(cursor, end);
+			return new rectangle(width, dp::read_varint(cursor, end));
+		}
+	};
+
+	template<>
+	struct poly_codec<point_a> {
+		static void encode(const point_a&, std::vector<unsigned char>&) {}
+		static point_a* decode(const unsigned char*&, const unsigned char*) {
+			return new point_a();
+		}
+	};
+
+	template<>
+	struct poly_codec<point_b> {
+		static void encode(const point_b&, std::vector<unsigned char>&) {}
+		static point_b* decode(const unsigned char*&, const unsigned char*) {
+			return new point_b();
+		}
+	};
+
+}
+
+namespace {
+
+	typedef dp::poly_value_ptr<shape> pointer;
+	typedef dp::poly_type_registry<shape> registry;
+
+	registry make_registry() {
+		registry result;
+		result.register_type<circle>();
+		result.register_type<rectangle>();
+		result.register_type<point_a>();
+		result.register_type<point_b>();
+		return result;
+	}
+
+	void test_varints() {
+		const std::size_t values[] = { 0, 1, 127, 128, 300, 16384, static_cast<std::size_t>(-1) };
+		std::vector<unsigned char> buffer;
+		for (std::size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) dp::write_varint(values[i], buffer);
+		DP_CHECK(buffer[0] == 0 && buffer[1] == 1 && buffer[2] == 127 && buffer[3] == 0x80 && buffer[4] == 1);
+
+		const unsigned char* cursor = &buffer[0];
+		const unsigned char* end = cursor + buffer.size();
+		bool matches = true;
+		for (std::size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) matches = matches && dp::read_varint(cursor, end) == values[i];
+		DP_CHECK(matches && cursor == end);
+
+		bool threw = false;
+		const unsigned char truncated[] = { 0x80, 0x80 };
+		cursor = truncated;
+		try {
+			dp::read_varint(cursor, truncated + 2);
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+	}
+
+	void test_tags() {
+		registry types = make_registry();
+		DP_CHECK(types.size() == 4);
+		//Registering again hands back the existing tag
+		DP_CHECK(types.register_type<rectangle>() == 2);
+		DP_CHECK(types.size() == 4);
+
+		DP_CHECK(types.tag_of(pointer()) == 0);
+		DP_CHECK(types.tag_of(pointer(dp::poly_t<circle>(), new circle(1))) == 1);
+		DP_CHECK(types.tag_of(pointer(dp::poly_t<point_a>(), new point_a())) == 3);
+		DP_CHECK(types.tag_of(pointer(dp::poly_t<point_b>(), new point_b())) == 4);
+
+		bool threw = false;
+		try {
+			types.tag_of(pointer(dp::poly_t<unregistered>(), new unregistered()));
+		}
+		catch (const std::invalid_argument&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+	}
+
+	void test_round_trip() {
+		const registry types = make_registry();
+		std::vector<unsigned char> buffer;
+		types.encode(pointer(dp::poly_t<rectangle>(), new rectangle(3, 200)), buffer);
+		types.encode(pointer(), buffer);
+		types.encode(pointer(dp::poly_t<point_b>(), new point_b()), buffer);
+		//Tag, then two varints, one of them two bytes long; an empty pointer is a single 0
+		DP_CHECK(buffer.size() == 4 + 1 + 1);
+
+		const unsigned char* cursor = &buffer[0];
+		const unsigned char* end = cursor + buffer.size();
+		pointer decoded(dp::poly_t<circle>(), new circle(5));
+		types.decode(cursor, end, decoded);
+		const rectangle* asRectangle = dp::dynamic_pointer_cast<rectangle>(decoded);
+		DP_CHECK(asRectangle != NULL && asRectangle->width == 3 && asRectangle->height == 200);
+		types.decode(cursor, end, decoded);
+		DP_CHECK(!decoded);
+		types.decode(cursor, end, decoded);
+		DP_CHECK(decoded.dynamic_type() == pointer::type_id_of<point_b>());
+		DP_CHECK(cursor == end);
+
+		bool threw = false;
+		const unsigned char unknown[] = { 9 };
+		cursor = unknown;
+		try {
+			types.decode(cursor, unknown + 1, decoded);
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+	}
+
+	void test_ranges() {
+		const registry types = make_registry();
+		std::vector<pointer> shapes;
+		for (std::size_t i = 0; i < 100; ++i) {
+			if (i % 3 == 0) shapes.push_back(pointer(dp::poly_t<circle>(), new circle(i)));
+			else if (i % 3 == 1) shapes.push_back(pointer(dp::poly_t<rectangle>(), new rectangle(i, i * 2)));
+			else shapes.push_back(pointer());
+		}
+		std::vector<unsigned char> buffer;
+		types.encode_range(shapes.begin(), shapes.end(), buffer);
+
+		std::vector<pointer> decoded(1);
+		const unsigned char* cursor = &buffer[0];
+		types.decode_range(cursor, cursor + buffer.size(), decoded);
+		DP_CHECK(decoded.size() == 101 && !decoded[0]);
+		bool matches = true;
+		for (std::size_t i = 0; i < shapes.size(); ++i) {
+			const pointer& original = shapes[i];
+			const pointer& copy = decoded[i + 1];
+			matches = matches && original.dynamic_type() == copy.dynamic_type();
+			if (!original) continue;
+			matches = matches && original->sides() == copy->sides();
+			if (const circle* c = dp::dynamic_pointer_cast<circle>(copy)) matches = matches && c->radius == i;
+		}
+		DP_CHECK(matches);
+
+		//A range which fails part way through leaves the destination and cursor untouched
+		std::vector<unsigned char> truncated(buffer.begin(), buffer.begin() + buffer.size() / 2);
+		cursor = &truncated[0];
+		bool threw = false;
+		try {
+			types.decode_range(cursor, cursor + truncated.size(), decoded);
+		}
+		catch (const std::exception&) {
+			threw = true;
+		}
+		DP_CHECK(threw && cursor == &truncated[0] && decoded.size() == 101);
+	}
+
+}
+
+int main() {
+	test_varints();
+	test_tags();
+	test_round_trip();
+	test_ranges();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,213 @@
+#include "cpp98/poly_value_ptr.h"
+
+#include "test_harness.h"
+
+#include <stdexcept>
+
+//clone_context is opt-in, so the pointer must not pull it in by default
+#ifdef DP_CPP98_CLONE_CONTEXT
+#error "poly_value_ptr.h included clone_context.h without DP_CLONE_CONTEXT"
+#endif
+
+namespace {
+
+	struct base {
+		static int& live() {
+			static int count = 0;
+			return count;
+		}
+		int value;
+		explicit base(int in) : value(in) {
+			++live();
+		}
+		base(const base& other) : value(other.value) {
+			++live();
+		}
+		virtual ~base() {
+			--live();
+		}
+		virtual int kind() const {
+			return 0;
+		}
+	};
+
+	struct derived : base {
+		int extra;
+		derived(int inValue, int inExtra) : base(inValue), extra(inExtra) {}
+		int kind() const {
+			return 1;
+		}
+	};
+
+	//Puts derived's base at a non-zero offset in the complete object
+	struct mixin {
+		int tag;
+		mixin() : tag(9) {}
+		virtual ~mixin() {}
+	};
+	struct most_derived : mixin, derived {
+		most_derived() : mixin(), derived(3, 4) {}
+		int kind() const {
+			return 2;
+		}
+	};
+
+	//Two types whose copies and destructors compile to identical code
+	struct twin_a : base {
+		twin_a() : base(0) {}
+	};
+	struct twin_b : base {
+		twin_b() : base(0) {}
+	};
+
+	void test_clones_dynamic_type() {
+		{
+			dp::poly_value_ptr<base> first(dp::poly_t<derived>(), new derived(1, 2));
+			dp::poly_value_ptr<base> second(first);
+			DP_CHECK(base::live() == 2);
+			DP_CHECK(second.get() != first.get());
+			DP_CHECK(second->kind() == 1);
+			DP_CHECK(dp::dynamic_pointer_cast<derived>(second)->extra == 2);
+
+			second->value = 5;
+			DP_CHECK(first->value == 1);
+
+			dp::poly_value_ptr<base> plain(dp::poly_t<base>(), new base(7));
+			first = plain;
+			DP_CHECK(first->kind() == 0);
+			DP_CHECK((*first).value == 7);
+			DP_CHECK(dp::dynamic_pointer_cast<derived>(first) == NULL);
+			DP_CHECK(base::live() == 3);
+		}
+		DP_CHECK(base::live() == 0);
+	}
+
+	void test_empty_release_and_reset() {
+		{
+			dp::poly_value_ptr<base> empty;
+			dp::poly_value_ptr<base> copy(empty);
+			DP_CHECK(!copy);
+			empty.reset();
+
+			dp::poly_value_ptr<base> owner(dp::poly_t<derived>(), new derived(1, 2));
+			base* raw = owner.release();
+			DP_CHECK(!owner);
+			DP_CHECK(base::live() == 1);
+			delete raw;
+
+			owner.reset(new derived(3, 4));
+			dp::poly_value_ptr<base> clone(owner);
+			DP_CHECK(clone->kind() == 1);
+			DP_CHECK(dp::static_ptr_cast<derived>(clone)->extra == 4);
+
+			dp::swap(owner, empty);
+			DP_CHECK(!owner);
+			DP_CHECK(empty->value == 3);
+
+			//A plain base pointer is held as exactly a base
+			owner.reset(static_cast<base*>(new base(5)));
+			DP_CHECK(owner.dynamic_type() == dp::poly_value_ptr<base>::type_id_of<base>());
+			owner.reset(static_cast<base*>(NULL));
+			DP_CHECK(!owner && owner.dynamic_type() == NULL);
+		}
+		DP_CHECK(base::live() == 0);
+	}
+
+	void test_conversion_keeps_dynamic_type() {
+		{
+			dp::poly_value_ptr<derived> source(dp::poly_t<most_derived>(), new most_derived());
+			//Converting to a further base still copies, and later destroys, the whole object
+			dp::poly_value_ptr<base> converted(source);
+			DP_CHECK(base::live() == 2);
+			DP_CHECK(converted->kind() == 2 && converted->value == 3);
+			DP_CHECK(converted.dynamic_type() == source.dynamic_type());
+			DP_CHECK(converted.dynamic_type() == dp::poly_value_ptr<base>::type_id_of<most_derived>());
+
+			dp::poly_value_ptr<base> copy(converted);
+			DP_CHECK(copy->kind() == 2);
+			const most_derived* complete = dp::dynamic_pointer_cast<most_derived>(copy);
+			DP_CHECK(complete != NULL && complete->tag == 9 && complete->extra == 4);
+
+			copy = source;
+			DP_CHECK(copy->kind() == 2 && base::live() == 3);
+#ifdef __cpp_rvalue_references
+			dp::poly_value_ptr<base> moved(static_cast<dp::poly_value_ptr<derived>&&>(source));
+			DP_CHECK(!source && moved->kind() == 2 && base::live() == 3);
+#endif
+		}
+		DP_CHECK(base::live() == 0);
+	}
+
+	//A base which is not polymorphic, at the start of one derived type and, behind the vtable pointer, not at the start of another
+	struct plain {
+		int value;
+		plain() : value(1) {}
+	};
+	struct plain_derived : plain {
+		int extra;
+		plain_derived() : plain(), extra(2) {}
+	};
+	struct plain_with_vtable : plain {
+		virtual ~plain_with_vtable() {}
+	};
+
+	void test_layout() {
+		DP_CHECK(sizeof(dp::poly_value_ptr<base>) == 2 * sizeof(void*));
+
+		{
+			dp::poly_value_ptr<plain> first(dp::poly_t<plain_derived>(), new plain_derived());
+			dp::poly_value_ptr<plain> second(first);
+			DP_CHECK(second && second.get() != first.get());
+			DP_CHECK(static_cast<const plain_derived*>(second.get())->extra == 2);
+		}
+
+		//The complete object of a non-polymorphic base elsewhere in it could not be found again, so it is refused
+		plain_with_vtable probe;
+		const bool offset = static_cast<const void*>(static_cast<plain*>(&probe)) != static_cast<const void*>(&probe);
+		bool threw = false;
+		try {
+			dp::poly_value_ptr<plain> refused(dp::poly_t<plain_with_vtable>(), new plain_with_vtable());
+		}
+		catch (const std::invalid_argument&) {
+			threw = true;
+		}
+		DP_CHECK(threw == offset);
+	}
+
+	void test_type_ids_are_distinct() {
+		typedef dp::poly_value_ptr<base> pointer;
+		DP_CHECK(pointer::type_id_of<twin_a>() != pointer::type_id_of<twin_b>());
+		DP_CHECK(pointer::type_id_of<twin_a>() == dp::poly_value_ptr<twin_a>::type_id_of<twin_a>());
+		const pointer a(dp::poly_t<twin_a>(), new twin_a());
+		const pointer b(dp::poly_t<twin_b>(), new twin_b());
+		DP_CHECK(a.dynamic_type() != b.dynamic_type());
+		DP_CHECK(pointer().dynamic_type() == NULL);
+	}
+
+#ifdef __cpp_rvalue_references
+	void test_move() {
+		{
+			dp::poly_value_ptr<base> source(dp::poly_t<derived>(), new derived(1, 2));
+			const base* held = source.get();
+			dp::poly_value_ptr<base> target(static_cast<dp::poly_value_ptr<base>&&>(source));
+			DP_CHECK(!source);
+			DP_CHECK(target.get() == held);
+			DP_CHECK(base::live() == 1);
+		}
+		DP_CHECK(base::live() == 0);
+	}
+#endif
+
+}
+
+int main() {
+	test_clones_dynamic_type();
+	test_empty_release_and_reset();
+	test_conversion_keeps_dynamic_type();
+	test_type_ids_are_distinct();
+	test_layout();
+#ifdef __cpp_rvalue_references
+	test_move();
+#endif
+	return DP_TEST_RESULT();
+}
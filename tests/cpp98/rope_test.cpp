@@ -0,0 +1,138 @@
+#include "cpp98/rope.h"
+
+#include "test_harness.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+	std::string pattern(std::size_t inLength, char inFirst) {
+		std::string result;
+		for (std::size_t i = 0; i < inLength; ++i) result += static_cast<char>(inFirst + i % 26);
+		return result;
+	}
+
+	void test_build_and_read() {
+		dp::rope empty;
+		DP_CHECK(empty.empty() && empty.size() == 0);
+		DP_CHECK(empty.str().empty());
+		DP_CHECK(empty.chunks_begin() == empty.chunks_end());
+
+		//Long enough to be split over several leaves
+		const std::string text = pattern(5000, 'a');
+		dp::rope rope(text);
+		DP_CHECK(rope.size() == 5000 && rope.length() == 5000);
+		DP_CHECK(rope.str() == text);
+		DP_CHECK(rope[0] == 'a' && rope[4999] == text[4999] && rope.at(1234) == text[1234]);
+
+		bool threw = false;
+		try {
+			rope.at(5000);
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+
+		//Chunks cover the text in order, without copying it, and no leaf is over the limit
+		std::string joined;
+		bool leavesInLimit = true;
+		std::size_t chunkCount = 0;
+		for (dp::rope::chunk_iterator it = rope.chunks_begin(); it != rope.chunks_end(); ++it) {
+			joined.append((*it).data, (*it).size);
+			leavesInLimit = leavesInLimit && (*it).size <= dp::rope::max_leaf;
+			++chunkCount;
+		}
+		DP_CHECK(joined == text);
+		DP_CHECK(leavesInLimit && chunkCount > 1);
+
+		std::ostringstream out;
+		out << rope;
+		DP_CHECK(out.str() == text);
+
+		DP_CHECK(dp::rope("abc", 2).str() == "ab");
+	}
+
+	void test_edits_match_a_string() {
+		std::string model = pattern(3000, 'A');
+		dp::rope rope(model);
+		std::srand(7);
+		for (int i = 0; i < 2000; ++i) {
+			const std::size_t pos = model.empty() ? 0 : static_cast<std::size_t>(std::rand()) % (model.size() + 1);
+			switch (std::rand() % 4) {
+			case 0: {
+				const std::string piece = pattern(static_cast<std::size_t>(std::rand() % 40), 'a');
+				model.insert(pos, piece);
+				rope.insert(pos, piece);
+				break;
+			}
+			case 1: {
+				const std::size_t count = static_cast<std::size_t>(std::rand() % 40);
+				model.erase(pos, count);
+				rope.erase(pos, count);
+				break;
+			}
+			case 2:
+				model.append("xyz");
+				rope.append("xyz");
+				break;
+			default: {
+				//Splice a piece of the rope back into itself
+				const std::size_t count = static_cast<std::size_t>(std::rand() % 100);
+				const std::string piece = model.substr(pos, count);
+				model.insert(model.size() / 2, piece);
+				rope.insert(rope.size() / 2, rope.substr(pos, count));
+				break;
+			}
+			}
+		}
+		DP_CHECK(rope.size() == model.size());
+		DP_CHECK(rope.str() == model);
+	}
+
+	void test_old_versions_stay_valid() {
+		dp::rope first(pattern(2000, 'a'));
+		dp::rope second = first;
+		second.erase(10, 100);
+		second.insert(0, "start ");
+		dp::rope third = second.substr(6, 50);
+		third.append(first);
+
+		DP_CHECK(first.str() == pattern(2000, 'a'));
+		DP_CHECK(second.size() == 1906 && second.str().compare(0, 6, "start ") == 0);
+		DP_CHECK(third.size() == 2050);
+		DP_CHECK(third.str().substr(0, 10) == first.str().substr(0, 10));
+
+		second.clear();
+		DP_CHECK(second.empty() && first.size() == 2000);
+		dp::swap(first, second);
+		DP_CHECK(first.empty() && second.size() == 2000);
+
+		bool threw = false;
+		try {
+			second.insert(2001, "x");
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+	}
+
+	void test_wide() {
+		dp::wrope wide(L"wide text");
+		wide.insert(5, L"r");
+		DP_CHECK(wide.str() == L"wide rtext");
+	}
+
+}
+
+int main() {
+	test_build_and_read();
+	test_edits_match_a_string();
+	test_old_versions_stay_valid();
+	test_wide();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,137 @@
+#include "cpp98/cow_ptr.h"
+#include "cpp98/slab_pool.h"
+
+#include "test_harness.h"
+
+#include <list>
+#include <map>
+
+#ifdef DP_CPP11_OR_HIGHER
+#include <thread>
+#include <vector>
+#endif
+
+namespace {
+
+	typedef dp_test::counted counted;
+
+	struct pooled : dp::slab_allocated<pooled> {
+		int value;
+		explicit pooled(int in) : value(in) {}
+	};
+
+	void test_blocks_are_reused() {
+		void* first = dp::slab_pool::allocate(24);
+		DP_CHECK(first != NULL);
+		DP_CHECK(reinterpret_cast<std::size_t>(first) % dp::slab_pool::alignment == 0);
+		dp::slab_pool::deallocate(first, 24);
+		//The same size class hands the block straight back
+		void* second = dp::slab_pool::allocate(32);
+		DP_CHECK(second == first);
+		dp::slab_pool::deallocate(second, 32);
+
+		void* large = dp::slab_pool::allocate(dp::slab_pool::max_size + 1);
+		DP_CHECK(large != NULL);
+		dp::slab_pool::deallocate(large, dp::slab_pool::max_size + 1);
+		dp::slab_pool::deallocate(NULL, 8);
+	}
+
+	void test_containers() {
+		std::list<int, dp::slab_allocator<int> > list;
+		std::map<int, int, std::less<int>, dp::slab_allocator<std::pair<const int, int> > > map;
+		for (int i = 0; i < 1000; ++i) {
+			list.push_back(i);
+			map[i] = i * 2;
+		}
+		DP_CHECK(list.size() == 1000 && list.back() == 999);
+		DP_CHECK(map.size() == 1000 && map[500] == 1000);
+		DP_CHECK(dp::slab_allocator<int>() == dp::slab_allocator<long>());
+	}
+
+	void test_pooled_cow_ptr() {
+		counted::reset_counts();
+		{
+			//allocate_cow puts the control block in the pool, and so does every detach
+			dp::cow_ptr<counted> first = dp::allocate_cow<counted>(dp::slab_allocator<counted>(), 1);
+			dp::cow_ptr<counted> second = first;
+			second->value = 2;
+			DP_CHECK(counted::copies() == 1);
+			DP_CHECK(static_cast<const dp::cow_ptr<counted>&>(first)->value == 1);
+			DP_CHECK(second->value == 2);
+
+			dp::cow_ptr<counted> third(new counted(3), dp::default_delete<counted>(), dp::slab_allocator<int>());
+			DP_CHECK(third.unique() && third->value == 3);
+		}
+		DP_CHECK(counted::live() == 0);
+
+		//A payload deriving from slab_allocated is pooled too, including the copy made on detach
+		dp::cow_ptr<pooled> object = dp::allocate_cow<pooled>(dp::slab_allocator<pooled>(), 4);
+		dp::cow_ptr<pooled> copy = object;
+		copy->value = 5;
+		DP_CHECK(static_cast<const dp::cow_ptr<pooled>&>(object)->value == 4 && copy->value == 5);
+	}
+
+#ifdef DP_CPP11_OR_HIGHER
+	//Frees its block from a thread_local destructor which runs after the thread's cache has gone
+	struct late_release {
+		void* block = nullptr;
+		~late_release() {
+			dp::slab_pool::deallocate(block, 16);
+		}
+	};
+
+	void test_free_after_cache_destroyed() {
+		void* freed = nullptr;
+		std::thread worker([&freed] {
+			//Constructed before the cache, so destroyed after it
+			static thread_local late_release holder;
+			holder.block = dp::slab_pool::allocate(16);
+			freed = holder.block;
+		});
+		worker.join();
+
+		//The block went back to the central lists, where this thread's cache can find it
+		bool found = false;
+		void* blocks[1024];
+		for (std::size_t i = 0; i < 1024; ++i) {
+			blocks[i] = dp::slab_pool::allocate(16);
+			found = found || blocks[i] == freed;
+		}
+		for (std::size_t i = 0; i < 1024; ++i) dp::slab_pool::deallocate(blocks[i], 16);
+		DP_CHECK(found);
+	}
+
+	//Plain cow_ptr control blocks come from the pool, so blocks made on one thread are freed into another thread's cache
+	void test_default_cow_ptr_across_threads() {
+		counted::reset_counts();
+		std::vector<dp::cow_ptr<counted> > made(1000);
+		std::thread maker([&made] {
+			for (std::size_t i = 0; i < made.size(); ++i) made[i] = dp::make_cow<counted>(static_cast<int>(i));
+		});
+		maker.join();
+
+		std::vector<dp::cow_ptr<counted> > copies(made);
+		for (std::size_t i = 0; i < copies.size(); ++i) copies[i]->value += 1;
+		std::thread releaser([&made] {
+			made.clear();
+		});
+		releaser.join();
+		DP_CHECK(counted::copies() == 1000 && counted::live() == 1000);
+		DP_CHECK(copies[999]->value == 1000);
+		copies.clear();
+		DP_CHECK(counted::live() == 0);
+	}
+#endif
+
+}
+
+int main() {
+	test_blocks_are_reused();
+	test_containers();
+	test_pooled_cow_ptr();
+#ifdef DP_CPP11_OR_HIGHER
+	test_free_after_cache_destroyed();
+	test_default_cow_ptr_across_threads();
+#endif
+	return DP_TEST_RESULT();
+}
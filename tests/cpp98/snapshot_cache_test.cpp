@@ -0,0 +1,84 @@
+#include "cpp98/snapshot_cache.h"
+
+#include "test_harness.h"
+
+#include <numeric>
+#include <vector>
+
+namespace {
+
+	typedef std::vector<int> values;
+
+	struct sum_of {
+		int* calls;
+		explicit sum_of(int* inCalls) : calls(inCalls) {}
+		int operator()(const values& in) const {
+			++*calls;
+			return std::accumulate(in.begin(), in.end(), 0);
+		}
+	};
+
+	void test_hits_and_misses() {
+		dp::snapshot_cache<values, int> cache(4);
+		DP_CHECK(cache.empty() && cache.capacity() == 4);
+		int calls = 0;
+
+		dp::cow_ptr<values> snapshot = dp::make_cow<values>(3, 1);
+		DP_CHECK(cache.find(snapshot) == NULL);
+		DP_CHECK(cache.get_or_compute(snapshot, sum_of(&calls)) == 3);
+		DP_CHECK(cache.get_or_compute(snapshot, sum_of(&calls)) == 3);
+		DP_CHECK(calls == 1);
+
+		//A copy is the same snapshot
+		const dp::cow_ptr<values> copy = snapshot;
+		DP_CHECK(cache.find(copy) != NULL && *cache.find(copy) == 3);
+		DP_CHECK(cache.get_or_compute(copy, sum_of(&calls)) == 3 && calls == 1);
+	}
+
+	void test_modified_snapshot_misses() {
+		dp::snapshot_cache<values, int> cache(4);
+		int calls = 0;
+
+		//The only owner modifies its object after it has been cached: the cached key keeps the old snapshot apart
+		dp::cow_ptr<values> snapshot = dp::make_cow<values>(3, 1);
+		DP_CHECK(cache.get_or_compute(snapshot, sum_of(&calls)) == 3);
+		snapshot->push_back(10);
+		DP_CHECK(cache.find(snapshot) == NULL);
+		DP_CHECK(cache.get_or_compute(snapshot, sum_of(&calls)) == 13);
+		DP_CHECK(calls == 2);
+
+		//The first entry's snapshot has died, and is dropped
+		DP_CHECK(cache.size() == 2);
+		DP_CHECK(cache.purge() == 1);
+		DP_CHECK(cache.size() == 1);
+	}
+
+	void test_eviction() {
+		dp::snapshot_cache<values, int> cache(2);
+		int calls = 0;
+		std::vector<dp::cow_ptr<values> > live;
+		for (int i = 0; i < 3; ++i) {
+			live.push_back(dp::make_cow<values>(1, i));
+			cache.get_or_compute(live.back(), sum_of(&calls));
+		}
+		DP_CHECK(cache.size() == 2 && calls == 3);
+
+		//A dead snapshot is dropped in preference to a live one
+		live.erase(live.begin() + 1);
+		live.push_back(dp::make_cow<values>(1, 3));
+		cache.get_or_compute(live.back(), sum_of(&calls));
+		DP_CHECK(cache.size() == 2);
+		DP_CHECK(cache.find(live.back()) != NULL);
+
+		cache.clear();
+		DP_CHECK(cache.empty());
+	}
+
+}
+
+int main() {
+	test_hits_and_misses();
+	test_modified_snapshot_misses();
+	test_eviction();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,131 @@
+#include "cpp98/union_expected.h"
+
+#include "test_harness.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+	typedef dp_test::counted counted;
+
+	enum error_code {
+		no_error,
+		not_found,
+		denied
+	};
+
+	struct triple {
+		int a;
+		int b;
+		int c;
+		triple() : a(0), b(0), c(0) {}
+		triple(int inA, int inB, int inC) : a(inA), b(inB), c(inC) {}
+	};
+
+	dp::expected<int, error_code> parse(int in) {
+		if (in < 0) return dp::unex(not_found);
+		return in * 2;
+	}
+
+	void test_states() {
+		const dp::expected<int, error_code> good = parse(4);
+		DP_CHECK(good.has_value() && good && *good == 8 && good.value() == 8);
+		const dp::expected<int, error_code> bad = parse(-1);
+		DP_CHECK(!bad.has_value() && bad.error() == not_found);
+		DP_CHECK(bad.value_or(3) == 3 && good.value_or(3) == 8);
+
+		bool threw = false;
+		try {
+			bad.value();
+		}
+		catch (const dp::bad_expected_access<error_code>& e) {
+			threw = e.error() == not_found;
+		}
+		DP_CHECK(threw);
+
+		const dp::expected<int, error_code> tagged(dp::unexpect, denied);
+		DP_CHECK(!tagged && tagged.error() == denied);
+		const dp::expected<int, error_code> eight(8);
+		DP_CHECK(good == eight && good != bad);
+	}
+
+	void test_in_place_and_emplace() {
+		const dp::expected<triple, error_code> none(dp::in_place);
+		DP_CHECK(none.has_value() && none->a == 0);
+		const dp::expected<triple, error_code> built(dp::in_place, 1, 2, 3);
+		DP_CHECK(built->a == 1 && built->b == 2 && built->c == 3);
+		const dp::expected<std::string, error_code> text(dp::in_place, 3, 'x');
+		DP_CHECK(*text == "xxx");
+		const dp::expected<std::vector<int>, error_code> filled(dp::in_place, 4u);
+		DP_CHECK(filled->size() == 4);
+
+		{
+			dp::expected<counted, error_code> held(dp::unexpect, denied);
+			counted source(5);
+			counted::reset_counts();
+			//Built where it is stored, with one copy from the argument and no temporary
+			counted& result = held.emplace(source);
+			DP_CHECK(held.has_value() && result.value == 5 && &result == &*held);
+			DP_CHECK(counted::copies() == 1 && counted::live() == 2);
+
+			held.emplace();
+			DP_CHECK(held->value == 0 && counted::live() == 2);
+		}
+		DP_CHECK(counted::live() == 0);
+
+		dp::expected<triple, error_code> replaced(triple(1, 1, 1));
+		DP_CHECK(replaced.emplace(7, 8, 9).c == 9 && replaced->a == 7);
+
+		dp::expected<void, error_code> empty(dp::in_place);
+		DP_CHECK(empty.has_value());
+	}
+
+	void test_changing_state() {
+		{
+			dp::expected<counted, error_code> held(counted(1));
+			held = dp::unex(denied);
+			DP_CHECK(!held && held.error() == denied && counted::live() == 0);
+			held = counted(2);
+			DP_CHECK(held && held->value == 2 && counted::live() == 1);
+
+			dp::expected<counted, error_code> other(dp::unexpect, not_found);
+			held.swap(other);
+			DP_CHECK(!held && held.error() == not_found);
+			DP_CHECK(other && other->value == 2 && counted::live() == 1);
+			dp::swap(held, other);
+			DP_CHECK(held->value == 2 && other.error() == not_found);
+
+			other = held;
+			DP_CHECK(other->value == 2 && counted::live() == 2);
+		}
+		DP_CHECK(counted::live() == 0);
+
+		dp::expected<void, error_code> done;
+		done = dp::unex(not_found);
+		DP_CHECK(!done && done.error() == not_found);
+		done.emplace();
+		DP_CHECK(done.has_value());
+	}
+
+	void test_swap_moves_payloads() {
+		std::vector<int> big(1000, 1);
+		const int* data = &big[0];
+		dp::expected<std::vector<int>, error_code> held(dp::unexpect, denied);
+		held.assign_by_swap(big);
+		DP_CHECK(held->size() == 1000 && &(*held)[0] == data && big.empty());
+
+		dp::expected<std::vector<int>, error_code> other(dp::in_place, 3u);
+		held.swap(other);
+		DP_CHECK(held->size() == 3 && &(*other)[0] == data);
+	}
+
+}
+
+int main() {
+	test_states();
+	test_in_place_and_emplace();
+	test_changing_state();
+	test_swap_moves_payloads();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,97 @@
+#include "cpp98/value_ptr.h"
+
+#include "test_harness.h"
+
+//clone_context is opt-in, so the pointer must not pull it in by default
+#ifdef DP_CPP98_CLONE_CONTEXT
+#error "value_ptr.h included clone_context.h without DP_CLONE_CONTEXT"
+#endif
+
+namespace {
+
+	typedef dp_test::counted counted;
+
+	struct holder {
+		dp::value_ptr<counted> member;
+	};
+
+	void test_value_semantics() {
+		{
+			dp::value_ptr<counted> first(new counted(1));
+			dp::value_ptr<counted> second(first);
+			DP_CHECK(counted::live() == 2);
+			DP_CHECK(first.get() != second.get());
+			DP_CHECK(second->value == 1);
+
+			second->value = 2;
+			DP_CHECK(first->value == 1);
+			DP_CHECK((*second).value == 2);
+
+			first = second;
+			DP_CHECK(first->value == 2);
+			DP_CHECK(first != second);
+			DP_CHECK(counted::live() == 2);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_implicit_member_copy() {
+		{
+			holder original;
+			original.member.reset(new counted(5));
+			holder copy = original;
+			DP_CHECK(copy.member.get() != original.member.get());
+			DP_CHECK(copy.member->value == 5);
+			DP_CHECK(counted::live() == 2);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_null_and_release() {
+		dp::value_ptr<counted> empty;
+		DP_CHECK(!empty);
+		DP_CHECK(empty == dp::null_ptr_t());
+		dp::value_ptr<counted> copy(empty);
+		DP_CHECK(!copy);
+
+		dp::value_ptr<counted> owner(new counted(3));
+		DP_CHECK(owner != dp::null_ptr_t());
+		counted* raw = owner.release();
+		DP_CHECK(!owner);
+		DP_CHECK(counted::live() == 1);
+		delete raw;
+
+		owner.reset(new counted(4));
+		owner.reset();
+		DP_CHECK(counted::live() == 0);
+	}
+
+#ifdef __cpp_rvalue_references
+	void test_move() {
+		{
+			dp::value_ptr<counted> source(new counted(1));
+			const counted* held = source.get();
+			dp::value_ptr<counted> target(static_cast<dp::value_ptr<counted>&&>(source));
+			DP_CHECK(!source);
+			DP_CHECK(target.get() == held);
+
+			dp::value_ptr<counted> assigned(new counted(2));
+			assigned = static_cast<dp::value_ptr<counted>&&>(target);
+			DP_CHECK(assigned.get() == held);
+			DP_CHECK(counted::live() == 1);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+#endif
+
+}
+
+int main() {
+	test_value_semantics();
+	test_implicit_member_copy();
+	test_null_and_release();
+#ifdef __cpp_rvalue_references
+	test_move();
+#endif
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,120 @@
+#include "cpp98/versioned_store.h"
+
+#include "test_harness.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+	struct string_size {
+		std::size_t operator()(const std::string& in) const {
+			return in.size();
+		}
+	};
+
+	typedef dp::versioned_store<std::string, string_size> store_type;
+
+	void test_commit_and_read() {
+		store_type store(10);
+		DP_CHECK(store.empty());
+
+		bool threw = false;
+		try {
+			store.latest();
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+
+		//Rather than wrapping round to the largest version number
+		threw = false;
+		try {
+			store.latest_version();
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw && store.oldest_version() == 0);
+
+		dp::cow_ptr<std::string> text = dp::make_cow<std::string>("one");
+		DP_CHECK(store.commit(text) == 0);
+		*text = "two";
+		DP_CHECK(store.commit(text) == 1);
+		DP_CHECK(store.size() == 2 && store.oldest_version() == 0 && store.latest_version() == 1);
+
+		//Editing the working copy after a commit does not change the committed version
+		DP_CHECK(*store.at(0) == "one" && *store.at(1) == "two" && *store.latest() == "two");
+		DP_CHECK(store.contains(1) && !store.contains(2));
+
+		threw = false;
+		try {
+			store.at(2);
+		}
+		catch (const std::out_of_range&) {
+			threw = true;
+		}
+		DP_CHECK(threw);
+	}
+
+	void test_history_is_bounded() {
+		store_type store(3);
+		for (int i = 0; i < 5; ++i) store.commit(dp::make_cow<std::string>(std::string(1, static_cast<char>('a' + i))));
+		DP_CHECK(store.size() == 3);
+		DP_CHECK(store.oldest_version() == 2 && store.latest_version() == 4);
+		DP_CHECK(!store.contains(1) && *store.at(2) == "c");
+
+		//A byte limit drops the oldest versions, but always keeps the newest
+		store.set_limits(10, 2);
+		DP_CHECK(store.size() == 2 && store.oldest_version() == 3);
+		store.commit(dp::make_cow<std::string>("a long piece of text"));
+		DP_CHECK(store.size() == 1 && *store.latest() == "a long piece of text");
+	}
+
+	void test_rollback_and_sharing() {
+		store_type store(10);
+		const dp::cow_ptr<std::string> first = dp::make_cow<std::string>("0123456789");
+		store.commit(first);
+		store.commit(dp::make_cow<std::string>("abc"));
+
+		//Rolling back re-commits the same object, which is only counted once
+		DP_CHECK(store.rollback_to(0) == 2);
+		DP_CHECK(store.latest() == first && store.at(0) == first);
+		DP_CHECK(*store.at(1) == "abc");
+
+		dp::sharing_stats stats = store.stats();
+		DP_CHECK(stats.versions == 3);
+		DP_CHECK(stats.logical_bytes == 23);
+		DP_CHECK(stats.unique_bytes == 13);
+		DP_CHECK(stats.shared_bytes == 10);
+
+		//The shared object stays counted until its last version ages out
+		store.set_limits(2);
+		stats = store.stats();
+		DP_CHECK(stats.logical_bytes == 13 && stats.unique_bytes == 13 && stats.shared_bytes == 0);
+		store.set_limits(1);
+		stats = store.stats();
+		DP_CHECK(stats.logical_bytes == 10 && stats.unique_bytes == 10);
+
+		//An empty snapshot takes no space
+		store.commit(dp::cow_ptr<std::string>());
+		DP_CHECK(store.size() == 1 && !store.latest() && store.stats().unique_bytes == 0);
+	}
+
+	void test_default_size() {
+		dp::versioned_store<int> store(4);
+		store.commit(dp::make_cow<int>(1));
+		store.commit(store.latest());
+		DP_CHECK(store.stats().logical_bytes == 2 * sizeof(int) && store.stats().unique_bytes == sizeof(int));
+	}
+
+}
+
+int main() {
+	test_commit_and_read();
+	test_history_is_bounded();
+	test_rollback_and_sharing();
+	test_default_size();
+	return DP_TEST_RESULT();
+}
@@ -0,0 +1,111 @@
+#include "cpp98/weak_cow_ptr.h"
+
+#include "test_harness.h"
+
+#ifdef DP_CPP11_OR_HIGHER
+#include <thread>
+#include <vector>
+#endif
+
+namespace {
+
+	typedef dp_test::counted counted;
+
+	void test_lock_and_expiry() {
+		dp::weak_cow_ptr<int> empty;
+		DP_CHECK(empty.expired() && empty.use_count() == 0);
+		DP_CHECK(!empty.lock());
+
+		dp::weak_cow_ptr<int> weak;
+		{
+			dp::cow_ptr<int> owner = dp::make_cow<int>(1);
+			weak = owner;
+			DP_CHECK(!weak.expired() && weak.use_count() == 1);
+
+			const dp::cow_ptr<int> locked = weak.lock();
+			DP_CHECK(locked && *locked == 1);
+			DP_CHECK(owner.use_count() == 2);
+			DP_CHECK(!weak.owner_before(owner) && !owner.owner_before(locked));
+			DP_CHECK(locked.generation() == owner.generation());
+		}
+		DP_CHECK(weak.expired());
+		DP_CHECK(!weak.lock());
+	}
+
+	void test_observed_snapshot_is_never_modified() {
+		counted::reset_counts();
+		{
+			dp::cow_ptr<counted> owner(new counted(1));
+			const dp::weak_cow_ptr<counted> weak(owner);
+			DP_CHECK(owner.unique());
+
+			//The only owner still copies, because the weak pointer is watching; the old snapshot then has no owner left
+			owner->value = 2;
+			DP_CHECK(counted::copies() == 1);
+			DP_CHECK(owner->value == 2);
+			DP_CHECK(weak.expired());
+
+			//With nothing watching, the only owner writes in place again
+			owner->value = 3;
+			DP_CHECK(counted::copies() == 1);
+
+			//A snapshot which has been observed is never written in place, even once the observer has gone
+			{
+				const dp::weak_cow_ptr<counted> gone(owner);
+			}
+			owner->value = 3;
+			DP_CHECK(counted::copies() == 2);
+
+			//A shared snapshot stays alive for the weak pointer, and keeps its value
+			dp::cow_ptr<counted> keep = owner;
+			const dp::weak_cow_ptr<counted> watch(keep);
+			keep->value = 4;
+			DP_CHECK(watch.lock()->value == 3);
+			DP_CHECK(static_cast<const dp::cow_ptr<counted>&>(owner)->value == 3);
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+
+	void test_arrays() {
+		dp::cow_ptr<int[4]> owner = dp::make_cow<int[4]>(1);
+		const dp::weak_cow_ptr<int[4]> weak(owner);
+		const dp::cow_ptr<int[4]> snapshot = weak.lock();
+		owner[0] = 2;
+		DP_CHECK(snapshot[0] == 1);
+		DP_CHECK(static_cast<const dp::cow_ptr<int[4]>&>(owner)[0] == 2);
+		DP_CHECK(owner.generation() != snapshot.generation());
+	}
+
+#ifdef DP_CPP11_OR_HIGHER
+	//Each thread locks a snapshot while its only owner is released on another, so lock() must either win an owner or see none
+	void test_lock_races_release() {
+		counted::reset_counts();
+		const int rounds = 1000;
+		for (int i = 0; i < rounds; ++i) {
+			dp::cow_ptr<counted> owner(new counted(i));
+			const dp::weak_cow_ptr<counted> weak(owner);
+			int seen = -1;
+			std::thread locker([&weak, &seen] {
+				const dp::cow_ptr<counted> locked = weak.lock();
+				if (locked) seen = locked->value;
+			});
+			owner.reset();
+			locker.join();
+			DP_CHECK(seen == -1 || seen == i);
+			DP_CHECK(weak.expired());
+		}
+		DP_CHECK(counted::live() == 0);
+	}
+#endif
+
+}
+
+int main() {
+	test_lock_and_expiry();
+	test_observed_snapshot_is_never_modified();
+	test_arrays();
+#ifdef DP_CPP11_OR_HIGHER
+	test_lock_races_release();
+#endif
+	return DP_TEST_RESULT();
+}
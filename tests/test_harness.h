@@ -0,0 +1,76 @@
+#ifndef DP_TEST_HARNESS
+#define DP_TEST_HARNESS
+
+/*
+*	A deliberately tiny test harness, so the tests build as C++98 with nothing but the headers under test.
+*	Each test file is one executable: DP_CHECK records a failure with its location and carries on, and DP_TEST_RESULT() at the
+*	end of main turns the failure count into the exit status which ctest reads.
+*/
+
+#include <cstdio>
+
+namespace dp_test {
+
+	inline int& failure_count() {
+		static int count = 0;
+		return count;
+	}
+
+	inline void check(bool inPassed, const char* inExpr, const char* inFile, int inLine) {
+		if (inPassed) return;
+		++failure_count();
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", inFile, inLine, inExpr);
+	}
+
+	inline int result() {
+		if (failure_count() != 0) std::fprintf(stderr, "%d check(s) failed\n", failure_count());
+		return failure_count() == 0 ? 0 : 1;
+	}
+
+	//Counts live instances and copies, to test ownership and copy counts of the containers and pointers
+	struct counted {
+		int value;
+
+		static int& live() {
+			static int count = 0;
+			return count;
+		}
+		static int& copies() {
+			static int count = 0;
+			return count;
+		}
+
+		counted() : value(0) {
+			++live();
+		}
+		explicit counted(int in) : value(in) {
+			++live();
+		}
+		counted(const counted& other) : value(other.value) {
+			++live();
+			++copies();
+		}
+		counted& operator=(const counted& other) {
+			value = other.value;
+			++copies();
+			return *this;
+		}
+		~counted() {
+			--live();
+		}
+
+		static void reset_counts() {
+			copies() = 0;
+		}
+	};
+
+	inline bool operator==(const counted& lhs, const counted& rhs) {
+		return lhs.value == rhs.value;
+	}
+
+}
+
+#define DP_CHECK(expr) dp_test::check((expr) ? true : false, #expr, __FILE__, __LINE__)
+#define DP_TEST_RESULT() dp_test::result()
+
+#endif